@@ -14,12 +14,181 @@
 
 #include "dynamic.h"
 #include <stdio.h>
+#include <string.h>
 
+#ifdef S2_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//! frames of the explicit work stacks, which are used without allocation
+#define WALK_STACK 16
+
+/**
+ * Frame of an explicit work stack, which replaces the recursion in dyn_copy,
+ * dyn_size, and dyn_string_len when nested containers are traversed.
+ */
+typedef struct {
+    const dyn_c* src;       //!< array of elements to traverse
+    dyn_c*       dst;       //!< array of copied elements (dyn_copy only)
+    dyn_ushort   i;         //!< next element
+    dyn_ushort   n;         //!< number of elements
+} walk_frame;
+
+typedef struct {
+    walk_frame  local[WALK_STACK];
+    walk_frame* frame;
+    dyn_uint    space;
+    dyn_uint    depth;
+} walk_stack;
+
+static void walk_init (walk_stack* s)
+{
+    s->frame = s->local;
+    s->space = WALK_STACK;
+    s->depth = 0;
+}
+
+//! Returns a new frame on top of the stack or NULL, if memory is exhausted
+static walk_frame* walk_push (walk_stack* s)
+{
+    if (s->depth == s->space) {
+        walk_frame* tmp = (walk_frame*) malloc(2 * s->space * sizeof(walk_frame));
+        if (!tmp)
+            return NULL;
+        memcpy(tmp, s->frame, s->depth * sizeof(walk_frame));
+        if (s->frame != s->local)
+            free(s->frame);
+        s->frame = tmp;
+        s->space *= 2;
+    }
+    return &s->frame[s->depth++];
+}
+
+static void walk_free (walk_stack* s)
+{
+    if (s->frame != s->local)
+        free(s->frame);
+}
+
+static trilean is_container (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+#ifdef S2_SET
+        case SET:
+#endif
+        case LIST:
+        case DICT:  return DYN_TRUE;
+    }
+    return DYN_FALSE;
+}
+
+//! Elements of a LIST, SET, or DICT, the list that stores the values of a DICT
+static dyn_list* elements (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == DICT ? DYN_DATA(&DYN_DATA(dyn, dict)->value, list)
+                                 : DYN_DATA(dyn, list);
+}
+
+/**
+ * Releases the shape of a dictionary, its header is part of the block of the
+ * value list and is freed together with it, see dyn_block_free.
+ *
+ * @returns the list of values, which still has to be freed
+ */
+static dyn_list* dict_detach (dyn_c* dyn)
+{
+    dyn_dict* dict = DYN_DATA(dyn, dict);
+
+    dyn_shape_free(dict->shape);
+
+    return DYN_DATA(&dict->value, list);
+}
+
+/**
+ * Frees a list and all nested elements without recursion and without any
+ * additional memory (pointer reversal). Before descending into a nested
+ * container, its slot within the parent list is reused to store the pointer
+ * to the grandparent, this chain is followed back upwards afterwards.
+ *
+ * At most budget elements are freed, the current list and its parent are
+ * stored in plist and pparent, such that freeing can be continued later on.
+ *
+ * @param[in, out] plist list to free, NULL if everything was freed
+ * @param[in, out] pparent parent of plist, NULL for the root
+ * @param[in] budget maximal number of elements to free
+ *
+ * @returns the remaining budget
+ */
+static dyn_uint free_tree_step (dyn_list** plist, dyn_list** pparent, dyn_uint budget)
+{
+    dyn_list* list = *plist;
+    dyn_list* parent = *pparent;
+    dyn_list* child;
+    dyn_c* elem;
+
+    while (budget) {
+        --budget;
+
+        if (!list->length) {
+            dyn_block_free(list);
+
+            if (!parent) {
+                list = NULL;
+                break;
+            }
+
+            list = parent;
+            elem = &list->container[list->length - 1];
+            parent = DYN_DATA(elem, list);
+            DYN_INIT(elem);
+            --list->length;
+            continue;
+        }
+
+        elem = &list->container[list->length - 1];
+
+        switch (DYN_TYPE(elem)) {
+            case STRING:    dyn_mem_free(DYN_DATA(elem, str));
+                            break;
+#ifdef S2_SET
+            case SET:
+#endif
+            case LIST:      child = DYN_DATA(elem, list);
+                            goto DESCEND;
+            case DICT:      child = dict_detach(elem);
+                            goto DESCEND;
+            case FUNCTION:  dyn_fct_free(elem);
+        }
+        DYN_INIT(elem);
+        --list->length;
+        continue;
+
+DESCEND:
+        DYN_SET_TYPE(elem, LIST);
+        DYN_SET_DATA(elem, list, parent);
+        parent = list;
+        list = child;
+    }
+
+    *plist = list;
+    *pparent = parent;
+    return budget;
+}
+
+static void free_tree (dyn_list* list)
+{
+    dyn_list* parent = NULL;
+
+    while (list)
+        free_tree_step(&list, &parent, 0xFFFFFFFF);
+}
 
 /**
- * Frees any kind of dynamic type and convertes it to a NONE element. For the
- * the freeing of different data types the different free functions in the
- * different modules is applied.
+ * Frees any kind of dynamic type and convertes it to a NONE element. Nested
+ * lists, sets, and dictionaries are freed without recursion and without
+ * allocating additional memory, such that also deeply nested structures can be
+ * freed with a bounded stack.
  *
  * @see dyn_list_free
  * @see dyn_dict_free
@@ -30,20 +199,204 @@
 void dyn_free (dyn_c* dyn)
 {
     switch (DYN_TYPE(dyn)) {
-        case STRING:    free(dyn->data.str);
+        case STRING:    dyn_mem_free(DYN_DATA(dyn, str));
                         break;
 #ifdef S2_SET
         case SET:
 #endif
-        case LIST:      dyn_list_free(dyn);
+        case LIST:      free_tree(DYN_DATA(dyn, list));
                         break;
-        case DICT:      dyn_dict_free(dyn);
+        case DICT:      free_tree(dict_detach(dyn));
                         break;
         case FUNCTION:  dyn_fct_free(dyn);
     }
-    dyn->type=NONE;
+    DYN_INIT(dyn);
 }
 
+/**
+ * Elements handed over to dyn_free_deferred, together with the state of the
+ * tree that is currently freed by dyn_reclaim.
+ */
+static dyn_c     graveyard;
+static dyn_list* reclaim_list   = NULL;
+static dyn_list* reclaim_parent = NULL;
+
+#ifdef S2_THREADS
+static pthread_mutex_t graveyard_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t reclaim_lock   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  reclaim_cond   = PTHREAD_COND_INITIALIZER;
+static pthread_t       reclaim_thread;
+static trilean         reclaim_running = DYN_FALSE;
+#define LOCK(M)     pthread_mutex_lock(&M)
+#define UNLOCK(M)   pthread_mutex_unlock(&M)
+#else
+#define LOCK(M)
+#define UNLOCK(M)
+#endif
+
+/**
+ * Detaches an element and defers its freeing, the element is set to NONE in
+ * O(1) (amortized) and the actual freeing is done later on by dyn_reclaim, in
+ * bounded time slices, or by a background thread, see dyn_reclaim_start. Only
+ * containers are deferred, all other types are freed immediately. If there is
+ * no memory left to store the element, it is freed immediately as well.
+ *
+ * @param[in, out] dyn element to free, result is of type NONE
+ */
+void dyn_free_deferred (dyn_c* dyn)
+{
+    if (!is_container(dyn)) {
+        dyn_free(dyn);
+        return;
+    }
+
+    dyn_c* slot = NULL;
+
+    LOCK(graveyard_lock);
+    if (DYN_TYPE(&graveyard) == LIST || DYN_SET_LIST(&graveyard))
+        slot = dyn_list_push_none(&graveyard);
+    if (slot)
+        *slot = *dyn;
+#ifdef S2_THREADS
+    pthread_cond_signal(&reclaim_cond);
+#endif
+    UNLOCK(graveyard_lock);
+
+    if (slot)
+        DYN_INIT(dyn);
+    else
+        dyn_free(dyn);
+}
+
+/**
+ * Frees elements that were passed to dyn_free_deferred, at most budget
+ * elements are freed per call, such that the caller is never blocked for
+ * longer than the defined time slice.
+ *
+ * @code
+ * // free large structures within an event loop
+ * dyn_free_deferred(&huge_list);
+ * while (!dyn_reclaim(1000))
+ *     handle_events();
+ * @endcode
+ *
+ * @param[in] budget maximal number of elements to free
+ *
+ * @retval DYN_TRUE   if all deferred elements were freed
+ * @retval DYN_FALSE  if there is still work left
+ */
+trilean dyn_reclaim (dyn_uint budget)
+{
+    trilean done = DYN_FALSE;
+    dyn_c root;
+    DYN_INIT(&root);
+
+    LOCK(reclaim_lock);
+    while (budget) {
+        if (!reclaim_list) {
+            LOCK(graveyard_lock);
+            if (DYN_TYPE(&graveyard) == LIST && DYN_LIST_LEN(&graveyard)) {
+                dyn_c* last = DYN_LIST_GET_END(&graveyard);
+                root = *last;
+                DYN_INIT(last);
+                --DYN_LIST_LEN(&graveyard);
+            }
+            UNLOCK(graveyard_lock);
+
+            if (DYN_IS_NONE(&root))
+                break;
+
+            reclaim_list = DYN_TYPE(&root) == DICT ? dict_detach(&root)
+                                                   : DYN_DATA(&root, list);
+            reclaim_parent = NULL;
+            DYN_INIT(&root);
+        }
+
+        budget = free_tree_step(&reclaim_list, &reclaim_parent, budget);
+    }
+
+    if (!reclaim_list) {
+        LOCK(graveyard_lock);
+        if (DYN_TYPE(&graveyard) != LIST || !DYN_LIST_LEN(&graveyard)) {
+            dyn_free(&graveyard);
+            done = DYN_TRUE;
+        }
+        UNLOCK(graveyard_lock);
+    }
+    UNLOCK(reclaim_lock);
+
+    return done;
+}
+
+#ifdef S2_THREADS
+//! Number of elements freed by the background thread, before it yields
+#define RECLAIM_SLICE 4096
+
+static void* reclaim_loop (void* arg)
+{
+    for (;;) {
+        LOCK(graveyard_lock);
+        while (reclaim_running &&
+               (DYN_TYPE(&graveyard) != LIST || !DYN_LIST_LEN(&graveyard)))
+            pthread_cond_wait(&reclaim_cond, &graveyard_lock);
+        trilean running = reclaim_running;
+        UNLOCK(graveyard_lock);
+
+        while (!dyn_reclaim(RECLAIM_SLICE))
+            sched_yield();
+
+        if (!running)
+            return NULL;
+    }
+}
+
+/**
+ * Starts a background thread, which frees all elements passed to
+ * dyn_free_deferred, such that the calling threads never have to free large
+ * structures on their own.
+ *
+ * @retval DYN_TRUE   if the thread is running
+ * @retval DYN_FALSE  if the thread could not be created
+ */
+trilean dyn_reclaim_start (void)
+{
+    LOCK(graveyard_lock);
+    if (reclaim_running) {
+        UNLOCK(graveyard_lock);
+        return DYN_TRUE;
+    }
+
+    // the lock is held until the handle is written, which dyn_reclaim_stop
+    // joins, the new thread waits for it as well
+    trilean rslt = DYN_FALSE;
+    if (!pthread_create(&reclaim_thread, NULL, reclaim_loop, NULL)) {
+        reclaim_running = DYN_TRUE;
+        rslt = DYN_TRUE;
+    }
+    UNLOCK(graveyard_lock);
+
+    return rslt;
+}
+
+/**
+ * Stops the background thread, after all deferred elements were freed.
+ */
+void dyn_reclaim_stop (void)
+{
+    LOCK(graveyard_lock);
+    if (!reclaim_running) {
+        UNLOCK(graveyard_lock);
+        return;
+    }
+    reclaim_running = DYN_FALSE;
+    pthread_t thread = reclaim_thread;
+    pthread_cond_signal(&reclaim_cond);
+    UNLOCK(graveyard_lock);
+
+    pthread_join(thread, NULL);
+}
+#endif
+
 /**
  * It is more appropriate to apply the macro DYN_TYPE instead of calling this
  * function. This function is only applied to offer an interface if a compiled
@@ -67,7 +420,7 @@ TYPE dyn_type (const dyn_c* dyn)
 void dyn_set_none (dyn_c* dyn)
 {
     dyn_free(dyn);
-    dyn->data.i = 0;
+    DYN_SET_DATA(dyn, i, 0);
 }
 
 /**
@@ -77,8 +430,8 @@ void dyn_set_none (dyn_c* dyn)
 void dyn_set_bool (dyn_c* dyn, const dyn_char v)
 {
     dyn_free(dyn);
-    dyn->type = BOOL;
-    dyn->data.b = v;
+    DYN_SET_TYPE(dyn, BOOL);
+    DYN_SET_DATA(dyn, b, v);
 }
 
 /**
@@ -88,8 +441,8 @@ void dyn_set_bool (dyn_c* dyn, const dyn_char v)
 void dyn_set_int (dyn_c* dyn, const dyn_int v)
 {
     dyn_free(dyn);
-    dyn->type = INTEGER;
-    dyn->data.i = v;
+    DYN_SET_TYPE(dyn, INTEGER);
+    DYN_SET_DATA(dyn, i, v);
 }
 
 /**
@@ -99,8 +452,8 @@ void dyn_set_int (dyn_c* dyn, const dyn_int v)
 void dyn_set_float (dyn_c* dyn, const dyn_float v)
 {
     dyn_free(dyn);
-    dyn->type = FLOAT;
-    dyn->data.f = v;
+    DYN_SET_TYPE(dyn, FLOAT);
+    DYN_SET_DATA(dyn, f, v);
 }
 
 /**
@@ -112,8 +465,8 @@ void dyn_set_float (dyn_c* dyn, const dyn_float v)
 void dyn_set_extern (dyn_c* dyn, const void * v)
 {
     dyn_free(dyn);
-    dyn->type = EXTERN;
-    dyn->data.ex = v;
+    DYN_SET_TYPE(dyn, EXTERN);
+    DYN_SET_DATA(dyn, ex, v);
 }
 
 /**
@@ -129,11 +482,12 @@ trilean dyn_set_string (dyn_c* dyn, dyn_const_str v)
 {
     dyn_free(dyn);
 
-    dyn->data.str = (dyn_str) malloc(dyn_strlen((dyn_str)v)+1);
+    dyn_str str = (dyn_str) dyn_mem_alloc(dyn_strlen((dyn_str)v)+1);
 
-    if (dyn->data.str) {
-        dyn->type = STRING;
-        dyn_strcpy(dyn->data.str, (dyn_str)v);
+    if (str) {
+        DYN_SET_TYPE(dyn, STRING);
+        DYN_SET_DATA(dyn, str, str);
+        dyn_strcpy(str, (dyn_str)v);
         return DYN_TRUE;
     }
     return DYN_FALSE;
@@ -150,59 +504,105 @@ void dyn_set_ref (dyn_c* ref, dyn_c* orig)
 {
     dyn_free(ref);
 
-    ref->type = REFERENCE;
-    ref->data.ref = DYN_IS_REFERENCE(orig) ? orig->data.ref : orig;
+    DYN_SET_TYPE(ref, REFERENCE);
+    DYN_SET_DATA(ref, ref, DYN_IS_REFERENCE(orig) ? DYN_DATA(orig, ref) : orig);
 }
 
-/**
- * This function is intended calculate the size of an dynamic element in bytes.
- *
- * @param[in, out] dyn element to check
- *
- * @returns size in bytes
- */
-dyn_uint dyn_size (const dyn_c* dyn)
+//! Size of a single element, without the elements nested within it
+static dyn_uint size_node (const dyn_c* dyn)
 {
     dyn_uint bytes = sizeof(dyn_c);
 
-    dyn_ushort len, i = 0;
-
     switch (DYN_TYPE(dyn)) {
         case STRING:
-            bytes += dyn_strlen(dyn->data.str)+1;
+            bytes += dyn_strlen(DYN_DATA(dyn, str))+1;
             break;
 #ifdef S2_SET
         case SET:
 #endif
-        case LIST: {
-            bytes += sizeof(dyn_list);
-
-            len = dyn->data.list->space;
-            for (; i<len; ++i)
-                bytes += dyn_size( DYN_LIST_GET_REF(dyn, i) );
-
+        case LIST:
+            bytes += dyn_block_size(DYN_DATA(dyn, list));
             break;
-        }
         case DICT: {
-            bytes += sizeof(dyn_dict);
-            bytes += dyn_size(&dyn->data.dict->value);
-
-            len = dyn->data.dict->value.data.list->space;
-            for (; i<len; ++i) {
-                if (dyn->data.dict->key[i])
-                    bytes += dyn_strlen(dyn->data.dict->key[i]);
-                bytes++;
-            }
+            bytes += dyn_block_size(elements(dyn));
 
+            // shared shapes are not counted, only private ones
+            dyn_shape* shape = DYN_DATA(dyn, dict)->shape;
+            if (!shape->parent && shape->refs == 1 && shape->length)
+                bytes += sizeof(dyn_shape) + shape->space * sizeof(dyn_str);
             break;
         }
-        case FUNCTION: {
+        case FUNCTION:
             bytes += sizeof(dyn_fct);
-            bytes += dyn_strlen(dyn->data.fct->info) + 1;
+            bytes += dyn_strlen(DYN_DATA(dyn, fct)->info) + 1;
             break;
+    }
+
+    return bytes;
+}
+
+/**
+ * Calculates the size of an element without any nested elements, but
+ * including the memory of unused slots of containers.
+ *
+ * @param[in] dyn element to check
+ *
+ * @returns size in bytes
+ */
+dyn_uint dyn_size_shallow (const dyn_c* dyn)
+{
+    return size_node(dyn);
+}
+
+/**
+ * This function is intended calculate the size of an dynamic element in bytes.
+ *
+ * Nested containers are traversed with an explicit stack.
+ *
+ * @param[in, out] dyn element to check
+ *
+ * @returns size in bytes
+ */
+dyn_uint dyn_size (const dyn_c* dyn)
+{
+    dyn_uint bytes = size_node(dyn);
+
+    if (!is_container(dyn))
+        return bytes;
+
+    walk_stack s;
+    walk_frame* f;
+    walk_init(&s);
+
+    f = walk_push(&s);
+    f->src = elements(dyn)->container;
+    f->i = 0;
+    f->n = elements(dyn)->space;
+
+    while (s.depth) {
+        f = &s.frame[s.depth-1];
+        if (f->i == f->n) {
+            --s.depth;
+            continue;
+        }
+
+        dyn = &f->src[f->i++];
+
+        if (is_container(dyn)) {
+            f = walk_push(&s);
+            if (!f) {
+                bytes += dyn_size(dyn);
+                continue;
+            }
+            f->src = elements(dyn)->container;
+            f->i = 0;
+            f->n = elements(dyn)->space;
         }
+
+        bytes += size_node(dyn);
     }
 
+    walk_free(&s);
     return bytes;
 }
 
@@ -242,9 +642,9 @@ trilean dyn_get_bool (const dyn_c* dyn)
 {
 START:
     switch (DYN_TYPE(dyn)) {
-        case BOOL:      return dyn->data.b ? DYN_TRUE : DYN_FALSE;
-        case INTEGER:   return dyn->data.i ? DYN_TRUE : DYN_FALSE;
-        case FLOAT:     return dyn->data.f ? DYN_TRUE : DYN_FALSE;
+        case BOOL:      return DYN_DATA(dyn, b) ? DYN_TRUE : DYN_FALSE;
+        case INTEGER:   return DYN_DATA(dyn, i) ? DYN_TRUE : DYN_FALSE;
+        case FLOAT:     return DYN_DATA(dyn, f) ? DYN_TRUE : DYN_FALSE;
 
         case STRING:
 #ifdef S2_SET
@@ -254,7 +654,7 @@ START:
         case DICT:
                         return dyn_length(dyn);// ? DYN_TRUE : DYN_FALSE;
         case REFERENCE2:
-        case REFERENCE: dyn=dyn->data.ref;
+        case REFERENCE: dyn=DYN_DATA(dyn, ref);
                         goto START;
     }
 
@@ -280,11 +680,11 @@ dyn_int dyn_get_int (const dyn_c* dyn)
 {
 START:
     switch (DYN_TYPE(dyn)) {
-        case BOOL:      return (dyn_int)dyn->data.b;
-        case INTEGER:   return dyn->data.i;
-        case FLOAT:     return (dyn_int)dyn->data.f;
+        case BOOL:      return (dyn_int)DYN_DATA(dyn, b);
+        case INTEGER:   return DYN_DATA(dyn, i);
+        case FLOAT:     return (dyn_int)DYN_DATA(dyn, f);
         case REFERENCE2:
-        case REFERENCE: dyn=dyn->data.ref;
+        case REFERENCE: dyn=DYN_DATA(dyn, ref);
                         goto START;
     }
     return DYN_FALSE;
@@ -305,11 +705,11 @@ dyn_float dyn_get_float (const dyn_c* dyn)
 {
 START:
     switch (DYN_TYPE(dyn)) {
-        case BOOL:      return (dyn_float)dyn->data.b;
-        case INTEGER:   return (dyn_float)dyn->data.i;
-        case FLOAT:     return dyn->data.f;
+        case BOOL:      return (dyn_float)DYN_DATA(dyn, b);
+        case INTEGER:   return (dyn_float)DYN_DATA(dyn, i);
+        case FLOAT:     return DYN_DATA(dyn, f);
         case REFERENCE2:
-        case REFERENCE: dyn=dyn->data.ref;
+        case REFERENCE: dyn=DYN_DATA(dyn, ref);
                         goto START;
     }
     return 0.0/0.0; // Not a Number
@@ -323,10 +723,10 @@ START:
 const void* dyn_get_extern (const dyn_c* dyn)
 {
     if (DYN_IS_REFERENCE(dyn))
-        dyn = dyn->data.ref;
+        dyn = DYN_DATA(dyn, ref);
 
     if(DYN_TYPE(dyn) == EXTERN)
-        return dyn->data.ex;
+        return DYN_DATA(dyn, ex);
 
     return NULL;
 }
@@ -345,13 +745,13 @@ const void* dyn_get_extern (const dyn_c* dyn)
 dyn_str dyn_get_string (const dyn_c* dyn)
 {
     if (DYN_IS_REFERENCE(dyn))
-        dyn = dyn->data.ref;
+        dyn = DYN_DATA(dyn, ref);
 
     dyn_str string = (dyn_str) malloc(dyn_string_len(dyn) + 1);
     if (string) {
         string[0] = '\0';
         /*if (DYN_TYPE(dyn) == STRING)
-            dyn_strcpy(string, dyn->data.str);
+            dyn_strcpy(string, DYN_DATA(dyn, str));
         else*/
         dyn_string_add(dyn, string);
     }
@@ -373,16 +773,16 @@ void dyn_string_add (const dyn_c* dyn, dyn_str string)
 START:
     switch (DYN_TYPE(dyn)) {
         case BOOL:
-            dyn_strcat(string, dyn->data.b ? "1": "0");
+            dyn_strcat(string, DYN_DATA(dyn, b) ? "1": "0");
             return;
         case INTEGER:
-            dyn_itoa(&string[dyn_strlen(string)], dyn->data.i);
+            dyn_itoa(&string[dyn_strlen(string)], DYN_DATA(dyn, i));
             return;
         case FLOAT:
-            dyn_ftoa(&string[dyn_strlen(string)], dyn->data.f);
+            dyn_ftoa(&string[dyn_strlen(string)], DYN_DATA(dyn, f));
             return;
         case STRING:
-            dyn_strcat(string, dyn->data.str);
+            dyn_strcat(string, DYN_DATA(dyn, str));
             return;
         case EXTERN:
             dyn_strcat(string, "ex");
@@ -407,70 +807,205 @@ START:
             return;
         case REFERENCE2:
         case REFERENCE:
-            dyn=dyn->data.ref;
+            dyn=DYN_DATA(dyn, ref);
             goto START;
         case MISCELLANEOUS:
             dyn_strcat(string, "$");
     }
 }
 
-/**
- * @params dyn any kind of element
- *
- * @returns length of string representation
- */
-dyn_ushort dyn_string_len (const dyn_c* dyn)
+//! Length of the string representation, without nested elements
+static dyn_uint string_len_node (const dyn_c* dyn)
 {
-START:
     switch (DYN_TYPE(dyn)) {
-        case REFERENCE2:
-        case REFERENCE: dyn=dyn->data.ref;
-                        goto START;
         case MISCELLANEOUS:
         case BOOL:      return 1;
-        case INTEGER:   return dyn_itoa_len(dyn->data.i);
-        case FLOAT:     return dyn_ftoa_len(dyn->data.f);
+        case INTEGER:   return dyn_itoa_len(DYN_DATA(dyn, i));
+        case FLOAT:     return dyn_ftoa_len(DYN_DATA(dyn, f));
         case EXTERN:    return 2;
         case FUNCTION:  return 3;
-        case STRING:    return dyn_strlen(dyn->data.str);
+        case STRING:    return dyn_strlen(DYN_DATA(dyn, str));
 #ifdef S2_SET
         case SET:
 #endif
-        case LIST:      return dyn_list_string_len(dyn);
-        case DICT:      return dyn_dict_string_len(dyn);
+        case LIST:      return DYN_LIST_LEN(dyn) + 3;
+        case DICT: {
+            dyn_uint len = DYN_DICT_LEN(dyn);
+            dyn_ushort i = len;
+            while (i--)
+                len += dyn_strlen(DYN_DICT_GET_I_KEY(dyn, i)) + 2; // comma and colon
+            return len + 2;
+        }
     }
     return 0;
 }
 
 /**
- * Basic (recursive) copy function for creating deep copies of dynamic elements.
+ * The length is calculated without recursion, nested containers are traversed
+ * with an explicit stack.
  *
- * @params[in] dyn original element
- * @params[in,out] copy newly created element
+ * @params dyn any kind of element
  *
- * @retval DYN_TRUE if element could be copied
- * @retval DYN_FALSE otherwise
+ * @returns length of string representation
  */
-trilean dyn_copy (const dyn_c* dyn, dyn_c* copy)
+dyn_ushort dyn_string_len (const dyn_c* dyn)
+{
+    while (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    dyn_uint len = string_len_node(dyn);
+
+    if (!is_container(dyn))
+        return len;
+
+    walk_stack s;
+    walk_frame* f;
+    walk_init(&s);
+
+    f = walk_push(&s);
+    f->src = elements(dyn)->container;
+    f->i = 0;
+    f->n = elements(dyn)->length;
+
+    while (s.depth) {
+        f = &s.frame[s.depth-1];
+        if (f->i == f->n) {
+            --s.depth;
+            continue;
+        }
+
+        dyn = &f->src[f->i++];
+        while (DYN_IS_REFERENCE(dyn))
+            dyn = DYN_DATA(dyn, ref);
+
+        if (is_container(dyn)) {
+            f = walk_push(&s);
+            if (!f) {
+                len += dyn_string_len(dyn);
+                continue;
+            }
+            f->src = elements(dyn)->container;
+            f->i = 0;
+            f->n = elements(dyn)->length;
+        }
+
+        len += string_len_node(dyn);
+    }
+
+    walk_free(&s);
+    return len;
+}
+
+/**
+ * Copies a single element, containers are copied as shells only, with the
+ * same keys and length, but with all elements set to NONE.
+ */
+static trilean copy_node (const dyn_c* dyn, dyn_c* copy)
 {
     switch (DYN_TYPE(dyn)) {
-        case STRING:    return dyn_set_string( copy, dyn->data.str );
-        case LIST:      return dyn_list_copy ( dyn, copy );
+        case STRING:    return dyn_set_string( copy, DYN_DATA(dyn, str) );
 #ifdef S2_SET
-        case SET:       if ( !dyn_list_copy(dyn, copy) )
-                            return DYN_FALSE;
-                        copy->type = SET;
-                        break;
+        case SET:
 #endif
-        case DICT:      return dyn_dict_copy( dyn, copy );
+        case LIST: {
+            dyn_ushort len = DYN_LIST_LEN(dyn);
+            if (!dyn_set_list_len(copy, len))
+                return DYN_FALSE;
+            DYN_LIST_LEN(copy) = len;
+            DYN_SET_TYPE(copy, DYN_TYPE(dyn));
+            break;
+        }
+        case DICT: {
+            dyn_ushort len = DYN_DICT_LEN(dyn);
+            if (!dyn_set_dict(copy, len))
+                return DYN_FALSE;
+
+            DYN_DATA(copy, dict)->shape = dyn_shape_ref(DYN_DATA(dyn, dict)->shape);
+            DYN_DICT_LEN(copy) = len;
+            break;
+        }
         case FUNCTION:  return dyn_fct_copy  ( dyn, copy );
-        case REFERENCE: return dyn_copy ( dyn->data.ref, copy );
         default: *copy = *dyn;
     }
 
     return DYN_TRUE;
 }
 
+/**
+ * Basic copy function for creating deep copies of dynamic elements. Nested
+ * containers are copied without recursion, by using an explicit stack, which
+ * requires only memory for structures nested deeper than WALK_STACK.
+ *
+ * @params[in] dyn original element
+ * @params[in,out] copy newly created element
+ *
+ * @retval DYN_TRUE if element could be copied
+ * @retval DYN_FALSE otherwise
+ */
+trilean dyn_copy (const dyn_c* dyn, dyn_c* copy)
+{
+    while (DYN_TYPE(dyn) == REFERENCE)
+        dyn = DYN_DATA(dyn, ref);
+
+    if (!copy_node(dyn, copy))
+        return DYN_FALSE;
+
+    if (!is_container(dyn))
+        return DYN_TRUE;
+
+    trilean rslt = DYN_TRUE;
+    walk_stack s;
+    walk_frame* f;
+    walk_init(&s);
+
+    f = walk_push(&s);
+    f->src = elements(dyn)->container;
+    f->dst = elements(copy)->container;
+    f->i = 0;
+    f->n = elements(dyn)->length;
+
+    while (s.depth) {
+        f = &s.frame[s.depth-1];
+        if (f->i == f->n) {
+            --s.depth;
+            continue;
+        }
+
+        const dyn_c* src = &f->src[f->i];
+        dyn_c* dst = &f->dst[f->i];
+        ++f->i;
+
+        while (DYN_TYPE(src) == REFERENCE)
+            src = DYN_DATA(src, ref);
+
+        if (!copy_node(src, dst)) {
+            rslt = DYN_FALSE;
+            break;
+        }
+
+        if (is_container(src)) {
+            f = walk_push(&s);
+            if (!f) {
+                if (dyn_copy(src, dst))
+                    continue;
+                rslt = DYN_FALSE;
+                break;
+            }
+            f->src = elements(src)->container;
+            f->dst = elements(dst)->container;
+            f->i = 0;
+            f->n = elements(src)->length;
+        }
+    }
+
+    walk_free(&s);
+
+    if (!rslt)
+        dyn_free(copy);
+
+    return rslt;
+}
+
 /**
  * Basic move function which moves the element from one dynamic element to
  * another, without copying. This function can be used for moving heavy data
@@ -485,7 +1020,7 @@ void dyn_move (dyn_c* from, dyn_c* to)
     dyn_free(to);
 
     if (DYN_TYPE(from) == REFERENCE)
-        dyn_copy(from->data.ref, to);
+        dyn_copy(DYN_DATA(from, ref), to);
     else
         *to = *from;
 
@@ -505,14 +1040,14 @@ dyn_ushort dyn_length (const dyn_c* dyn)
 {
 START:
     switch (DYN_TYPE(dyn)) {
-        case STRING:    return dyn_strlen(dyn->data.str);
+        case STRING:    return dyn_strlen(DYN_DATA(dyn, str));
 #ifdef S2_SET
         case SET:
 #endif
         case LIST:      return DYN_LIST_LEN(dyn);
         case DICT:      return DYN_DICT_LEN(dyn);
         case REFERENCE2:
-        case REFERENCE: dyn=dyn->data.ref;
+        case REFERENCE: dyn=DYN_DATA(dyn, ref);
                         goto START;
     }
 
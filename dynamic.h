@@ -34,10 +34,88 @@
  *
  * @{
  */
+#ifdef S2_NAN_BOXING
+#define   DYN_BOX_SHIFT       56
+#define   DYN_BOX_MASK        0x00FFFFFFFFFFFFFFULL
+
+//! Mandatory initialization for dynamic elements (NONE)
+#define   DYN_INIT(dyn)       (dyn)->box=0
+//! Return type value of a dynamic element @see TYPE
+#define   DYN_TYPE(dyn)       ((dyn_char)((dyn)->box >> DYN_BOX_SHIFT))
+//! Change the type of a dynamic element, without touching its value
+#define   DYN_SET_TYPE(dyn,t) (dyn)->box = ((dyn)->box & DYN_BOX_MASK) | \
+                                           ((uint64_t)(dyn_byte)(t) << DYN_BOX_SHIFT)
+//! Return the value of a dynamic element, field is a member of dyn_c.data
+#define   DYN_DATA(dyn,field) dyn_box_get_##field(dyn)
+//! Change the value of a dynamic element, without touching its type
+#define   DYN_SET_DATA(dyn,field,v) dyn_box_set_##field(dyn, v)
+
+static inline void dyn_box_set (dyn_c* dyn, const uint64_t payload)
+{
+    dyn->box = (dyn->box & ~DYN_BOX_MASK) | (payload & DYN_BOX_MASK);
+}
+
+static inline uint32_t dyn_box_get_u32 (const dyn_c* dyn)
+{
+    return (uint32_t) dyn->box;
+}
+
+static inline void* dyn_box_get_ptr (const dyn_c* dyn)
+{
+    return (void*)(uintptr_t)(dyn->box & DYN_BOX_MASK);
+}
+
+static inline dyn_char dyn_box_get_b (const dyn_c* dyn)
+{   return (dyn_char) dyn->box; }
+static inline dyn_int dyn_box_get_i (const dyn_c* dyn)
+{   return (dyn_int) dyn_box_get_u32(dyn); }
+static inline dyn_float dyn_box_get_f (const dyn_c* dyn)
+{   union { uint32_t u; dyn_float f; } v = { dyn_box_get_u32(dyn) };
+    return v.f; }
+static inline dyn_str dyn_box_get_str (const dyn_c* dyn)
+{   return (dyn_str) dyn_box_get_ptr(dyn); }
+static inline dyn_list* dyn_box_get_list (const dyn_c* dyn)
+{   return (dyn_list*) dyn_box_get_ptr(dyn); }
+static inline dyn_dict* dyn_box_get_dict (const dyn_c* dyn)
+{   return (dyn_dict*) dyn_box_get_ptr(dyn); }
+static inline dyn_fct* dyn_box_get_fct (const dyn_c* dyn)
+{   return (dyn_fct*) dyn_box_get_ptr(dyn); }
+static inline const void* dyn_box_get_ex (const dyn_c* dyn)
+{   return (const void*) dyn_box_get_ptr(dyn); }
+static inline dyn_c* dyn_box_get_ref (const dyn_c* dyn)
+{   return (dyn_c*) dyn_box_get_ptr(dyn); }
+
+static inline void dyn_box_set_b (dyn_c* dyn, const dyn_char v)
+{   dyn_box_set(dyn, (dyn_byte) v); }
+static inline void dyn_box_set_i (dyn_c* dyn, const dyn_int v)
+{   dyn_box_set(dyn, (uint32_t) v); }
+static inline void dyn_box_set_f (dyn_c* dyn, const dyn_float v)
+{   union { dyn_float f; uint32_t u; } b = { v };
+    dyn_box_set(dyn, b.u); }
+static inline void dyn_box_set_str (dyn_c* dyn, const dyn_str v)
+{   dyn_box_set(dyn, (uintptr_t) v); }
+static inline void dyn_box_set_list (dyn_c* dyn, const dyn_list* v)
+{   dyn_box_set(dyn, (uintptr_t) v); }
+static inline void dyn_box_set_dict (dyn_c* dyn, const dyn_dict* v)
+{   dyn_box_set(dyn, (uintptr_t) v); }
+static inline void dyn_box_set_fct (dyn_c* dyn, const dyn_fct* v)
+{   dyn_box_set(dyn, (uintptr_t) v); }
+static inline void dyn_box_set_ex (dyn_c* dyn, const void* v)
+{   dyn_box_set(dyn, (uintptr_t) v); }
+static inline void dyn_box_set_ref (dyn_c* dyn, const dyn_c* v)
+{   dyn_box_set(dyn, (uintptr_t) v); }
+#else
 //! Mandatory initialization for dynamic elements (NONE)
 #define   DYN_INIT(dyn)       (dyn)->type=NONE
 //! Return type value of a dynamic element @see TYPE
 #define   DYN_TYPE(dyn)       (dyn)->type
+//! Change the type of a dynamic element, without touching its value
+#define   DYN_SET_TYPE(dyn,t) (dyn)->type=(t)
+//! Return the value of a dynamic element, field is a member of dyn_c.data
+#define   DYN_DATA(dyn,field) (dyn)->data.field
+//! Change the value of a dynamic element, without touching its type
+#define   DYN_SET_DATA(dyn,field,v) (dyn)->data.field=(v)
+#endif
 //! Check if dynamic element is of type NONE
 #define   DYN_IS_NONE(dyn)    !DYN_TYPE(dyn)
 //! Check if dynamic element is not of type NONE
@@ -55,6 +133,16 @@ trilean    dyn_copy            (const dyn_c* dyn,  dyn_c* copy);
 //! Move dynamic element to new reference, from is of type NONE afterwards
 void       dyn_move            (dyn_c* from, dyn_c* to);
 #define    DYN_MOVE(from, to)  *to = *from; DYN_INIT(from)
+//! Set dyn to NONE and free its content later on, see dyn_reclaim
+void       dyn_free_deferred   (dyn_c* dyn);
+//! Free up to budget deferred elements, DYN_TRUE if nothing is left
+trilean    dyn_reclaim         (dyn_uint budget);
+#ifdef S2_THREADS
+//! Start a background thread, which frees all deferred elements
+trilean    dyn_reclaim_start   (void);
+//! Stop the background thread, after all deferred elements were freed
+void       dyn_reclaim_stop    (void);
+#endif
 
 /** @brief Reterns the length of an element.
  *
@@ -64,6 +152,8 @@ void       dyn_move            (dyn_c* from, dyn_c* to);
 dyn_ushort dyn_length          (const dyn_c* dyn);
 //! Return the number of allocated bytes
 dyn_uint   dyn_size            (const dyn_c* dyn);
+//! Return the number of allocated bytes without nested elements
+dyn_uint   dyn_size_shallow    (const dyn_c* dyn);
 
 //! Set dynamic element to NONE
 void       dyn_set_none        (dyn_c* dyn);
@@ -109,6 +199,27 @@ dyn_ushort dyn_string_len      (const dyn_c* dyn);
 /**@}*/
 
 
+/**
+ * \defgroup DynamicAtomicOperations
+ *
+ * @brief Atomic operations on NONE, BOOL, INTEGER, and FLOAT elements, which
+ *        are shared between threads. With S2_NAN_BOXING every element is an
+ *        aligned 64bit word and all operations are lock-free, the packed
+ *        layout uses a small table of spin locks instead.
+ *
+ * @{
+ */
+//! Read the type and value of a shared scalar element
+trilean    dyn_atomic_load     (const dyn_c* slot, dyn_c* value);
+//! Replace a shared scalar element with another scalar
+trilean    dyn_atomic_store    (dyn_c* slot, const dyn_c* value);
+//! Add delta to a shared INTEGER or FLOAT and return the previous value
+trilean    dyn_atomic_add      (dyn_c* slot, const dyn_c* delta, dyn_c* old);
+//! Store desired, if slot equals expected, otherwise update expected
+trilean    dyn_atomic_cas      (dyn_c* slot, dyn_c* expected, const dyn_c* desired);
+/**@}*/
+
+
 
 /**
  * \defgroup DynamicList
@@ -120,15 +231,15 @@ dyn_ushort dyn_string_len      (const dyn_c* dyn);
 //! Initialize dyn as list with default length
 #define    DYN_SET_LIST(dyn)           dyn_set_list_len(dyn, LIST_DEFAULT)
 //! Return list length
-#define    DYN_LIST_LEN(dyn)           (dyn)->data.list->length
+#define    DYN_LIST_LEN(dyn)           DYN_DATA(dyn, list)->length
 //! Return the reference to the ith element within a dynamic list
-#define    DYN_LIST_GET_REF(dyn,i)     &(dyn)->data.list->container[i]
+#define    DYN_LIST_GET_REF(dyn,i)     &DYN_DATA(dyn, list)->container[i]
 //! Return the reference to the last element within a list
 #define    DYN_LIST_GET_END(dyn) \
-           &(dyn)->data.list->container[DYN_LIST_LEN(dyn)-1]
+           &DYN_DATA(dyn, list)->container[DYN_LIST_LEN(dyn)-1]
 //! Return the reference to the ith element starting from the last
 #define    DYN_LIST_GET_REF_END(dyn,i) \
-           &(dyn)->data.list->container[DYN_LIST_LEN(dyn)-i]
+           &DYN_DATA(dyn, list)->container[DYN_LIST_LEN(dyn)-i]
 
 //! Set dynamic element to list with maximal length
 trilean    dyn_set_list_len    (dyn_c* dyn, dyn_ushort len);
@@ -136,8 +247,20 @@ trilean    dyn_set_list_len    (dyn_c* dyn, dyn_ushort len);
 dyn_c*     dyn_list_push       (dyn_c* list, const dyn_c* element);
 //! Push NONE element to the end of a list
 dyn_c*     dyn_list_push_none  (dyn_c* list);
+//! Set dyn to a list of exactly len elements, copied from array
+trilean    dyn_set_list_array  (dyn_c* dyn, const dyn_c* array, const dyn_ushort len);
+//! Set dyn to a list of exactly len elements, moved from array
+trilean    dyn_set_list_array_move (dyn_c* dyn, dyn_c* array, const dyn_ushort len);
+//! Push copies of len elements from array to the end of a list
+trilean    dyn_list_append     (dyn_c* list, const dyn_c* array, const dyn_ushort len);
+//! Move len elements from array to the end of a list
+trilean    dyn_list_append_move (dyn_c* list, dyn_c* array, const dyn_ushort len);
 //! Pop the last element from the list and move it to param element
 trilean    dyn_list_pop        (dyn_c* list, dyn_c* element);
+//! Push new element to the front of a list, O(1) amortized
+dyn_c*     dyn_list_push_front (dyn_c* list, const dyn_c* element);
+//! Pop the first element from the list and move it to param element, O(1)
+trilean    dyn_list_pop_front  (dyn_c* list, dyn_c* element);
 //! Copy the ith element of a list to param element
 trilean    dyn_list_get        (const dyn_c* list, dyn_c* element, const dyn_short i);
 //! Return a reference to the ith element within list, negative values are allowed
@@ -152,12 +275,157 @@ trilean    dyn_list_copy       (const dyn_c* list, dyn_c* copy);
 trilean    dyn_list_remove     (dyn_c* list, dyn_ushort i);
 //! Insert a new element at the ith position into a list
 trilean    dyn_list_insert     (dyn_c* list, dyn_c* element, const dyn_ushort i);
+//! Replace del elements at position i with the elements of insert (moved)
+trilean    dyn_list_splice     (dyn_c* list, const dyn_ushort i, dyn_ushort del, dyn_c* insert);
+//! Remove all elements for which fct returns DYN_TRUE, in one pass
+dyn_ushort dyn_list_remove_if  (dyn_c* list,
+                                trilean (*fct)(const dyn_c*, const void*),
+                                const void* ctx);
 //! Change the maximal space of a list
 trilean    dyn_list_resize     (dyn_c* list, const dyn_ushort size);
 //! Return the length of the string representation of a list
 dyn_ushort dyn_list_string_len (const dyn_c* list);
 //! Add string representation of a list to str
 void       dyn_list_string_add (const dyn_c* list, dyn_str str);
+//! Sort all elements of a list in place
+trilean    dyn_list_sort       (dyn_c* list, const trilean stable);
+//! Sort a list of dictionaries in place by the values stored at key
+trilean    dyn_list_sort_key   (dyn_c* list, dyn_const_str key, const trilean stable);
+/**@}*/
+
+
+/**
+ * \defgroup DynamicBlock
+ *
+ * @brief Header blocks of lists and dictionaries, containers with up to
+ *        LIST_INLINE elements are stored within the header and freed blocks
+ *        are cached per thread.
+ *
+ * @{
+ */
+//! Allocate a list header with a container for len NONE elements
+dyn_list*  dyn_block_list      (const dyn_ushort len);
+//! Allocate a dictionary and its value list within one block
+dyn_dict*  dyn_block_dict      (const dyn_ushort len);
+//! Check if the container is stored within the header block
+trilean    dyn_block_inline    (const dyn_list* list);
+//! Free the container and the header block of an empty list
+void       dyn_block_free      (dyn_list* list);
+//! Resize the array of a list, including the gap in front, like realloc
+dyn_c*     dyn_block_resize    (dyn_list* list, const dyn_uint size);
+//! Free the replaced array of a list, if it is not inline
+void       dyn_block_release   (dyn_list* list);
+//! Return the number of bytes of a list, without its elements
+dyn_uint   dyn_block_size      (const dyn_list* list);
+/**@}*/
+
+
+/**
+ * \defgroup DynamicMemory
+ *
+ * @brief Memory contexts, which account for the memory of elements in O(1)
+ *        and limit it, such that constructors fail with DYN_FALSE. Interned
+ *        keys and shapes are shared globally and are not accounted, they are
+ *        outside the limit of every context. Without S2_MEMORY the
+ *        allocation functions are plain malloc, realloc, and free.
+ *
+ * @{
+ */
+#ifdef S2_MEMORY
+//! Create a context with a limit in bytes, 0 for unlimited
+dyn_memory* dyn_memory_new     (const dyn_uint limit);
+//! Free a context, whose memory was freed completely
+void        dyn_memory_free    (dyn_memory* mem);
+//! Set the context of the calling thread and return the previous one
+dyn_memory* dyn_memory_use     (dyn_memory* mem);
+//! Return the context of the calling thread
+dyn_memory* dyn_memory_current (void);
+//! Change the limit in bytes, 0 for unlimited
+void        dyn_memory_limit   (dyn_memory* mem, const dyn_uint limit);
+//! Return the number of bytes in use and the peak
+dyn_uint    dyn_memory_bytes   (const dyn_memory* mem, dyn_uint* peak);
+//! Return the number of blocks in use and the number of all allocations
+dyn_uint    dyn_memory_blocks  (const dyn_memory* mem, dyn_uint* total);
+
+//! Allocate within the context of the calling thread
+void*       dyn_mem_alloc      (const size_t size);
+//! Resize a block within its context
+void*       dyn_mem_realloc    (void* ptr, const size_t size);
+//! Free a block and return its memory to its context
+void        dyn_mem_free       (void* ptr);
+//! Account a detached block to the context of the calling thread
+trilean     dyn_mem_attach     (void* ptr);
+//! Return the memory of a block to its context, without freeing it
+void        dyn_mem_detach     (void* ptr);
+#else
+#define     dyn_mem_alloc(size)         malloc(size)
+#define     dyn_mem_realloc(ptr, size)  realloc(ptr, size)
+#define     dyn_mem_free(ptr)           free(ptr)
+#endif
+/**@}*/
+
+
+/**
+ * \defgroup DynamicView
+ *
+ * @brief Python-like slices, as borrowed views onto lists without copying.
+ *
+ * @{
+ */
+//! Omitted start or stop value of a slice, such as in list[::-1]
+#define    DYN_SLICE_NONE              INT32_MIN
+//! Return the number of elements within a view
+#define    DYN_VIEW_LEN(view)          (view)->length
+//! Return the reference to the ith element within a view
+#define    DYN_VIEW_GET_REF(view,i)    &(view)->base[(dyn_int)(i) * (view)->step]
+
+//! Create a view onto list[start:stop:step]
+trilean    dyn_list_slice      (const dyn_c* list, dyn_view* view,
+                                dyn_int start, dyn_int stop, dyn_int step);
+//! Create a view onto view[start:stop:step]
+trilean    dyn_view_slice      (const dyn_view* view, dyn_view* sub,
+                                dyn_int start, dyn_int stop, dyn_int step);
+//! Deep copy all elements of a view into a new list
+trilean    dyn_view_materialize(const dyn_view* view, dyn_c* list);
+/**@}*/
+
+
+/**
+ * \defgroup DynamicIterator
+ *
+ * @brief Uniform iteration over LIST, SET, DICT, and STRING, as well as
+ *        depth-first traversal of nested containers without recursion.
+ *
+ * @code
+ * dyn_iter it;
+ * dyn_c* elem;
+ * dyn_iter_init(&it, container);
+ * while ((elem = dyn_iter_next(&it))) {
+ *     ...
+ * }
+ * @endcode
+ *
+ * @{
+ */
+//! Initialize an iterator over a LIST, SET, DICT, or STRING
+trilean       dyn_iter_init    (dyn_iter* it, const dyn_c* container);
+//! Return a borrowed reference to the next element or NULL at the end
+dyn_c*        dyn_iter_next    (dyn_iter* it);
+//! Return the key of the element last returned from a DICT, otherwise NULL
+dyn_const_str dyn_iter_key     (const dyn_iter* it);
+
+//! Initialize a depth-first iterator over all elements nested within root
+trilean       dyn_tree_init    (dyn_tree_iter* it, const dyn_c* root);
+//! Return a borrowed reference to the next nested element or NULL at the end
+dyn_c*        dyn_tree_next    (dyn_tree_iter* it);
+//! Do not descend into the container that was returned last
+void          dyn_tree_skip    (dyn_tree_iter* it);
+//! Return the nesting depth of the element last returned, starting with 1
+dyn_ushort    dyn_tree_depth   (const dyn_tree_iter* it);
+//! Return the key of the element last returned from a DICT, otherwise NULL
+dyn_const_str dyn_tree_key     (const dyn_tree_iter* it);
+//! Free the memory allocated for deeply nested structures
+void          dyn_tree_free    (dyn_tree_iter* it);
 /**@}*/
 
 
@@ -179,6 +447,237 @@ trilean    dyn_set_insert      (dyn_c* set, dyn_c* element);
 /**@}*/
 
 
+/**
+ * \defgroup DynamicFrozen
+ *
+ * @brief Deeply immutable elements, which can be read by multiple threads
+ *        without locks or copies.
+ *
+ * @{
+ */
+//! Return a read-only reference to the frozen element
+#define      DYN_FROZEN_GET(frozen)   ((const dyn_c*) &(frozen)->value)
+
+//! Move dyn into a new frozen block with one reference
+dyn_frozen*  dyn_freeze        (dyn_c* dyn);
+//! Increase the reference counter atomically
+dyn_frozen*  dyn_frozen_ref    (dyn_frozen* frozen);
+//! Decrease the reference counter atomically, the last one frees the element
+void         dyn_frozen_free   (dyn_frozen* frozen);
+//! Return a read-only reference to the frozen element
+const dyn_c* dyn_frozen_get    (const dyn_frozen* frozen);
+/**@}*/
+
+#ifdef S2_THREADS
+/**
+ * \defgroup DynamicConcurrentDictionary
+ *
+ * @brief Hash dictionary for mutable state that is shared between threads,
+ *        with striped locks and epoch-based reclamation of replaced values.
+ *
+ * @{
+ */
+//! Create a new concurrent dictionary
+dyn_cdict*   dyn_cdict_new       (void);
+//! Free the dictionary and all values, no other thread may access it
+void         dyn_cdict_free      (dyn_cdict* dict);
+//! Insert or replace a copy of value
+trilean      dyn_cdict_insert    (dyn_cdict* dict, dyn_const_str key, const dyn_c* value);
+//! Remove key and its value
+trilean      dyn_cdict_remove    (dyn_cdict* dict, dyn_const_str key);
+//! Return a read-only reference to the value, only within dyn_epoch_enter/leave
+const dyn_c* dyn_cdict_get       (dyn_cdict* dict, dyn_const_str key);
+//! Copy the value stored at key
+trilean      dyn_cdict_get_copy  (dyn_cdict* dict, dyn_const_str key, dyn_c* copy);
+//! Return the number of keys
+dyn_uint     dyn_cdict_len       (dyn_cdict* dict);
+
+//! Enter a critical section, references obtained within remain valid
+trilean      dyn_epoch_enter     (void);
+//! Leave the critical section
+void         dyn_epoch_leave     (void);
+//! Free all retired values that cannot be accessed anymore
+trilean      dyn_epoch_reclaim   (void);
+/**@}*/
+#endif
+
+#ifdef S2_THREADS
+/**
+ * \defgroup DynamicQueue
+ *
+ * @brief Bounded lock-free queue, which moves elements between any number of
+ *        producer and consumer threads.
+ *
+ * @{
+ */
+//! Create an empty queue with space for at least size elements
+dyn_queue* dyn_queue_new             (const dyn_uint size);
+//! Free the queue and all remaining elements
+void       dyn_queue_free            (dyn_queue* q);
+//! Move an element to the end, DYN_FALSE if the queue is full or closed
+trilean    dyn_queue_push            (dyn_queue* q, dyn_c* value);
+//! Move the first element into value, DYN_FALSE if the queue is empty
+trilean    dyn_queue_pop             (dyn_queue* q, dyn_c* value);
+//! Move an element to the end, wait while the queue is full
+trilean    dyn_queue_push_wait       (dyn_queue* q, dyn_c* value);
+//! Move the first element into value, wait while the queue is empty
+trilean    dyn_queue_pop_wait        (dyn_queue* q, dyn_c* value);
+//! Move up to n elements to the end and return their number
+dyn_uint   dyn_queue_push_array      (dyn_queue* q, dyn_c* array, const dyn_uint n);
+//! Move up to n elements from the front and return their number
+dyn_uint   dyn_queue_pop_array       (dyn_queue* q, dyn_c* array, const dyn_uint n);
+//! Move up to n elements to the end, wait until at least one fits
+dyn_uint   dyn_queue_push_array_wait (dyn_queue* q, dyn_c* array, const dyn_uint n);
+//! Move up to n elements from the front, wait until at least one is available
+dyn_uint   dyn_queue_pop_array_wait  (dyn_queue* q, dyn_c* array, const dyn_uint n);
+//! Reject further pushes and wake all waiting threads
+void       dyn_queue_close           (dyn_queue* q);
+//! Return the current number of elements
+dyn_uint   dyn_queue_len             (dyn_queue* q);
+/**@}*/
+#endif
+
+#ifdef S2_THREADS
+/**
+ * \defgroup DynamicParallel
+ *
+ * @brief Work-stealing thread pool and parallel processing of large
+ *        containers.
+ *
+ * @{
+ */
+//! Create a pool with a number of worker threads
+dyn_pool*  dyn_pool_new        (const dyn_ushort threads);
+//! Stop all threads and free the pool
+void       dyn_pool_free       (dyn_pool* pool);
+//! Return the number of threads, including the calling thread
+dyn_ushort dyn_pool_threads    (const dyn_pool* pool);
+//! Call fct for chunks of the range [0, n) on all threads of the pool
+void       dyn_pool_for        (dyn_pool* pool, const dyn_uint n, dyn_uint chunk,
+                                void (*fct)(dyn_uint, dyn_uint, void*), void* ctx);
+
+//! Deep copy, large containers are copied in parallel
+trilean    dyn_copy_parallel   (dyn_pool* pool, const dyn_c* dyn, dyn_c* copy);
+//! Free an element, large containers are freed in parallel
+void       dyn_free_parallel   (dyn_pool* pool, dyn_c* dyn);
+//! Return the number of allocated bytes, large containers are counted in parallel
+dyn_uint   dyn_size_parallel   (dyn_pool* pool, const dyn_c* dyn);
+/**@}*/
+#endif
+
+/**
+ * \defgroup DynamicMap
+ *
+ * @brief Map, filter, and reduce over the elements of LIST, SET, and DICT,
+ *        sequentially without a pool or in parallel chunks with a pool.
+ *
+ * @{
+ */
+//! Apply fct onto all elements, results are stored at the same positions
+trilean dyn_map        (dyn_pool* pool, const dyn_c* dyn, dyn_c* result,
+                        trilean (*fct)(const dyn_c*, dyn_c*, void*), void* ctx);
+//! Copy all elements, for which fct returns DYN_TRUE, in order
+trilean dyn_filter     (dyn_pool* pool, const dyn_c* dyn, dyn_c* result,
+                        trilean (*fct)(const dyn_c*, void*), void* ctx);
+//! Combine all elements in order into acc
+trilean dyn_reduce     (dyn_pool* pool, const dyn_c* dyn, dyn_c* acc,
+                        trilean (*fct)(dyn_c*, const dyn_c*, void*), void* ctx);
+//! dyn_map with the C function of a FUNCTION element
+trilean dyn_map_fct    (dyn_pool* pool, const dyn_c* dyn, dyn_c* result, const dyn_c* fct);
+//! dyn_filter with the C function of a FUNCTION element
+trilean dyn_filter_fct (dyn_pool* pool, const dyn_c* dyn, dyn_c* result, const dyn_c* fct);
+//! dyn_reduce with the C function of a FUNCTION element
+trilean dyn_reduce_fct (dyn_pool* pool, const dyn_c* dyn, dyn_c* acc, const dyn_c* fct);
+/**@}*/
+
+/**
+ * \defgroup DynamicStep
+ *
+ * @brief Resumable string conversion, copy, and encoding, which process a
+ *        bounded number of elements per step, to be driven by event loops.
+ *
+ * @{
+ */
+//! Start a resumable dyn_get_string, the string is stored when finished
+dyn_step* dyn_step_string (const dyn_c* dyn, dyn_str* string);
+//! Start a resumable dyn_copy
+dyn_step* dyn_step_copy   (const dyn_c* dyn, dyn_c* copy);
+//! Process up to budget elements, DYN_NONE while work is left
+trilean   dyn_step_run    (dyn_step* step, dyn_uint budget);
+//! Free the continuation and abort an unfinished operation
+void      dyn_step_free   (dyn_step* step);
+/**@}*/
+
+/**
+ * \defgroup DynamicGC
+ *
+ * @brief Optional generational and incremental garbage collection of cells,
+ *        which are shared via references instead of being copied.
+ *
+ * @{
+ */
+//! Create an empty collector
+dyn_gc*  dyn_gc_new     (void);
+//! Free the collector and all of its cells
+void     dyn_gc_free    (dyn_gc* gc);
+//! Move value into a new young cell and return the value of the cell
+dyn_c*   dyn_gc_alloc   (dyn_gc* gc, dyn_c* value);
+//! Pin a cell as root of the collector
+trilean  dyn_gc_pin     (dyn_gc* gc, dyn_c* cell);
+//! Remove a pin of a cell
+void     dyn_gc_unpin   (dyn_gc* gc, dyn_c* cell);
+//! Write barrier, call after every change of a cell
+void     dyn_gc_barrier (dyn_gc* gc, dyn_c* cell);
+//! Process up to budget elements or cells, DYN_NONE while work is left
+trilean  dyn_gc_step    (dyn_gc* gc, dyn_uint budget);
+//! Finish the current collection and run a complete major collection
+void     dyn_gc_collect (dyn_gc* gc);
+//! Return the number of cells and the number of old cells
+dyn_uint dyn_gc_cells   (const dyn_gc* gc, dyn_uint* old);
+/**@}*/
+
+/**
+ * \defgroup DynamicAtom
+ *
+ * @brief Global symbol table, all dictionary keys are interned strings, which
+ *        are stored only once and compared by their address.
+ *
+ * @{
+ */
+//! Intern a string and increase its reference counter
+dyn_str       dyn_atom         (dyn_const_str str);
+//! Return the interned string or NULL, without increasing the counter
+dyn_const_str dyn_atom_find    (dyn_const_str str);
+//! Increase the reference counter of an interned string
+dyn_str       dyn_atom_ref     (dyn_const_str atom);
+//! Decrease the reference counter, unused atoms are freed
+void          dyn_atom_free    (dyn_const_str atom);
+//! Return the number of interned strings
+dyn_uint      dyn_atom_count   (void);
+/**@}*/
+
+/**
+ * \defgroup DynamicShape
+ *
+ * @brief Key layouts (hidden classes), which are shared by all dictionaries
+ *        with the same keys in the same order.
+ *
+ * @{
+ */
+//! Return the shape of empty dictionaries
+dyn_shape* dyn_shape_empty     (void);
+//! Increase the reference counter of a shape
+dyn_shape* dyn_shape_ref       (dyn_shape* shape);
+//! Decrease the reference counter, unused shapes are freed
+void       dyn_shape_free      (dyn_shape* shape);
+//! Return the shape with an additional key at the end
+dyn_shape* dyn_shape_add       (dyn_shape* shape, dyn_const_str key);
+//! Return the shape without the ith key, the last key is moved to i
+dyn_shape* dyn_shape_remove    (dyn_shape* shape, const dyn_ushort i);
+//! Check if shape has an interned key and return its position + 1
+dyn_ushort dyn_shape_has_atom  (const dyn_shape* shape, dyn_const_str atom);
+/**@}*/
+
 /**
  * \defgroup DynamicDictionary
  * @{
@@ -186,19 +685,23 @@ trilean    dyn_set_insert      (dyn_c* set, dyn_c* element);
 
 //! Return number of elements within a dictionary
 #define    DYN_DICT_LEN(dyn) \
-           dyn->data.dict->value.data.list->length
+           DYN_DATA(&DYN_DATA(dyn, dict)->value, list)->length
 //! Return a reference to the ith element stored within a dictionary
 #define    DYN_DICT_GET_I_REF(dyn,i) \
-           &(dyn)->data.dict->value.data.list->container[i]
+           &DYN_DATA(&DYN_DATA(dyn, dict)->value, list)->container[i]
 //! Return a reference to the ith key stored within a dictionary
-#define    DYN_DICT_GET_I_KEY(dyn,i)  (dyn)->data.dict->key[i]
+#define    DYN_DICT_GET_I_KEY(dyn,i)  DYN_DATA(dyn, dict)->shape->key[i]
 //! Return the maximal usable number of elements of a dictionary
-#define    DYN_DICT_SPACE(dyn)         dyn->value.data.list->space
+#define    DYN_DICT_SPACE(dyn)         DYN_DATA(&dyn->value, list)->space
 //! Return the number of elements stored within a dictionary
-#define    DYN_DICT_LENGTH(dyn)        dyn->value.data.list->length
+#define    DYN_DICT_LENGTH(dyn)        DYN_DATA(&dyn->value, list)->length
 
 //! Set dyn to a dictionary with a max. length of elements
 trilean    dyn_set_dict        (dyn_c* dyn,  const dyn_ushort length);
+//! Set dyn to a dictionary with copies of parallel key and value arrays
+trilean    dyn_set_dict_array  (dyn_c* dyn, const dyn_const_str* keys,
+                                const dyn_c* values, const dyn_ushort len,
+                                const trilean check);
 //! Replace the ith element in a dictionary with a new value
 trilean    dyn_dict_change     (dyn_c* dict, const dyn_ushort i, const dyn_c *value);
 //! Insert a new key-value pair into the dictionary
@@ -217,6 +720,13 @@ dyn_str    dyn_dict_get_i_key (const dyn_c* dict, const dyn_ushort i);
 
 //! Check if dict has key and return its position - 1 (returns 0 if not found)
 dyn_ushort dyn_dict_has_key   (const dyn_c* dict, dyn_const_str key);
+//! Check if dict has an interned key, compared by address only
+dyn_ushort dyn_dict_has_atom  (const dyn_c* dict, dyn_const_str atom);
+//! Get the reference to value stored at an interned key
+dyn_c*     dyn_dict_get_atom  (const dyn_c* dict, dyn_const_str atom);
+//! Get the reference to value stored at an interned key via an inline cache
+dyn_c*     dyn_dict_get_cached(const dyn_c* dict, dyn_const_str atom,
+                               dyn_dict_cache* cache);
 //! todo
 void       dyn_dict_empty     (dyn_c* dict);
 //! Free all allocated memory
@@ -239,7 +749,7 @@ void       dyn_dict_string_add(const dyn_c* dict, dyn_str string);
 #define   DYN_FCT_SYS   1
 #define   DYN_FCT_PROC  2
 
-#define   DYN_FCT_GET_CODE(dyn)  dyn->data.fct->ptr
+#define   DYN_FCT_GET_CODE(dyn)  DYN_DATA(dyn, fct)->ptr
 
 trilean   dyn_set_fct          (dyn_c* dyn, void *ptr, const dyn_ushort type, dyn_const_str info);
 void      dyn_fct_free         (dyn_c* dyn);
@@ -307,6 +817,19 @@ trilean dyn_op_div(dyn_c *dyn1, dyn_c *dyn2);
 trilean dyn_op_mod(dyn_c *dyn1, dyn_c *dyn2);
 //! dyn1 to the power of dyn2
 trilean dyn_op_pow(dyn_c *dyn1, dyn_c *dyn2);
+//! Switch FLOAT exponents between powf and fast_approx_pow
+trilean dyn_op_pow_approx(const trilean approx);
+
+//! Fused multiply-add, dyn1 = dyn1 + dyn2 * dyn3
+trilean dyn_op_muladd(dyn_c *dyn1, dyn_c *dyn2, dyn_c *dyn3);
+//! Increment NUMERIC value by a constant step
+trilean dyn_op_inc(dyn_c *dyn, const dyn_int step);
+//! Decrement NUMERIC value by a constant step
+trilean dyn_op_dec(dyn_c *dyn, const dyn_int step);
+//! Limit dyn to the range [min, max]
+trilean dyn_op_clamp(dyn_c *dyn, dyn_c *min, dyn_c *max);
+//! Apply op directly onto target, references are not copied
+trilean dyn_op_acc(dyn_c *target, trilean (*op)(dyn_c*, dyn_c*), dyn_c *dyn2);
 
 //! Logical (trinary) AND operation
 trilean dyn_op_and(dyn_c *dyn1, dyn_c *dyn2);
@@ -317,6 +840,22 @@ trilean dyn_op_xor(dyn_c *dyn1, dyn_c *dyn2);
 //! Logical (trinary) Negation
 trilean dyn_op_not(dyn_c *dyn);
 
+//! dyn1 == dyn2, result of dyn_op_cmp
+#define DYN_CMP_EQ    0
+//! dyn1 < dyn2 (or proper subset), result of dyn_op_cmp
+#define DYN_CMP_LT    1
+//! dyn1 > dyn2 (or proper superset), result of dyn_op_cmp
+#define DYN_CMP_GT    2
+//! dyn1 != dyn2, but no order can be defined (SET), result of dyn_op_cmp
+#define DYN_CMP_NEQ   3
+//! not comparable due to different data types, result of dyn_op_cmp
+#define DYN_CMP_TYPE  4
+
+//! Common compare function, returns one of the DYN_CMP_* values
+dyn_char dyn_op_cmp (const dyn_c *dyn1, const dyn_c *dyn2);
+//! Hash value of an element, equal elements result in equal hashes
+dyn_uint dyn_hash   (const dyn_c *dyn);
+
 //! Type and Value Equality
 trilean dyn_op_id (dyn_c *dyn1, dyn_c *dyn2);
 //! Relational Equality
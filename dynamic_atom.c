@@ -0,0 +1,251 @@
+/**
+ *  @file dynamic_atom.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of the global symbol table for interned strings.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#ifndef TARGET_ARDUNINO
+#include <pthread.h>
+static pthread_rwlock_t atom_lock = PTHREAD_RWLOCK_INITIALIZER;
+#define READ_LOCK()     pthread_rwlock_rdlock(&atom_lock)
+#define WRITE_LOCK()    pthread_rwlock_wrlock(&atom_lock)
+#define UNLOCK()        pthread_rwlock_unlock(&atom_lock)
+#else
+#define READ_LOCK()
+#define WRITE_LOCK()
+#define UNLOCK()
+#endif
+
+//! Initial number of slots of the symbol table
+#define ATOM_SLOTS  64
+
+/**
+ * Every atom is allocated only once, the reference counter and the hash value
+ * are stored in front of the string.
+ */
+typedef struct {
+    dyn_uint refs;      //!< number of references (dictionary keys, handles)
+    dyn_uint hash;      //!< hash value of str, see dyn_strhash
+    char     str[];     //!< the interned C string
+} atom;
+
+#define ATOM(S)     ((atom*) ((S) - offsetof(atom, str)))
+
+/**
+ * Open addressing hash table with linear probing, it is at most half full,
+ * such that there is always an empty slot, which terminates a search. The
+ * table is shared by all threads, searches hold the read lock, insertions and
+ * removals the write lock. Reference counters are changed atomically, they
+ * drop to zero only while the write lock is held, such that every atom that
+ * is found within the table is alive.
+ */
+static atom**   table = NULL;
+static dyn_uint slots = 0;
+static dyn_uint count = 0;
+
+
+//! Returns the slot of str or the empty slot where str has to be inserted
+static dyn_uint probe (dyn_const_str str, const dyn_uint hash)
+{
+    dyn_uint mask = slots - 1;
+    dyn_uint i = hash & mask;
+
+    while (table[i] && (table[i]->hash != hash || strcmp(table[i]->str, str)))
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+//! Doubles the size of the symbol table and rehashes all atoms
+static trilean grow (void)
+{
+    dyn_uint old = slots;
+    atom** old_table = table;
+    dyn_uint i;
+
+    slots = old ? old * 2 : ATOM_SLOTS;
+    table = (atom**) calloc(slots, sizeof(atom*));
+
+    if (!table) {
+        table = old_table;
+        slots = old;
+        return DYN_FALSE;
+    }
+
+    for (i=0; i<old; ++i) {
+        if (old_table[i]) {
+            dyn_uint j = old_table[i]->hash & (slots - 1);
+            while (table[j])
+                j = (j + 1) & (slots - 1);
+            table[j] = old_table[i];
+        }
+    }
+
+    free(old_table);
+    return DYN_TRUE;
+}
+
+/**
+ * Returns the atom for a string, which is stored only once, the same string
+ * always results in the same pointer, such that atoms can be compared by
+ * their addresses. Each call increases the reference counter of the atom,
+ * which has to be released with dyn_atom_free.
+ *
+ * @code
+ * dyn_const_str name = dyn_atom("name");
+ * dyn_dict_get_atom(&record, name);
+ * dyn_atom_free(name);
+ * @endcode
+ *
+ * @param[in] str C string
+ *
+ * @returns the interned string or NULL, if no memory could be allocated
+ */
+dyn_str dyn_atom (dyn_const_str str)
+{
+    dyn_uint hash = dyn_strhash(str);
+    atom* a = NULL;
+
+    // most keys are already interned, which requires only the read lock
+    READ_LOCK();
+    if (count) {
+        a = table[probe(str, hash)];
+        if (a)
+            __atomic_add_fetch(&a->refs, 1, __ATOMIC_RELAXED);
+    }
+    UNLOCK();
+
+    if (a)
+        return a->str;
+
+    WRITE_LOCK();
+    if (2 * (count + 1) > slots && !grow())
+        goto GOTO__END;
+
+    dyn_uint i = probe(str, hash);
+
+    if (!table[i]) {
+        size_t len = strlen(str);
+        table[i] = (atom*) malloc(sizeof(atom) + len + 1);
+        if (!table[i])
+            goto GOTO__END;
+
+        table[i]->refs = 0;
+        table[i]->hash = hash;
+        memcpy(table[i]->str, str, len + 1);
+        __atomic_add_fetch(&count, 1, __ATOMIC_RELAXED);
+    }
+
+    a = table[i];
+    __atomic_add_fetch(&a->refs, 1, __ATOMIC_RELAXED);
+
+GOTO__END:
+    UNLOCK();
+    return a ? a->str : NULL;
+}
+
+/**
+ * Searches the symbol table for a string, without creating a new atom or
+ * increasing the reference counter. The result only remains valid, if the
+ * caller holds a reference onto it (e.g. a dictionary with this key),
+ * otherwise it can be freed by another thread.
+ *
+ * @param[in] str C string
+ *
+ * @returns the interned string or NULL, if str is not interned
+ */
+dyn_const_str dyn_atom_find (dyn_const_str str)
+{
+    dyn_const_str a = NULL;
+
+    READ_LOCK();
+    if (count) {
+        dyn_uint i = probe(str, dyn_strhash(str));
+        if (table[i])
+            a = table[i]->str;
+    }
+    UNLOCK();
+
+    return a;
+}
+
+/**
+ * Increases the reference counter of an existing atom in O(1), which is used
+ * to share keys between copies of dictionaries.
+ *
+ * @param[in] str has to be an interned string, see dyn_atom
+ *
+ * @returns str
+ */
+dyn_str dyn_atom_ref (dyn_const_str str)
+{
+    __atomic_add_fetch(&ATOM(str)->refs, 1, __ATOMIC_RELAXED);
+
+    return (dyn_str) str;
+}
+
+/**
+ * Decreases the reference counter of an atom, if there are no references
+ * left, it is removed from the symbol table and freed.
+ *
+ * @param[in] str has to be an interned string or NULL
+ */
+void dyn_atom_free (dyn_const_str str)
+{
+    if (!str)
+        return;
+
+    atom* a = ATOM(str);
+    dyn_uint refs = __atomic_load_n(&a->refs, __ATOMIC_RELAXED);
+
+    // only the last reference requires the lock
+    while (refs > 1)
+        if (__atomic_compare_exchange_n(&a->refs, &refs, refs - 1, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+
+    WRITE_LOCK();
+    if (__atomic_sub_fetch(&a->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        dyn_uint mask = slots - 1;
+        dyn_uint i = probe(str, a->hash);
+        dyn_uint j = i;
+
+        // backward shift deletion, no tombstones are required
+        for (;;) {
+            table[i] = NULL;
+            do {
+                j = (j + 1) & mask;
+                if (!table[j])
+                    goto GOTO__END;
+            } while (((j - (table[j]->hash & mask)) & mask) <
+                     ((j - i) & mask));
+            table[i] = table[j];
+            i = j;
+        }
+GOTO__END:
+        __atomic_sub_fetch(&count, 1, __ATOMIC_RELAXED);
+        free(a);
+    }
+    UNLOCK();
+}
+
+/**
+ * @returns the number of currently interned strings
+ */
+dyn_uint dyn_atom_count (void)
+{
+    return __atomic_load_n(&count, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,269 @@
+/**
+ *  @file dynamic_atomic.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of atomic operations on scalar elements, which are
+ *         shared between threads, such as counters and gauges.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <stdint.h>
+
+#ifndef S2_NAN_BOXING
+//! Number of spin locks for the packed layout, selected by address
+#define ATOMIC_LOCKS 64
+
+static dyn_char atomic_lock[ATOMIC_LOCKS];
+
+static dyn_char* lock_of (const dyn_c* slot)
+{
+    uintptr_t addr = (uintptr_t) slot;
+    return &atomic_lock[(addr ^ (addr >> 6)) % ATOMIC_LOCKS];
+}
+
+static void lock (dyn_char* l)
+{
+    while (__atomic_test_and_set(l, __ATOMIC_ACQUIRE))
+        while (__atomic_load_n(l, __ATOMIC_RELAXED));
+}
+
+static void unlock (dyn_char* l)
+{
+    __atomic_clear(l, __ATOMIC_RELEASE);
+}
+#endif
+
+
+static trilean is_scalar (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+        case NONE:
+        case BOOL:
+        case INTEGER:
+        case FLOAT:     return DYN_TRUE;
+    }
+    return DYN_FALSE;
+}
+
+/**
+ * Computes the next value of a slot from its current value cur, returns
+ * DYN_TRUE to store next, any other value aborts the update.
+ */
+typedef trilean (*update_fct) (const dyn_c* cur, dyn_c* next, const void* arg);
+
+/**
+ * Applies fct atomically onto slot, with a compare-and-swap loop on the 64bit
+ * word of the NaN-boxed layout, or otherwise under a spin lock.
+ *
+ * @returns the result of fct for the value that was finally read
+ */
+static trilean update (dyn_c* slot, update_fct fct, const void* arg, dyn_c* old)
+{
+    dyn_c cur, next;
+    trilean rv;
+
+#ifdef S2_NAN_BOXING
+    cur.box = __atomic_load_n(&slot->box, __ATOMIC_ACQUIRE);
+    do {
+        next = cur;
+        rv = fct(&cur, &next, arg);
+        if (rv != DYN_TRUE)
+            break;
+    } while (!__atomic_compare_exchange_n(&slot->box, &cur.box, next.box, 0,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+#else
+    dyn_char* l = lock_of(slot);
+    lock(l);
+    cur = *slot;
+    next = cur;
+    rv = fct(&cur, &next, arg);
+    if (rv == DYN_TRUE)
+        *slot = next;
+    unlock(l);
+#endif
+
+    if (old)
+        *old = cur;
+
+    return rv;
+}
+
+/**
+ * Reads a scalar element, which is concurrently changed by other threads
+ * with the functions of this module.
+ *
+ * @param[in] slot shared element
+ * @param[out] value copy of the current type and value
+ *
+ * @retval DYN_TRUE   if slot is NONE, BOOL, INTEGER, or FLOAT
+ * @retval DYN_FALSE  otherwise, value is NONE
+ */
+trilean dyn_atomic_load (const dyn_c* slot, dyn_c* value)
+{
+#ifdef S2_NAN_BOXING
+    value->box = __atomic_load_n(&slot->box, __ATOMIC_ACQUIRE);
+#else
+    dyn_char* l = lock_of(slot);
+    lock(l);
+    *value = *slot;
+    unlock(l);
+#endif
+
+    if (is_scalar(value))
+        return DYN_TRUE;
+
+    DYN_INIT(value);
+    return DYN_FALSE;
+}
+
+static trilean store (const dyn_c* cur, dyn_c* next, const void* arg)
+{
+    if (!is_scalar(cur))
+        return DYN_FALSE;
+
+    *next = *(const dyn_c*) arg;
+    return DYN_TRUE;
+}
+
+/**
+ * Replaces the type and value of a scalar element. Since the element is not
+ * freed, both the current and the new value have to be scalars.
+ *
+ * @param[in, out] slot shared element
+ * @param[in] value NONE, BOOL, INTEGER, or FLOAT
+ *
+ * @retval DYN_TRUE   if the value was stored
+ * @retval DYN_FALSE  if slot or value is not a scalar
+ */
+trilean dyn_atomic_store (dyn_c* slot, const dyn_c* value)
+{
+    if (!is_scalar(value))
+        return DYN_FALSE;
+
+    return update(slot, store, value, NULL);
+}
+
+static trilean add (const dyn_c* cur, dyn_c* next, const void* arg)
+{
+    const dyn_c* delta = (const dyn_c*) arg;
+
+    switch (DYN_TYPE(cur)) {
+        case INTEGER:
+            if (DYN_TYPE(delta) != INTEGER)
+                return DYN_FALSE;
+            // wraps around like the hardware instructions
+            DYN_SET_DATA(next, i, (dyn_int) ((uint32_t) DYN_DATA(cur, i) +
+                                             (uint32_t) DYN_DATA(delta, i)));
+            return DYN_TRUE;
+        case FLOAT:
+            DYN_SET_DATA(next, f, DYN_DATA(cur, f) + dyn_get_float(delta));
+            return DYN_TRUE;
+    }
+
+    return DYN_FALSE;
+}
+
+/**
+ * Adds delta to an INTEGER or FLOAT element and returns the previous value.
+ * The type of slot is never changed, thus an INTEGER can only be increased by
+ * an INTEGER, while a FLOAT accepts both.
+ *
+ * @code
+ * dyn_c one;
+ * dyn_set_int(&one, 1);
+ * dyn_atomic_add(dyn_dict_get(&metrics, "requests"), &one, NULL);
+ * @endcode
+ *
+ * @param[in, out] slot shared INTEGER or FLOAT
+ * @param[in] delta INTEGER or FLOAT
+ * @param[out] old previous value, can be NULL
+ *
+ * @retval DYN_TRUE   if delta was added
+ * @retval DYN_FALSE  if the types do not match, slot remains unchanged
+ */
+trilean dyn_atomic_add (dyn_c* slot, const dyn_c* delta, dyn_c* old)
+{
+    switch (DYN_TYPE(delta)) {
+        case INTEGER:
+        case FLOAT:     return update(slot, add, delta, old);
+    }
+    return DYN_FALSE;
+}
+
+//! Elements are equal, if they have the same type and the same value
+static trilean same (const dyn_c* a, const dyn_c* b)
+{
+    if (DYN_TYPE(a) != DYN_TYPE(b))
+        return DYN_FALSE;
+
+    switch (DYN_TYPE(a)) {
+        case BOOL:      return DYN_DATA(a, b) == DYN_DATA(b, b);
+        case INTEGER:   return DYN_DATA(a, i) == DYN_DATA(b, i);
+        case FLOAT: {
+            // bitwise comparison, as done by the hardware
+            union { dyn_float f; uint32_t u; } x = { DYN_DATA(a, f) },
+                                               y = { DYN_DATA(b, f) };
+            return x.u == y.u;
+        }
+    }
+    return DYN_TRUE;
+}
+
+static trilean exchange (const dyn_c* cur, dyn_c* next, const void* arg)
+{
+    const dyn_c* const* pair = (const dyn_c* const*) arg;
+
+    if (!same(cur, pair[0]))
+        return DYN_FALSE;
+
+    *next = *pair[1];
+    return DYN_TRUE;
+}
+
+/**
+ * Stores desired, if slot still equals expected in type and value, otherwise
+ * expected is overwritten with the current value, such that the operation can
+ * be repeated in a loop.
+ *
+ * @code
+ * dyn_c cur, max;
+ * dyn_atomic_load(slot, &cur);
+ * do {
+ *     if (dyn_get_int(&cur) >= value) break;
+ *     dyn_set_int(&max, value);
+ * } while (!dyn_atomic_cas(slot, &cur, &max));
+ * @endcode
+ *
+ * @param[in, out] slot shared scalar element
+ * @param[in, out] expected assumed current value
+ * @param[in] desired new NONE, BOOL, INTEGER, or FLOAT
+ *
+ * @retval DYN_TRUE   if desired was stored
+ * @retval DYN_FALSE  if slot differed from expected
+ * @retval DYN_NONE   if any of the elements is not a scalar
+ */
+trilean dyn_atomic_cas (dyn_c* slot, dyn_c* expected, const dyn_c* desired)
+{
+    const dyn_c* pair[2] = { expected, desired };
+    dyn_c old;
+
+    if (!is_scalar(expected) || !is_scalar(desired))
+        return DYN_NONE;
+
+    if (update(slot, exchange, pair, &old) == DYN_TRUE)
+        return DYN_TRUE;
+
+    if (!is_scalar(&old))
+        return DYN_NONE;
+
+    *expected = old;
+    return DYN_FALSE;
+}
@@ -0,0 +1,291 @@
+/**
+ *  @file dynamic_block.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of the header blocks of lists and dictionaries,
+ *         with small containers stored inline and per-thread free lists.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <stddef.h>
+#include <string.h>
+
+//! Maximal number of free blocks of each kind, that are kept per thread
+#define BLOCK_CACHE 64
+
+// the caches are thread-local also without S2_THREADS, since independent
+// elements can always be used by different threads
+#ifndef TARGET_ARDUNINO
+#include <pthread.h>
+#define LOCAL __thread
+#else
+#define LOCAL
+#endif
+
+/**
+ * A list header with space for LIST_INLINE elements, which are used as the
+ * container as long as the list is small enough.
+ */
+typedef struct {
+    dyn_list list;
+    dyn_c    item[LIST_INLINE];
+} list_block;
+
+//! A dictionary header together with the header of its value list
+typedef struct {
+    dyn_dict   dict;
+    list_block value;
+} dict_block;
+
+enum {
+    BLOCK_LIST,
+    BLOCK_DICT
+};
+
+//! Free blocks of one kind, chained through their first bytes
+typedef struct {
+    void*      head;
+    dyn_ushort count;
+} block_cache;
+
+static LOCAL block_cache cache[2];
+
+#ifndef TARGET_ARDUNINO
+static pthread_key_t  cache_key;
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+static LOCAL trilean  cache_registered = DYN_FALSE;
+
+//! Frees all cached blocks of a thread on its termination
+static void cache_release (void* ptr)
+{
+    block_cache* c = (block_cache*) ptr;
+    dyn_ushort i;
+
+    for (i=0; i<2; ++i) {
+        while (c[i].head) {
+            void* next = *(void**) c[i].head;
+            dyn_mem_free(c[i].head);
+            c[i].head = next;
+        }
+        c[i].count = 0;
+    }
+}
+
+static void cache_init (void)
+{
+    pthread_key_create(&cache_key, cache_release);
+}
+#endif
+
+static void* block_get (const dyn_ushort kind, const size_t size)
+{
+    block_cache* c = &cache[kind];
+
+    if (c->head) {
+        void* block = c->head;
+#ifdef S2_MEMORY
+        // cached blocks do not belong to any context
+        if (!dyn_mem_attach(block))
+            return NULL;
+#endif
+        c->head = *(void**) block;
+        c->count--;
+        return block;
+    }
+
+    return dyn_mem_alloc(size);
+}
+
+static void block_put (const dyn_ushort kind, void* block)
+{
+    block_cache* c = &cache[kind];
+
+    if (c->count == BLOCK_CACHE) {
+        dyn_mem_free(block);
+        return;
+    }
+
+#ifdef S2_MEMORY
+    dyn_mem_detach(block);
+#endif
+
+#ifndef TARGET_ARDUNINO
+    if (!cache_registered) {
+        pthread_once(&cache_once, cache_init);
+        pthread_setspecific(cache_key, cache);
+        cache_registered = DYN_TRUE;
+    }
+#endif
+
+    *(void**) block = c->head;
+    c->head = block;
+    c->count++;
+}
+
+//! Initializes an empty list header with a container for len NONE elements
+static trilean list_init (list_block* block, dyn_ushort len)
+{
+    dyn_list* list = &block->list;
+
+    if (len <= LIST_INLINE) {
+        list->container = block->item;
+    } else {
+        list->container = (dyn_c*) dyn_mem_alloc(len * sizeof(dyn_c));
+        if (!list->container)
+            return DYN_FALSE;
+    }
+
+    list->space = len;
+    list->length = 0;
+    list->front = 0;
+    list->dict = DYN_FALSE;
+
+    while (len--)
+        DYN_INIT(&list->container[len]);
+
+    return DYN_TRUE;
+}
+
+/**
+ * Allocates a list header, the container is stored within the same block if
+ * it does not exceed LIST_INLINE elements. Blocks are taken from a free list
+ * of the calling thread, if possible.
+ *
+ * @param[in] len number of NONE elements, see dyn_set_list_len
+ *
+ * @returns an empty list or NULL, if no memory could be allocated
+ */
+dyn_list* dyn_block_list (const dyn_ushort len)
+{
+    list_block* block = (list_block*) block_get(BLOCK_LIST, sizeof(list_block));
+
+    if (block && !list_init(block, len)) {
+        block_put(BLOCK_LIST, block);
+        block = NULL;
+    }
+
+    return block ? &block->list : NULL;
+}
+
+/**
+ * Allocates a dictionary together with the header of its value list within
+ * one block, the value list is initialized as with dyn_block_list, the shape
+ * has to be set by the caller.
+ *
+ * @param[in] len number of NONE values, see dyn_set_dict
+ *
+ * @returns an empty dictionary or NULL, if no memory could be allocated
+ */
+dyn_dict* dyn_block_dict (const dyn_ushort len)
+{
+    dict_block* block = (dict_block*) block_get(BLOCK_DICT, sizeof(dict_block));
+
+    if (!block)
+        return NULL;
+
+    if (!list_init(&block->value, len)) {
+        block_put(BLOCK_DICT, block);
+        return NULL;
+    }
+
+    block->value.list.dict = DYN_TRUE;
+    DYN_SET_TYPE(&block->dict.value, LIST);
+    DYN_SET_DATA(&block->dict.value, list, &block->value.list);
+
+    return &block->dict;
+}
+
+/**
+ * @param[in] list
+ *
+ * @retval DYN_TRUE   if the container is stored within the header block
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_block_inline (const dyn_list* list)
+{
+    return list->container - list->front == ((const list_block*) list)->item;
+}
+
+/**
+ * Frees the container of a list, if it is not stored inline, and returns
+ * the header block to the free list of the calling thread. The header of the
+ * value list of a dictionary releases the entire dictionary block. The
+ * elements have to be freed previously.
+ *
+ * @param[in, out] list
+ */
+void dyn_block_free (dyn_list* list)
+{
+    if (!dyn_block_inline(list))
+        dyn_mem_free(list->container - list->front);
+
+    if (list->dict)
+        block_put(BLOCK_DICT, (char*) list - offsetof(dict_block, value));
+    else
+        block_put(BLOCK_LIST, list);
+}
+
+/**
+ * Changes the size of the allocated array of a list, including the gap in
+ * front of container, as realloc does. Inline containers are kept as long
+ * as they are large enough, otherwise they are copied into a new array.
+ *
+ * @param[in] list
+ * @param[in] size new number of elements, including the gap in front
+ *
+ * @returns the new begin of the array or NULL, the old array remains valid
+ */
+dyn_c* dyn_block_resize (dyn_list* list, const dyn_uint size)
+{
+    dyn_c* base = list->container - list->front;
+
+    if (!dyn_block_inline(list))
+        return (dyn_c*) dyn_mem_realloc(base, size * sizeof(dyn_c));
+
+    if (size <= LIST_INLINE)
+        return base;
+
+    dyn_c* array = (dyn_c*) dyn_mem_alloc(size * sizeof(dyn_c));
+    if (array)
+        memcpy(array, base, (list->front + list->space) * sizeof(dyn_c));
+
+    return array;
+}
+
+/**
+ * Frees the array of a list, which was replaced by a new one, inline
+ * containers are not freed.
+ *
+ * @param[in] list with the old container, front, and space
+ */
+void dyn_block_release (dyn_list* list)
+{
+    if (!dyn_block_inline(list))
+        dyn_mem_free(list->container - list->front);
+}
+
+/**
+ * @param[in] list
+ *
+ * @returns the number of bytes allocated for list, without the space
+ *          elements starting at container
+ */
+dyn_uint dyn_block_size (const dyn_list* list)
+{
+    dyn_uint bytes = list->dict ? sizeof(dict_block) : sizeof(list_block);
+
+    if (dyn_block_inline(list))
+        bytes -= list->space * sizeof(dyn_c);
+    else
+        bytes += list->front * sizeof(dyn_c);
+
+    return bytes;
+}
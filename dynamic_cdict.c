@@ -0,0 +1,507 @@
+/**
+ *  @file dynamic_cdict.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of a concurrent hash dictionary with striped locks
+ *         and epoch-based reclamation of replaced values.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#ifdef S2_THREADS
+
+#include <pthread.h>
+#include <string.h>
+
+//! Number of stripes (power of two), each with its own lock and hash table
+#define CDICT_STRIPES   64
+//! Initial number of buckets per stripe (power of two)
+#define CDICT_BUCKETS   8
+//! Maximal number of threads that are registered at once within epochs
+#define EPOCH_THREADS   256
+//! Number of retired values, after which reclamation is tried
+#define EPOCH_RETIRED   64
+
+#define CACHE_LINE      64
+
+
+typedef struct cdict_entry {
+    struct cdict_entry* next;
+    dyn_c*              value;  //!< heap allocated, retired on replacement
+    dyn_uint            hash;
+    char                key[];
+} cdict_entry;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    cdict_entry**    bucket;
+    dyn_uint         slots;
+    dyn_uint         count;
+} __attribute__ ((aligned (CACHE_LINE))) cdict_stripe;
+
+struct dynamic_cdict {
+    cdict_stripe stripe[CDICT_STRIPES];
+};
+
+typedef struct retired {
+    struct retired* next;
+    dyn_c*          value;
+    dyn_uint        epoch;
+} retired;
+
+/**
+ * Epoch of every registered thread, (epoch << 1) | 1 while the thread is
+ * within a critical section, 0 otherwise.
+ */
+typedef struct {
+    dyn_uint state;
+    dyn_uint used;
+} __attribute__ ((aligned (CACHE_LINE))) epoch_state;
+
+static epoch_state epoch_slot[EPOCH_THREADS];
+
+static dyn_uint        global_epoch = 1;
+static retired*        limbo = NULL;
+static dyn_uint        limbo_count = 0;
+static pthread_mutex_t limbo_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_key_t   epoch_key;
+static pthread_once_t  epoch_once = PTHREAD_ONCE_INIT;
+static __thread int    epoch_id = -1;
+static __thread int    epoch_depth = 0;
+
+
+//! Releases the epoch slot of a thread on its termination
+static void epoch_release (void* slot)
+{
+    __atomic_store_n(&((epoch_state*) slot)->state, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&((epoch_state*) slot)->used, 0, __ATOMIC_RELEASE);
+}
+
+static void epoch_init (void)
+{
+    pthread_key_create(&epoch_key, epoch_release);
+}
+
+//! Claims a free epoch slot for the calling thread
+static trilean epoch_register (void)
+{
+    int i;
+
+    pthread_once(&epoch_once, epoch_init);
+
+    for (i=0; i<EPOCH_THREADS; ++i) {
+        dyn_uint expected = 0;
+        if (__atomic_compare_exchange_n(&epoch_slot[i].used, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            epoch_id = i;
+            pthread_setspecific(epoch_key, &epoch_slot[i]);
+            return DYN_TRUE;
+        }
+    }
+
+    return DYN_FALSE;
+}
+
+/**
+ * Enters a critical section, all values returned by dyn_cdict_get remain
+ * valid until the section is left again with dyn_epoch_leave. Sections can be
+ * nested and should be short, since no replaced value can be freed while a
+ * thread remains within its section.
+ *
+ * @retval DYN_TRUE   if the section was entered
+ * @retval DYN_FALSE  if more than EPOCH_THREADS threads are registered
+ */
+trilean dyn_epoch_enter (void)
+{
+    if (epoch_id < 0 && !epoch_register())
+        return DYN_FALSE;
+
+    if (!epoch_depth++) {
+        dyn_uint epoch = __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&epoch_slot[epoch_id].state, (epoch << 1) | 1,
+                         __ATOMIC_SEQ_CST);
+    }
+
+    return DYN_TRUE;
+}
+
+/**
+ * Leaves a critical section, see dyn_epoch_enter.
+ */
+void dyn_epoch_leave (void)
+{
+    if (!--epoch_depth)
+        __atomic_store_n(&epoch_slot[epoch_id].state, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Advances the global epoch, if all threads within critical sections have
+ * seen the current epoch, and frees all values that were retired at least two
+ * epochs ago. The limbo lock has to be held.
+ */
+static void epoch_reclaim (void)
+{
+    dyn_uint epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+    int i;
+
+    for (i=0; i<EPOCH_THREADS; ++i) {
+        dyn_uint state = __atomic_load_n(&epoch_slot[i].state, __ATOMIC_SEQ_CST);
+        if ((state & 1) && (state >> 1) != epoch)
+            break;
+    }
+
+    if (i == EPOCH_THREADS)
+        __atomic_compare_exchange_n(&global_epoch, &epoch, epoch + 1, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+
+    epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+
+    retired** r = &limbo;
+    while (*r) {
+        if ((*r)->epoch + 2 <= epoch) {
+            retired* old = *r;
+            *r = old->next;
+            dyn_free(old->value);
+            free(old->value);
+            free(old);
+            --limbo_count;
+        } else {
+            r = &(*r)->next;
+        }
+    }
+}
+
+/**
+ * Frees a value, as soon as no thread can access it anymore. The limbo node r
+ * is allocated in advance by the caller, such that a value that was already
+ * unlinked can always be retired.
+ */
+static void retire (retired* r, dyn_c* value)
+{
+    r->value = value;
+
+    pthread_mutex_lock(&limbo_lock);
+    r->epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+    r->next = limbo;
+    limbo = r;
+    if (++limbo_count >= EPOCH_RETIRED)
+        epoch_reclaim();
+    pthread_mutex_unlock(&limbo_lock);
+}
+
+/**
+ * Tries to free all retired values, which is only possible for values that
+ * cannot be accessed by any thread within a critical section.
+ *
+ * @retval DYN_TRUE   if no retired values are left
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_epoch_reclaim (void)
+{
+    pthread_mutex_lock(&limbo_lock);
+    epoch_reclaim();
+    epoch_reclaim();
+    epoch_reclaim();
+    trilean empty = limbo ? DYN_FALSE : DYN_TRUE;
+    pthread_mutex_unlock(&limbo_lock);
+
+    return empty;
+}
+
+
+//! Returns the stripe of a hash value, the upper bits are used
+static cdict_stripe* stripe_of (dyn_cdict* dict, const dyn_uint hash)
+{
+    return &dict->stripe[hash >> 26 & (CDICT_STRIPES - 1)];
+}
+
+//! Returns the link to the entry of key or to the end of its bucket
+static cdict_entry** find (cdict_stripe* s, dyn_const_str key, const dyn_uint hash)
+{
+    cdict_entry** e = &s->bucket[hash & (s->slots - 1)];
+
+    while (*e && ((*e)->hash != hash || strcmp((*e)->key, key)))
+        e = &(*e)->next;
+
+    return e;
+}
+
+//! Doubles the number of buckets of a stripe, the write lock has to be held
+static void grow (cdict_stripe* s)
+{
+    dyn_uint slots = s->slots * 2;
+    cdict_entry** bucket = (cdict_entry**) calloc(slots, sizeof(cdict_entry*));
+    dyn_uint i;
+
+    if (!bucket)
+        return;
+
+    for (i=0; i<s->slots; ++i) {
+        cdict_entry* e = s->bucket[i];
+        while (e) {
+            cdict_entry* next = e->next;
+            e->next = bucket[e->hash & (slots - 1)];
+            bucket[e->hash & (slots - 1)] = e;
+            e = next;
+        }
+    }
+
+    free(s->bucket);
+    s->bucket = bucket;
+    s->slots = slots;
+}
+
+/**
+ * Creates a new concurrent dictionary, which is distributed onto
+ * CDICT_STRIPES independent hash tables, each protected by its own
+ * reader-writer lock. Lookups, insertions, and removals of different keys
+ * thus rarely block each other.
+ *
+ * @returns the new dictionary or NULL, if no memory could be allocated
+ */
+dyn_cdict* dyn_cdict_new (void)
+{
+    dyn_cdict* dict = NULL;
+    int i;
+
+    if (posix_memalign((void**) &dict, CACHE_LINE, sizeof(dyn_cdict)))
+        return NULL;
+
+    for (i=0; i<CDICT_STRIPES; ++i) {
+        cdict_stripe* s = &dict->stripe[i];
+        s->bucket = (cdict_entry**) calloc(CDICT_BUCKETS, sizeof(cdict_entry*));
+        if (!s->bucket) {
+            while (i--) {
+                pthread_rwlock_destroy(&dict->stripe[i].lock);
+                free(dict->stripe[i].bucket);
+            }
+            free(dict);
+            return NULL;
+        }
+        s->slots = CDICT_BUCKETS;
+        s->count = 0;
+        pthread_rwlock_init(&s->lock, NULL);
+    }
+
+    return dict;
+}
+
+/**
+ * Frees the dictionary and all stored values, no other thread must access it
+ * anymore. Values that were replaced before, are freed by the epoch
+ * reclamation.
+ *
+ * @param[in, out] dict
+ */
+void dyn_cdict_free (dyn_cdict* dict)
+{
+    int i;
+    dyn_uint j;
+
+    for (i=0; i<CDICT_STRIPES; ++i) {
+        cdict_stripe* s = &dict->stripe[i];
+        for (j=0; j<s->slots; ++j) {
+            cdict_entry* e = s->bucket[j];
+            while (e) {
+                cdict_entry* next = e->next;
+                dyn_free(e->value);
+                free(e->value);
+                free(e);
+                e = next;
+            }
+        }
+        free(s->bucket);
+        pthread_rwlock_destroy(&s->lock);
+    }
+
+    free(dict);
+    dyn_epoch_reclaim();
+}
+
+/**
+ * Inserts a copy of value, an existing value with the same key is replaced
+ * and freed as soon as no other thread within a critical section can access
+ * it anymore. The copy is created before any lock is acquired.
+ *
+ * @param[in, out] dict
+ * @param[in] key C string
+ * @param[in] value to copy
+ *
+ * @retval DYN_TRUE   if the value was inserted
+ * @retval DYN_FALSE  if no memory could be allocated
+ */
+trilean dyn_cdict_insert (dyn_cdict* dict, dyn_const_str key, const dyn_c* value)
+{
+    dyn_uint hash = dyn_strhash(key);
+    cdict_stripe* s = stripe_of(dict, hash);
+    dyn_c* copy = (dyn_c*) malloc(sizeof(dyn_c));
+    retired* r = (retired*) malloc(sizeof(retired));
+    dyn_c* old = NULL;
+
+    if (!copy || !r)
+        goto GOTO__ERROR;
+
+    DYN_INIT(copy);
+    if (!dyn_copy(value, copy))
+        goto GOTO__ERROR;
+
+    pthread_rwlock_wrlock(&s->lock);
+    cdict_entry** e = find(s, key, hash);
+    if (*e) {
+        old = __atomic_exchange_n(&(*e)->value, copy, __ATOMIC_ACQ_REL);
+    } else {
+        size_t len = strlen(key);
+        cdict_entry* entry = (cdict_entry*) malloc(sizeof(cdict_entry) + len + 1);
+        if (!entry) {
+            pthread_rwlock_unlock(&s->lock);
+            dyn_free(copy);
+            goto GOTO__ERROR;
+        }
+        entry->next = NULL;
+        entry->value = copy;
+        entry->hash = hash;
+        memcpy(entry->key, key, len + 1);
+        *e = entry;
+
+        if (__atomic_add_fetch(&s->count, 1, __ATOMIC_RELAXED) > 2 * s->slots)
+            grow(s);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    if (old)
+        retire(r, old);
+    else
+        free(r);
+
+    return DYN_TRUE;
+
+GOTO__ERROR:
+    free(copy);
+    free(r);
+    return DYN_FALSE;
+}
+
+/**
+ * Removes a key, its value is freed as soon as no other thread within a
+ * critical section can access it anymore.
+ *
+ * @param[in, out] dict
+ * @param[in] key C string
+ *
+ * @retval DYN_TRUE   if the key was found and removed
+ * @retval DYN_FALSE  if the key was not found or no memory could be allocated
+ */
+trilean dyn_cdict_remove (dyn_cdict* dict, dyn_const_str key)
+{
+    dyn_uint hash = dyn_strhash(key);
+    cdict_stripe* s = stripe_of(dict, hash);
+    cdict_entry* entry = NULL;
+    retired* r = (retired*) malloc(sizeof(retired));
+
+    if (!r)
+        return DYN_FALSE;
+
+    pthread_rwlock_wrlock(&s->lock);
+    cdict_entry** e = find(s, key, hash);
+    if (*e) {
+        entry = *e;
+        *e = entry->next;
+        __atomic_sub_fetch(&s->count, 1, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    if (!entry) {
+        free(r);
+        return DYN_FALSE;
+    }
+
+    retire(r, entry->value);
+    free(entry);
+    return DYN_TRUE;
+}
+
+/**
+ * Returns a reference to the value stored at key, which must only be read.
+ * The calling thread has to be within a critical section, the reference is
+ * valid until dyn_epoch_leave is called, even if the value is replaced or
+ * removed concurrently.
+ *
+ * @code
+ * dyn_epoch_enter();
+ * const dyn_c* value = dyn_cdict_get(registry, "service");
+ * // ... read value
+ * dyn_epoch_leave();
+ * @endcode
+ *
+ * @param[in] dict
+ * @param[in] key C string
+ *
+ * @returns reference to the value or NULL, if the key does not exist
+ */
+const dyn_c* dyn_cdict_get (dyn_cdict* dict, dyn_const_str key)
+{
+    dyn_uint hash = dyn_strhash(key);
+    cdict_stripe* s = stripe_of(dict, hash);
+    const dyn_c* value = NULL;
+
+    pthread_rwlock_rdlock(&s->lock);
+    cdict_entry** e = find(s, key, hash);
+    if (*e)
+        value = __atomic_load_n(&(*e)->value, __ATOMIC_ACQUIRE);
+    pthread_rwlock_unlock(&s->lock);
+
+    return value;
+}
+
+/**
+ * Copies the value stored at key, the critical section is entered and left
+ * internally.
+ *
+ * @param[in] dict
+ * @param[in] key C string
+ * @param[out] copy of the value
+ *
+ * @retval DYN_TRUE   if the key exists and the value could be copied
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_cdict_get_copy (dyn_cdict* dict, dyn_const_str key, dyn_c* copy)
+{
+    trilean rv = DYN_FALSE;
+
+    if (!dyn_epoch_enter())
+        return DYN_FALSE;
+
+    const dyn_c* value = dyn_cdict_get(dict, key);
+    if (value)
+        rv = dyn_copy(value, copy);
+
+    dyn_epoch_leave();
+
+    return rv;
+}
+
+/**
+ * @param[in] dict
+ *
+ * @returns the number of stored keys, which can already be outdated
+ */
+dyn_uint dyn_cdict_len (dyn_cdict* dict)
+{
+    dyn_uint len = 0;
+    int i;
+
+    for (i=0; i<CDICT_STRIPES; ++i)
+        len += __atomic_load_n(&dict->stripe[i].count, __ATOMIC_RELAXED);
+
+    return len;
+}
+
+#endif
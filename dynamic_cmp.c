@@ -0,0 +1,367 @@
+/**
+ *  @file dynamic_cmp.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of the dynamiC comparison engine and hashing.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#define max_type(A, B) (DYN_TYPE(A) > DYN_TYPE(B)) ? DYN_TYPE(A) : DYN_TYPE(B)
+
+#define DEREF(X)  (DYN_IS_REFERENCE(X) ? DYN_DATA(X, ref) : (X))
+
+//! number of nested lists, that can be compared without allocating memory
+#define CMP_STACK   16
+//! sets up to this length are compared without hashing
+#define CMP_LINEAR  8
+//! hash slots that are used from the stack, larger sets allocate memory
+#define CMP_SLOTS   64
+
+//! internal marker, both elements are lists of equal length
+#define CMP_DEEPER  5
+
+typedef struct {
+    const dyn_c* a;
+    const dyn_c* b;
+    dyn_ushort   i;
+} cmp_frame;
+
+typedef struct {
+    dyn_uint   hash;
+    dyn_ushort pos;         // position + 1, 0 marks an empty slot
+} cmp_slot;
+
+
+static dyn_uint hash_mix (dyn_uint h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * Numerical values are hashed via their float representation, such that
+ * INTEGER, FLOAT, and BOOL values that compare equal also result in the same
+ * hash value.
+ */
+static dyn_uint hash_number (const dyn_float f)
+{
+    union { dyn_float f; dyn_uint u; } v = { f == 0.0f ? 0.0f : f };
+    return hash_mix(v.u);
+}
+
+/**
+ * Hashes only the first level of an element, nested containers are only
+ * represented by their type and length, which is sufficient, since equal
+ * containers always have the same type and length.
+ */
+static dyn_uint hash_shallow (const dyn_c* dyn)
+{
+    dyn = DEREF(dyn);
+
+    switch (DYN_TYPE(dyn)) {
+        case NONE:      return 0;
+        case BOOL:
+        case INTEGER:
+        case FLOAT:     return hash_number(dyn_get_float(dyn));
+        case STRING:    return dyn_strhash(DYN_DATA(dyn, str));
+#ifdef S2_SET
+        case SET:
+#endif
+        case LIST:
+        case DICT:      return hash_mix((DYN_TYPE(dyn) << 16) ^ dyn_length(dyn));
+        case FUNCTION:  return hash_mix((dyn_uint)(uintptr_t) DYN_DATA(dyn, fct));
+        case EXTERN:    return hash_mix((dyn_uint)(uintptr_t) DYN_DATA(dyn, ex));
+    }
+
+    return DYN_TYPE(dyn);
+}
+
+/**
+ * The hash value covers the element and the first level of contained elements
+ * in case of a LIST or SET. The hash of a SET is independent from the order of
+ * its elements. All elements that are equal according to dyn_op_cmp result in
+ * the same hash value, it is thus applicable for sets, deduplication, or
+ * hash-tables.
+ *
+ * @param dyn element to hash
+ *
+ * @returns 32bit hash value
+ */
+dyn_uint dyn_hash (const dyn_c* dyn)
+{
+    dyn = DEREF(dyn);
+
+    dyn_uint hash = hash_shallow(dyn);
+    dyn_ushort i;
+
+    switch (DYN_TYPE(dyn)) {
+        case LIST:
+            for (i=0; i<DYN_LIST_LEN(dyn); ++i)
+                hash = hash * 31 + hash_shallow(DYN_LIST_GET_REF(dyn, i));
+            break;
+#ifdef S2_SET
+        case SET:
+            for (i=0; i<DYN_LIST_LEN(dyn); ++i)
+                hash += hash_shallow(DYN_LIST_GET_REF(dyn, i));
+            break;
+#endif
+    }
+
+    return hash;
+}
+
+static dyn_char cmp_set (const dyn_c* set1, const dyn_c* set2);
+
+/**
+ * Compares two elements that are not of type REFERENCE and returns either the
+ * final result or CMP_DEEPER, if both elements are lists of equal length, whose
+ * elements have to be compared one by one.
+ */
+static dyn_char cmp_node (const dyn_c* dyn1, const dyn_c* dyn2)
+{
+    if (DYN_IS_NONE(dyn1))
+        return DYN_IS_NONE(dyn2) ? DYN_CMP_EQ : DYN_CMP_LT;
+    if (DYN_IS_NONE(dyn2))
+        return DYN_CMP_GT;
+
+    switch (max_type(dyn1, dyn2)) {
+        case BOOL: {
+            trilean a = dyn_get_bool(dyn1);
+            trilean b = dyn_get_bool(dyn2);
+            return a < b ? DYN_CMP_LT : (a > b ? DYN_CMP_GT : DYN_CMP_EQ);
+        }
+        case INTEGER: {
+            dyn_int a = dyn_get_int(dyn1);
+            dyn_int b = dyn_get_int(dyn2);
+            return a < b ? DYN_CMP_LT : (a > b ? DYN_CMP_GT : DYN_CMP_EQ);
+        }
+        case FLOAT: {
+            dyn_float a = dyn_get_float(dyn1);
+            dyn_float b = dyn_get_float(dyn2);
+            return a < b ? DYN_CMP_LT : (a > b ? DYN_CMP_GT : DYN_CMP_EQ);
+        }
+        case STRING: {
+            if (DYN_TYPE(dyn1) != DYN_TYPE(dyn2))
+                return DYN_CMP_TYPE;
+
+            dyn_char ret = dyn_strcmp(DYN_DATA(dyn1, str), DYN_DATA(dyn2, str));
+            return ret < 0 ? DYN_CMP_LT : (ret > 0 ? DYN_CMP_GT : DYN_CMP_EQ);
+        }
+#ifdef S2_SET
+        case SET: {
+            if (DYN_TYPE(dyn1) != DYN_TYPE(dyn2))
+                return DYN_CMP_TYPE;
+            return cmp_set(dyn1, dyn2);
+        }
+#endif
+        case LIST: {
+            if (DYN_TYPE(dyn1) != DYN_TYPE(dyn2))
+                return DYN_CMP_TYPE;
+            if (DYN_LIST_LEN(dyn1) < DYN_LIST_LEN(dyn2))
+                return DYN_CMP_LT;
+            if (DYN_LIST_LEN(dyn1) > DYN_LIST_LEN(dyn2))
+                return DYN_CMP_GT;
+            return DYN_LIST_LEN(dyn1) ? CMP_DEEPER : DYN_CMP_EQ;
+        }
+    }
+
+    return DYN_CMP_TYPE;
+}
+
+/**
+ * Type and value equality, as it is applied for elements of a set.
+ */
+static trilean cmp_id (const dyn_c* dyn1, const dyn_c* dyn2)
+{
+    return (DYN_TYPE(DEREF(dyn1)) == DYN_TYPE(DEREF(dyn2)) &&
+            dyn_op_cmp(dyn1, dyn2) == DYN_CMP_EQ) ? DYN_TRUE : DYN_FALSE;
+}
+
+/**
+ * Checks if all elements of lset are included in rset, small sets are searched
+ * linearly, for larger sets a temporary open addressing hash table with the
+ * positions of all elements in rset is generated.
+ */
+static trilean cmp_subset (const dyn_c* lset, const dyn_c* rset)
+{
+    dyn_ushort n = DYN_LIST_LEN(lset);
+    dyn_ushort m = DYN_LIST_LEN(rset);
+    dyn_ushort i, j;
+
+    if (m <= CMP_LINEAR) {
+        for (i=0; i<n; ++i) {
+            for (j=0; j<m; ++j)
+                if (cmp_id(DYN_LIST_GET_REF(lset, i), DYN_LIST_GET_REF(rset, j)))
+                    break;
+            if (j == m)
+                return DYN_FALSE;
+        }
+        return DYN_TRUE;
+    }
+
+    cmp_slot  local[CMP_SLOTS];
+    cmp_slot* table = local;
+    dyn_uint  size = CMP_SLOTS;
+    dyn_uint  h, k;
+    trilean   ret = DYN_TRUE;
+
+    while (size < 2 * (dyn_uint)m)
+        size <<= 1;
+
+    if (size > CMP_SLOTS) {
+        table = (cmp_slot*) malloc(size * sizeof(cmp_slot));
+        if (!table)
+            return DYN_NONE;
+    }
+
+    for (k=0; k<size; ++k)
+        table[k].pos = 0;
+
+    for (j=0; j<m; ++j) {
+        h = dyn_hash(DYN_LIST_GET_REF(rset, j));
+        for (k=h & (size-1); table[k].pos; k=(k+1) & (size-1));
+        table[k].hash = h;
+        table[k].pos  = j+1;
+    }
+
+    for (i=0; i<n && ret; ++i) {
+        const dyn_c* elem = DYN_LIST_GET_REF(lset, i);
+        h = dyn_hash(elem);
+        ret = DYN_FALSE;
+        for (k=h & (size-1); table[k].pos; k=(k+1) & (size-1)) {
+            if (table[k].hash == h &&
+                cmp_id(elem, DYN_LIST_GET_REF(rset, table[k].pos-1))) {
+                ret = DYN_TRUE;
+                break;
+            }
+        }
+    }
+
+    if (table != local)
+        free(table);
+
+    return ret;
+}
+
+/**
+ * Sets are equal if they have the same length and all elements of one set are
+ * also included in the other one, a smaller set is less than the other one if
+ * it is a subset. All other cases are DYN_CMP_NEQ.
+ */
+static dyn_char cmp_set (const dyn_c* set1, const dyn_c* set2)
+{
+    dyn_char ret;
+    const dyn_c *lset, *rset;
+
+    if (DYN_LIST_LEN(set1) == DYN_LIST_LEN(set2)) {
+        ret = DYN_CMP_EQ;
+        lset = set1;
+        rset = set2;
+    } else if (DYN_LIST_LEN(set1) < DYN_LIST_LEN(set2)) {
+        ret = DYN_CMP_LT;
+        lset = set1;
+        rset = set2;
+    } else {
+        ret = DYN_CMP_GT;
+        lset = set2;
+        rset = set1;
+    }
+
+    switch (cmp_subset(lset, rset)) {
+        case DYN_TRUE:  return ret;
+        case DYN_FALSE: return DYN_CMP_NEQ;
+        default:        return DYN_CMP_TYPE;
+    }
+}
+
+/**
+ * @brief Common compare function for dynamic elements
+ *
+ * Basic compare function for dynamic data dypes, based on the relation between
+ * the input parameters, different values are returned, see the list below.
+ * Both elements are compared in place, nested lists are traversed with an
+ * explicit stack instead of recursion, such that also deeply nested lists can
+ * be compared. Memory is only allocated for lists nested deeper than CMP_STACK
+ * or for sets with more than CMP_SLOTS/2 elements.
+ *
+ * @param dyn1 first dynamic parameter
+ * @param dyn2 second dynamic parameter
+ *
+ * @retval DYN_CMP_EQ   (0) if dyn1 == dyn2
+ * @retval DYN_CMP_LT   (1) if dyn1 < dyn2
+ * @retval DYN_CMP_GT   (2) if dyn1 > dyn2
+ * @retval DYN_CMP_NEQ  (3) if dyn1 != dyn2
+ * @retval DYN_CMP_TYPE (4) if not comparable due to different data types
+ *                          (STRING <= SET)
+ */
+dyn_char dyn_op_cmp (const dyn_c* dyn1, const dyn_c* dyn2)
+{
+    cmp_frame  local[CMP_STACK];
+    cmp_frame* stack = local;
+    dyn_uint   space = CMP_STACK;
+    dyn_uint   depth = 0;
+
+    dyn1 = DEREF(dyn1);
+    dyn2 = DEREF(dyn2);
+
+    dyn_char ret = cmp_node(dyn1, dyn2);
+
+    while (ret == CMP_DEEPER) {
+        if (depth == space) {
+            cmp_frame* tmp = (cmp_frame*) malloc(2 * space * sizeof(cmp_frame));
+            if (!tmp) {
+                ret = DYN_CMP_TYPE;
+                break;
+            }
+            dyn_uint i;
+            for (i=0; i<depth; ++i)
+                tmp[i] = stack[i];
+            if (stack != local)
+                free(stack);
+            stack = tmp;
+            space *= 2;
+        }
+
+        stack[depth].a = dyn1;
+        stack[depth].b = dyn2;
+        stack[depth].i = 0;
+        ++depth;
+
+        ret = DYN_CMP_EQ;
+        while (depth) {
+            cmp_frame* top = &stack[depth-1];
+            if (top->i == DYN_LIST_LEN(top->a)) {
+                --depth;
+                continue;
+            }
+
+            dyn1 = DEREF(DYN_LIST_GET_REF(top->a, top->i));
+            dyn2 = DEREF(DYN_LIST_GET_REF(top->b, top->i));
+            ++top->i;
+
+            ret = cmp_node(dyn1, dyn2);
+            if (ret != DYN_CMP_EQ)
+                break;
+        }
+
+        if (ret != CMP_DEEPER)
+            break;
+    }
+
+    if (stack != local)
+        free(stack);
+
+    return ret;
+}
@@ -17,5 +17,19 @@
 
 #define LIST_DEFAULT 5
 #define DICT_DEFAULT 6
+// lists and dictionaries with up to LIST_INLINE elements require only one
+// allocation, the elements are stored within the header block
+#define LIST_INLINE  6
+// dictionaries with more keys get a private shape, see dyn_shape_add
+#define SHAPE_MAX    32
+
+// store type and value of dyn_c within one tagged 64bit word
+//#define S2_NAN_BOXING
+
+// enable functions that require pthreads, such as dyn_reclaim_start
+//#define S2_THREADS
+
+// account the memory of elements to contexts with limits, see dyn_memory_new
+//#define S2_MEMORY
 
 //#define TARGET_ARDUNINO
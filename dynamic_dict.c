@@ -14,6 +14,8 @@
 
 #include "dynamic.h"
 
+#include <string.h>
+
 /**
  *
  * @param[in, out] dyn element which is initialized as a dictionary
@@ -26,24 +28,15 @@ trilean dyn_set_dict (dyn_c* dyn, dyn_ushort length)
 {
     dyn_free(dyn);
 
-    dyn_dict *dict = (dyn_dict*) malloc(sizeof(dyn_dict));
+    // dictionary, value list, and small containers share one block
+    dyn_dict *dict = dyn_block_dict(length);
 
     if (dict) {
-        DYN_INIT(&dict->value);
-        if (dyn_set_list_len(&dict->value, length)) {
-            dict->key = (dyn_str*) malloc(length * sizeof(dyn_str*));
-            if (dict->key) {
-                dyn_ushort i;
-                for (i=0; i<length; ++i)
-                    dict->key[i] = NULL;
-
-                dyn->type = DICT;
-                dyn->data.dict = dict;
-                return DYN_TRUE;
-            }
-            dyn_free(&dict->value);
-        }
-        free(dict);
+        dict->shape = dyn_shape_empty();
+
+        DYN_SET_TYPE(dyn, DICT);
+        DYN_SET_DATA(dyn, dict, dict);
+        return DYN_TRUE;
     }
 
     return DYN_FALSE;
@@ -52,8 +45,9 @@ trilean dyn_set_dict (dyn_c* dyn, dyn_ushort length)
 /**
  * If the key is already contained within the dictionary, then the current
  * value is overwritten, if not then the new value is added to the end of the
- * list as well as a new key. If the maximal space is exceeded, then new memory
- * is attached as defined in DICT_DEFAULT.
+ * list and the dictionary gets the shape with the additional key, see
+ * dyn_shape_add. If the maximal space is exceeded, then new memory is attached
+ * as defined in DICT_DEFAULT.
  *
  * @param[in, out] dict has to be of type DICT
  * @param[in] key
@@ -64,28 +58,20 @@ trilean dyn_set_dict (dyn_c* dyn, dyn_ushort length)
  */
 dyn_c* dyn_dict_insert(dyn_c* dict, dyn_const_str key, dyn_c* value)
 {
-    dyn_dict* ptr = dict->data.dict;
+    dyn_dict* ptr = DYN_DATA(dict, dict);
     dyn_ushort space = DYN_DICT_SPACE(ptr);
     dyn_ushort i = dyn_dict_has_key(dict, key);
     if (i--)
         goto GOTO__CHANGE; //return dyn_dict_change(dyn, i-1, value);
 
-    if (DYN_DICT_LENGTH(ptr) == space) {
-        dyn_dict_resize(dict, space + DICT_DEFAULT);
-        /*if (dyn_list_resize(&dyn->data.dict->value, space)) {
-            dyn->data.dict->key = (dyn_str*) realloc(dyn->data.dict->key, space * sizeof(dyn_str*));
-            if (dyn->data.dict->key) {
-                for (i=space - DICT_DEFAULT; i<space; ++i)
-                    dyn->data.dict->key[i] = NULL;
-            }
-        }*/
-    }
+    if (DYN_DICT_LENGTH(ptr) == space)
+        if (!dyn_dict_resize(dict, space + DICT_DEFAULT))
+            return NULL;
 
-    i = DYN_DICT_LENGTH(ptr);
-    ptr->key[i] = (dyn_str) malloc(dyn_strlen(key)+1);
-    if (ptr->key[i]) {
-        dyn_strcpy(ptr->key[i], key);
-        DYN_DICT_LENGTH(ptr)++;
+    dyn_shape* shape = dyn_shape_add(ptr->shape, key);
+    if (shape) {
+        ptr->shape = shape;
+        i = DYN_DICT_LENGTH(ptr)++;
 
 GOTO__CHANGE:
         dyn_dict_change(dict, i, value);
@@ -96,8 +82,8 @@ GOTO__CHANGE:
 }
 
 /**
- * Increase or decrease the size of the dictionary to a new size, removed
- * elements have to be of type NONE.
+ * Increase the space for values of the dictionary to a new size, the keys are
+ * stored within the shape.
  *
  * @param[in, out] dict has to be of type DICT
  * @param[in] size new
@@ -107,19 +93,12 @@ GOTO__CHANGE:
  */
 trilean dyn_dict_resize(dyn_c* dict, dyn_ushort size)
 {
-    dyn_dict* ptr = dict->data.dict;
+    dyn_dict* ptr = DYN_DATA(dict, dict);
 
     dyn_ushort space = DYN_DICT_SPACE(ptr);
 
     if (size > space)
-        if (dyn_list_resize(&ptr->value, size)) {
-            ptr->key = (dyn_str*) realloc(ptr->key, size * sizeof(dyn_str*));
-            if (ptr->key) {
-                for (; space<size; ++space)
-                    ptr->key[space] = NULL;
-                return DYN_TRUE;
-            }
-        }
+        return dyn_list_resize(&ptr->value, size);
 
     return DYN_FALSE;
 }
@@ -127,14 +106,16 @@ trilean dyn_dict_resize(dyn_c* dict, dyn_ushort size)
 
 trilean dyn_dict_change (dyn_c* dict, const dyn_ushort i, const dyn_c* value)
 {
-    return dyn_copy(value, DYN_LIST_GET_REF(&dict->data.dict->value, i));
+    return dyn_copy(value, DYN_LIST_GET_REF(&DYN_DATA(dict, dict)->value, i));
 }
 
 /**
  * Searches the dictionary for a certain key, if this key could be found, then
  * its position plus 1 is returned, to indicate that the key was found, even if
  * it is on position 0, otherwise 0 is returned. Thus, the returned value has
- * to be decreased by one if it is larger than 0.
+ * to be decreased by one if it is larger than 0. All keys are interned, see
+ * dyn_atom, thus the key is looked up once within the symbol table and then
+ * compared by its address, a match is confirmed by a single string compare.
  *
  * @param dict to be searched has to be of type DICT
  * @param key C-string to search for
@@ -144,15 +125,30 @@ trilean dyn_dict_change (dyn_c* dict, const dyn_ushort i, const dyn_c* value)
  */
 dyn_ushort dyn_dict_has_key (const dyn_c* dict, dyn_const_str key)
 {
-    dyn_char** s_key = dict->data.dict->key;
-    dyn_ushort length = DYN_DICT_LENGTH(dict->data.dict);
-    dyn_ushort i;
-    for (i=0; i<length; ++i, ++s_key) {
-        if (!dyn_strcmp(*s_key, key))
-            return i+1;
-    }
+    dyn_const_str atom = dyn_atom_find(key);
+    dyn_ushort pos = atom ? dyn_dict_has_atom(dict, atom) : 0;
+
+    // atom is not referenced by this call, if it does not belong to dict, it
+    // might have been freed and reused for another key by another thread
+    if (pos && strcmp(DYN_DICT_GET_I_KEY(dict, pos-1), key))
+        return 0;
 
-    return 0;
+    return pos;
+}
+
+/**
+ * Same as dyn_dict_has_key, but for a key that was already interned with
+ * dyn_atom, the symbol table is thus not searched at all.
+ *
+ * @param dict to be searched has to be of type DICT
+ * @param atom interned C-string to search for
+ *
+ * @retval 0 if the key was not found
+ * @retval position+1 otherwise
+ */
+dyn_ushort dyn_dict_has_atom (const dyn_c* dict, dyn_const_str atom)
+{
+    return dyn_shape_has_atom(DYN_DATA(dict, dict)->shape, atom);
 }
 
 /**
@@ -167,7 +163,7 @@ dyn_ushort dyn_dict_has_key (const dyn_c* dict, dyn_const_str key)
  */
 dyn_c* dyn_dict_get_i_ref (const dyn_c* dict, const dyn_ushort i)
 {
-    return dyn_list_get_ref(&dict->data.dict->value, i);
+    return dyn_list_get_ref(&DYN_DATA(dict, dict)->value, i);
 }
 
 /**
@@ -182,7 +178,7 @@ dyn_c* dyn_dict_get_i_ref (const dyn_c* dict, const dyn_ushort i)
  */
 dyn_str dyn_dict_get_i_key (const dyn_c* dict, const dyn_ushort i)
 {
-    return dict->data.dict->key[i];
+    return DYN_DICT_GET_I_KEY(dict, i);
 }
 
 /**
@@ -198,22 +194,22 @@ dyn_str dyn_dict_get_i_key (const dyn_c* dict, const dyn_ushort i)
  */
 trilean dyn_dict_remove (dyn_c* dict, dyn_const_str key)
 {
-    dyn_dict* ptr = dict->data.dict;
+    dyn_dict* ptr = DYN_DATA(dict, dict);
     dyn_ushort i = dyn_dict_has_key(dict, key);
 
     if(i) {
-        free(ptr->key[--i]);
-        ptr->key[i] = NULL;
+        dyn_shape* shape = dyn_shape_remove(ptr->shape, --i);
+        if (!shape)
+            return DYN_FALSE;
+        ptr->shape = shape;
+
         dyn_free(DYN_DICT_GET_I_REF(dict, i));
-        ptr->value.data.list->length--;
+        DYN_DATA(&ptr->value, list)->length--;
 
         // if not last element
-        if (i != ptr->value.data.list->length && ptr->value.data.list->length) {
-            ptr->key[i] = ptr->key[ptr->value.data.list->length];
-            ptr->key[ptr->value.data.list->length] = NULL;
-            dyn_move(DYN_DICT_GET_I_REF(dict, ptr->value.data.list->length),
+        if (i != DYN_DATA(&ptr->value, list)->length)
+            dyn_move(DYN_DICT_GET_I_REF(dict, DYN_DATA(&ptr->value, list)->length),
                      DYN_DICT_GET_I_REF(dict, i));
-        }
 
         return DYN_TRUE;
     }
@@ -228,26 +224,26 @@ trilean dyn_dict_remove (dyn_c* dict, dyn_const_str key)
  */
 void dyn_dict_empty (dyn_c* dict)
 {
-    dyn_dict* ptr = dict->data.dict;
+    dyn_dict* ptr = DYN_DATA(dict, dict);
 
     dyn_ushort i = DYN_DICT_LENGTH(ptr);
-    while (i--) {
-        free(ptr->key[i]);
-        ptr->key[i] = NULL;
+    while (i--)
         dyn_free(DYN_DICT_GET_I_REF(dict, i));
-    }
-    ptr->value.data.list->length = 0;
+    DYN_DATA(&ptr->value, list)->length = 0;
+
+    dyn_shape_free(ptr->shape);
+    ptr->shape = dyn_shape_empty();
 }
 
 /**
+ * Frees the dictionary and all nested elements, see dyn_free, which does not
+ * use recursion.
+ *
  * @param dict has to be of type DICT
  */
 void dyn_dict_free (dyn_c* dict)
 {
-    dyn_dict_empty(dict);
-    dyn_free(&dict->data.dict->value);
-    free(dict->data.dict->key);
-    free(dict->data.dict);
+    dyn_free(dict);
 }
 
 /**
@@ -271,33 +267,195 @@ dyn_c* dyn_dict_get (const dyn_c* dict, dyn_const_str key)
     return NULL;
 }
 
+/**
+ * @param dict has to be of type DICT
+ * @param atom interned key, see dyn_atom
+ *
+ * @returns reference to the value stored under the given key, if exists,
+ *          otherwise NULL
+ */
+dyn_c* dyn_dict_get_atom (const dyn_c* dict, dyn_const_str atom)
+{
+    dyn_ushort pos = dyn_dict_has_atom(dict, atom);
+
+    if (pos)
+        return DYN_DICT_GET_I_REF(dict, --pos);
+
+    return NULL;
+}
+
+/**
+ * Lookup with an inline cache, which stores the position of the key within
+ * the shape that was seen last. If the dictionary has the same shape, the
+ * value is accessed directly, without searching for the key. Every cache has
+ * to be used with one key only, it is thus usually a static variable at the
+ * call site. The cache is loaded and updated with single atomic accesses, a
+ * static cache can thus be shared by all threads that read dictionaries.
+ *
+ * @code
+ * static dyn_dict_cache cache;   // zero initialized
+ * dyn_c* name = dyn_dict_get_cached(&record, NAME, &cache);
+ * @endcode
+ *
+ * @param dict has to be of type DICT
+ * @param atom interned key, see dyn_atom
+ * @param cache inline cache of the call site
+ *
+ * @returns reference to the value stored under the given key, if exists,
+ *          otherwise NULL
+ */
+dyn_c* dyn_dict_get_cached (const dyn_c* dict, dyn_const_str atom,
+                            dyn_dict_cache* cache)
+{
+    const dyn_shape* shape = DYN_DATA(dict, dict)->shape;
+    dyn_dict_cache c;
+
+    // shape and pos are always consistent, since they are copied at once
+    c.word = __atomic_load_n(&cache->word, __ATOMIC_RELAXED);
+
+    if (c.shape != shape->id) {
+        dyn_ushort pos = dyn_shape_has_atom(shape, atom);
+        if (!pos)
+            return NULL;
+
+        c.word = 0;
+        c.shape = shape->id;
+        c.pos = pos - 1;
+        __atomic_store_n(&cache->word, c.word, __ATOMIC_RELAXED);
+    }
+
+    return DYN_DICT_GET_I_REF(dict, c.pos);
+}
+
+/**
+ * Copies the value list directly and shares the shape, such that the copy
+ * requires linear time.
+ *
+ * @param[in] dict has to be of type DICT
+ * @param[out] copy newly created dictionary
+ *
+ * @retval DYN_TRUE   if the dictionary could be copied
+ * @retval DYN_FALSE  otherwise, copy is of type NONE
+ */
 trilean dyn_dict_copy (const dyn_c* dict, dyn_c* copy)
 {
-    dyn_dict* ptr = dict->data.dict;
-    dyn_ushort length = DYN_DICT_LENGTH(ptr);
+    dyn_dict* ptr = DYN_DATA(dict, dict);
+    dyn_ushort len = DYN_DICT_LENGTH(ptr);
 
-    if (dyn_set_dict(copy, length)) {
-        dyn_ushort i;
-        for (i=0; i<length; ++i) {
-            if(!dyn_dict_insert(copy, ptr->key[i],
-                                 DYN_DICT_GET_I_REF(dict, i))) {
-                dyn_free(copy);
-                return DYN_FALSE;
+    if (!dyn_set_dict(copy, len))
+        return DYN_FALSE;
+
+    if (!dyn_list_append(&DYN_DATA(copy, dict)->value,
+                         DYN_DICT_GET_I_REF(dict, 0), len)) {
+        dyn_free(copy);
+        return DYN_FALSE;
+    }
+
+    DYN_DATA(copy, dict)->shape = dyn_shape_ref(ptr->shape);
+
+    return DYN_TRUE;
+}
+
+//! Number of hash slots for len keys, a power of two with a load below 0.5
+static dyn_uint hash_slots (const dyn_ushort len)
+{
+    dyn_uint slots = 8;
+    while (slots < 2 * (dyn_uint) len)
+        slots <<= 1;
+    return slots;
+}
+
+/**
+ * Creates a dictionary from parallel arrays of keys and values, which are
+ * both copied. The value list is allocated with exactly len elements at once
+ * and the shape is obtained by following the transitions for all keys.
+ *
+ * If duplicate keys are possible, then check has to be set. Duplicates are
+ * then resolved as by consecutive calls of dyn_dict_insert (the position of
+ * the first and the value of the last occurrence are kept), which still
+ * requires only linear time, since a temporary hash table of the keys is
+ * used. Otherwise, the keys are not compared at all.
+ *
+ * @code
+ * dyn_const_str keys[2] = {"a", "b"};
+ * dyn_c values[2];
+ * // ... set values and init dict
+ * dyn_set_dict_array(&dict, keys, values, 2, DYN_FALSE); // {a:..., b:...}
+ * @endcode
+ *
+ * @param[in, out] dyn input any, output DICT
+ * @param[in] keys array of C strings
+ * @param[in] values array of elements to copy, must not be part of dyn
+ * @param[in] len number of key-value pairs
+ * @param[in] check search for duplicate keys if DYN_TRUE
+ *
+ * @retval DYN_TRUE   if the required memory could be allocated
+ * @retval DYN_FALSE  otherwise, dyn is of type NONE
+ */
+trilean dyn_set_dict_array (dyn_c* dyn, const dyn_const_str* keys,
+                            const dyn_c* values, const dyn_ushort len,
+                            const trilean check)
+{
+    if (!dyn_set_dict(dyn, len))
+        return DYN_FALSE;
+
+    dyn_dict* ptr = DYN_DATA(dyn, dict);
+    dyn_ushort* slot = NULL;
+    dyn_uint mask = 0;
+    dyn_ushort i;
+
+    if (check == DYN_TRUE && len > 1) {
+        mask = hash_slots(len) - 1;
+        slot = (dyn_ushort*) calloc(mask + 1, sizeof(dyn_ushort));
+        if (!slot)
+            goto GOTO__ERROR;
+    } else if (!dyn_list_append(&ptr->value, values, len)) {
+        goto GOTO__ERROR;
+    }
+
+    for (i=0; i<len; ++i) {
+        if (slot) {
+            // slots store position + 1, 0 marks an empty slot
+            dyn_uint h = dyn_strhash(keys[i]) & mask;
+            while (slot[h] && dyn_strcmp(ptr->shape->key[slot[h]-1], keys[i]))
+                h = (h + 1) & mask;
+
+            if (slot[h]) {
+                if (!dyn_copy(&values[i], DYN_DICT_GET_I_REF(dyn, slot[h]-1)))
+                    goto GOTO__ERROR;
+                continue;
             }
+
+            slot[h] = ptr->shape->length + 1;
+            if (!dyn_copy(&values[i], DYN_DICT_GET_I_REF(dyn, DYN_DICT_LENGTH(ptr)++)))
+                goto GOTO__ERROR;
         }
+
+        dyn_shape* shape = dyn_shape_add(ptr->shape, keys[i]);
+        if (!shape)
+            goto GOTO__ERROR;
+        ptr->shape = shape;
     }
+
+    free(slot);
     return DYN_TRUE;
-}
 
+GOTO__ERROR:
+    free(slot);
+    // remaining values are NONE and can be freed
+    DYN_DICT_LENGTH(ptr) = len;
+    dyn_free(dyn);
+    return DYN_FALSE;
+}
 
 dyn_ushort dyn_dict_string_len (const dyn_c* dict)
 {
-    dyn_dict* ptr = dict->data.dict;
+    dyn_dict* ptr = DYN_DATA(dict, dict);
     dyn_ushort len = DYN_DICT_LENGTH(ptr);
     if (len) {
         dyn_ushort i = len;
         while (i--) {
-            len += dyn_strlen(ptr->key[i]);
+            len += dyn_strlen(DYN_DICT_GET_I_KEY(dict, i));
             len += dyn_string_len(DYN_DICT_GET_I_REF(dict, i));
             len += 2; // comma and colon
         }
@@ -313,7 +471,7 @@ void dyn_dict_string_add (const dyn_c* dict, dyn_str string)
     dyn_strcat(string, "{");
 
     if ( dyn_length(dict) ) {
-        dyn_ushort length = dict->data.dict->value.data.list->length;
+        dyn_ushort length = DYN_DATA(&DYN_DATA(dict, dict)->value, list)->length;
         dyn_ushort i;
         for (i=0; i<length; ++i) {
             dyn_strcat(string, DYN_DICT_GET_I_KEY(dict, i));
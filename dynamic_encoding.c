@@ -1,5 +1,7 @@
 #include "dynamic_encoding.h"
 
+#include <string.h>
+
 dyn_ushort dyn_encoding_length(const dyn_c *dyn)
 {
     dyn_ushort bytes = 1; // OP-CODE one byte
@@ -20,7 +22,7 @@ START:
             bytes = 5;
             break;
         case STRING:
-            bytes += dyn_strlen(dyn->data.str);
+            bytes += dyn_strlen(DYN_DATA(dyn, str));
             break;
 
         case SET:
@@ -42,14 +44,14 @@ START:
             break;
         }
         case FUNCTION: {
-            bytes += dyn_strlen(dyn->data.fct->info)+2; // string-info + 1 byte for type info
+            bytes += dyn_strlen(DYN_DATA(dyn, fct)->info)+2; // string-info + 1 byte for type info
 
             // C-function
-            bytes += (dyn->data.fct->type < 2) ? sizeof(void*) : dyn->data.fct->type;
+            bytes += (DYN_DATA(dyn, fct)->type < 2) ? sizeof(void*) : DYN_DATA(dyn, fct)->type;
             break;
         }
         case REFERENCE2:
-        case REFERENCE: dyn=dyn->data.ref;
+        case REFERENCE: dyn=DYN_DATA(dyn, ref);
                         goto START;
   }
 
@@ -76,32 +78,36 @@ START:
             break;
 
         case BOOL:
-            *to++ = from->data.b ? ENC_TRUE
+            *to++ = DYN_DATA(from, b) ? ENC_TRUE
                                  : ENC_FALSE;
             break;
 
         case INTEGER: {
-            if (from->data.i > -128 && from->data.i < 127) {
+            dyn_int v = DYN_DATA(from, i);
+            if (v > -128 && v < 127) {
                 *to++ = ENC_INT1;
-                *to++ = (char) from->data.i;
+                *to++ = (char) v;
             }
-            else if (from->data.i > -32768 && from->data.i < 32767) {
+            else if (v > -32768 && v < 32767) {
                 *to++ = ENC_INT2;
-                to = copy_buffer(((char *)&from->data.i), to, 3);
+                to = copy_buffer(((char *)&v), to, 3);
             }
             else {
                 *to++ = ENC_INT4;
-                to = copy_buffer(((char *)&from->data.i), to, 5);
+                to = copy_buffer(((char *)&v), to, 5);
             }
             break;
         }
 
-        case FLOAT:   *to++ = ENC_FLOAT;
-                      to = copy_buffer((char *)&from->data.f, to, 5);
-                      break;
+        case FLOAT: {
+            dyn_float v = DYN_DATA(from, f);
+            *to++ = ENC_FLOAT;
+            to = copy_buffer((char *)&v, to, 5);
+            break;
+        }
 
         case STRING:  *to++ = ENC_STRING;
-                      to = copy_buffer(from->data.str, to, dyn_string_len(from)+1);
+                      to = copy_buffer(DYN_DATA(from, str), to, dyn_string_len(from)+1);
                       break;
 
         case SET:
@@ -129,11 +135,11 @@ START:
   //                                3);
 //                to = dyn_encode(to, );
 //            }
-            //to = copy_buffer(from->data.str, to, dyn_string_len(from)+1);
+            //to = copy_buffer(DYN_DATA(from, str), to, dyn_string_len(from)+1);
 
         }
         case REFERENCE2:
-        case REFERENCE: from=from->data.ref;
+        case REFERENCE: from=DYN_DATA(from, ref);
                         goto START;
     }
 
@@ -178,24 +184,32 @@ dyn_char* dyn_decode(dyn_char code, dyn_char *from, dyn_c *to)
             break;
         case ENC_INT1:
         case ENC_INT2:
-        case ENC_INT4:
-            dyn_set_int(&tmp, code == ENC_INT1
-                              ? *((dyn_char*) from)
-                              : ( code == ENC_INT2
-                                  ? *((dyn_short*) from )
-                                  : *((dyn_int*) from)));
-
-            from += (code == ENC_INT1)
-                    ? 1
-                    : ( code == ENC_INT2
-                        ? 2
-                        : 4 );
+        case ENC_INT4: {
+            // encoded values are not aligned
+            dyn_short s;
+            dyn_int i;
+            if (code == ENC_INT1) {
+                dyn_set_int(&tmp, *((dyn_char*) from));
+                from += 1;
+            } else if (code == ENC_INT2) {
+                memcpy(&s, from, 2);
+                dyn_set_int(&tmp, s);
+                from += 2;
+            } else {
+                memcpy(&i, from, 4);
+                dyn_set_int(&tmp, i);
+                from += 4;
+            }
             break;
+        }
 
-        case ENC_FLOAT:
-            dyn_set_float(&tmp, *((dyn_float*) from));
+        case ENC_FLOAT: {
+            dyn_float f;
+            memcpy(&f, from, 4);
+            dyn_set_float(&tmp, f);
             from += 4;
             break;
+        }
 
         case ENC_STRING:
             dyn_set_string(&tmp, from);
@@ -204,15 +218,13 @@ dyn_char* dyn_decode(dyn_char code, dyn_char *from, dyn_c *to)
 
         case ENC_SET:
         case ENC_LIST: {
-            dyn_ushort len = *((dyn_ushort*) from);
+            dyn_ushort len;
+            memcpy(&len, from, 2);
             from += 2;
             dyn_ushort i = len + 1;
 
             if (code == ENC_LIST) {
-                dyn_set_list_len(&tmp, len);
-                while (--i)
-                    dyn_move( DYN_LIST_GET_REF_END(to, i),
-                              dyn_list_push_none(&tmp));
+                dyn_set_list_array_move(&tmp, DYN_LIST_GET_REF_END(to, len), len);
             } else { // SET
                 dyn_set_set_len(&tmp, len);
                 while (--i)
@@ -29,5 +29,7 @@ dyn_char*  dyn_decode     (dyn_char code, dyn_char *from, dyn_c *to);
 
 dyn_char*  dyn_decode_all (dyn_char *from, dyn_c *to);
 
+dyn_step*  dyn_step_encode (const dyn_c *dyn, dyn_char **code, dyn_uint *length);
+
 
 #endif
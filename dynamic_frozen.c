@@ -0,0 +1,153 @@
+/**
+ *  @file dynamic_frozen.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of deeply immutable elements, which can be shared
+ *         between threads without locks.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+
+
+//! Elements of a LIST, SET, or DICT, the list that stores the values of a DICT
+static dyn_list* elements (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == DICT ? DYN_DATA(&DYN_DATA(dyn, dict)->value, list)
+                                 : DYN_DATA(dyn, list);
+}
+
+/**
+ * Releases all unused memory of a list, the front gap is closed and the space
+ * is reduced to the length, since a frozen list cannot grow anymore.
+ */
+static void shrink (dyn_list* list)
+{
+    dyn_c* base = list->container - list->front;
+
+    if (!list->length)
+        return;
+
+    if (list->front)
+        memmove(base, list->container, list->length * sizeof(dyn_c));
+
+    list->container = base;
+    list->front = 0;
+
+    // inline containers are kept, see dyn_block_resize
+    dyn_c* container = dyn_block_resize(list, list->length);
+
+    list->container = container ? container : base;
+    list->space = list->length;
+}
+
+/**
+ * Freezes an element with all nested elements, the element is moved into a
+ * newly allocated frozen block and is of type NONE afterwards. All containers
+ * are shrunk to their length. A frozen element must not be changed anymore,
+ * such that any number of threads can read it concurrently without locks,
+ * references are shared with dyn_frozen_ref and released with
+ * dyn_frozen_free, both are atomic.
+ *
+ * The following functions only read and are thus safe on frozen elements:
+ * all accessor macros, dyn_get_*, dyn_length, dyn_list_get_ref,
+ * dyn_dict_get_atom, dyn_dict_get_cached, dyn_op_cmp, dyn_op_eq, and the
+ * iterators. Functions that use the global symbol table or shape counters
+ * (dyn_dict_get, dyn_copy of dictionaries) are safe as well, except for
+ * TARGET_ARDUNINO, where these are not locked.
+ *
+ * Elements that contain REFERENCEs cannot be frozen, since references point
+ * to elements that are not frozen.
+ *
+ * @code
+ * dyn_frozen* config = dyn_freeze(&tree);
+ * // pass dyn_frozen_ref(config) to every worker, which reads
+ * dyn_c* port = dyn_dict_get_atom(DYN_FROZEN_GET(config), PORT);
+ * // and finally releases its reference
+ * dyn_frozen_free(config);
+ * @endcode
+ *
+ * @param[in, out] dyn element to freeze, NONE afterwards
+ *
+ * @returns the frozen block with one reference or NULL, if dyn contains a
+ *          REFERENCE or no memory could be allocated, dyn remains unchanged
+ */
+dyn_frozen* dyn_freeze (dyn_c* dyn)
+{
+    if (DYN_IS_REFERENCE(dyn))
+        return NULL;
+
+    dyn_tree_iter it;
+    dyn_c* elem;
+
+    if (dyn_tree_init(&it, dyn)) {
+        while ((elem = dyn_tree_next(&it)))
+            if (DYN_IS_REFERENCE(elem))
+                break;
+        dyn_tree_free(&it);
+        if (elem)
+            return NULL;
+    }
+
+    dyn_frozen* frozen = (dyn_frozen*) malloc(sizeof(dyn_frozen));
+    if (!frozen)
+        return NULL;
+
+    frozen->refs = 1;
+    dyn_move(dyn, &frozen->value);
+
+    if (dyn_tree_init(&it, &frozen->value)) {
+        shrink(elements(&frozen->value));
+        while ((elem = dyn_tree_next(&it)))
+            if (it.pushed)
+                shrink(elements(elem));
+        dyn_tree_free(&it);
+    }
+
+    return frozen;
+}
+
+/**
+ * Increases the reference counter atomically.
+ *
+ * @param[in, out] frozen
+ *
+ * @returns frozen
+ */
+dyn_frozen* dyn_frozen_ref (dyn_frozen* frozen)
+{
+    __atomic_add_fetch(&frozen->refs, 1, __ATOMIC_RELAXED);
+    return frozen;
+}
+
+/**
+ * Decreases the reference counter atomically, the last reference frees the
+ * frozen element.
+ *
+ * @param[in, out] frozen
+ */
+void dyn_frozen_free (dyn_frozen* frozen)
+{
+    if (__atomic_sub_fetch(&frozen->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        dyn_free(&frozen->value);
+        free(frozen);
+    }
+}
+
+/**
+ * @param[in] frozen
+ *
+ * @returns a read-only reference to the frozen element
+ */
+const dyn_c* dyn_frozen_get (const dyn_frozen* frozen)
+{
+    return &frozen->value;
+}
@@ -18,30 +18,30 @@ trilean dyn_set_fct(dyn_c* dyn, void *ptr, const dyn_ushort type, dyn_const_str
 {
     dyn_free(dyn);
 
-    dyn->type = FUNCTION;
+    dyn_fct* fct = (dyn_fct*) dyn_mem_alloc(sizeof(dyn_fct));
 
-    //dyn->data.fct = NULL;
-    dyn->data.fct = (dyn_fct*) malloc(sizeof(dyn_fct));
+    if (fct) {
+        DYN_SET_TYPE(dyn, FUNCTION);
+        DYN_SET_DATA(dyn, fct, fct);
 
-    if (dyn->data.fct) {
-        dyn->data.fct->type = type;
-        dyn->data.fct->info = NULL;
+        fct->type = type;
+        fct->info = NULL;
         if (info!=NULL) {
             if (dyn_strlen(info)) {
-                dyn->data.fct->info = (dyn_str) malloc( dyn_strlen(info)+1 );
-                if (dyn->data.fct->info) {
-                    dyn_strcpy( dyn->data.fct->info, info );
+                fct->info = (dyn_str) dyn_mem_alloc( dyn_strlen(info)+1 );
+                if (fct->info) {
+                    dyn_strcpy( fct->info, info );
                 }
             }
         }
 
         if (type < DYN_FCT_PROC) {
-            dyn->data.fct->ptr = ptr;
+            fct->ptr = ptr;
             return DYN_TRUE;
         }
         else
         {
-            dyn_char* proc = (dyn_char*) malloc(type);
+            dyn_char* proc = (dyn_char*) dyn_mem_alloc(type);
 
             if (proc) {
                 dyn_char* code = ptr;
@@ -49,33 +49,35 @@ trilean dyn_set_fct(dyn_c* dyn, void *ptr, const dyn_ushort type, dyn_const_str
                 for (i=0; i<type; ++i){
                     proc[i] = code[i];
                 }
-                dyn->data.fct->ptr = (void*)proc;
+                fct->ptr = (void*)proc;
                 return DYN_TRUE;
             }
         }
+        dyn_mem_free(fct->info);
+        DYN_INIT(dyn);
     }
 
-    free(dyn->data.fct);
+    dyn_mem_free(fct);
 
     return DYN_FALSE;
 }
 
 void dyn_fct_free(dyn_c* dyn)
 {
-    if (dyn->data.fct->type > DYN_FCT_PROC) {
-        free(dyn->data.fct->ptr);
+    if (DYN_DATA(dyn, fct)->type > DYN_FCT_PROC) {
+        dyn_mem_free(DYN_DATA(dyn, fct)->ptr);
     }
 
-    if (dyn->data.fct->info != NULL)
-        free(dyn->data.fct->info);
+    if (DYN_DATA(dyn, fct)->info != NULL)
+        dyn_mem_free(DYN_DATA(dyn, fct)->info);
 
-    free(dyn->data.fct);
+    dyn_mem_free(DYN_DATA(dyn, fct));
 }
 
 trilean dyn_fct_copy(const dyn_c* dyn, dyn_c* copy)
 {
     return dyn_set_fct( copy,
-                        dyn->data.fct->ptr,
-                        dyn->data.fct->type,
-                        dyn->data.fct->info);
+                        DYN_DATA(dyn, fct)->ptr,
+                        DYN_DATA(dyn, fct)->type,
+                        DYN_DATA(dyn, fct)->info);
 }
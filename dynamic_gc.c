@@ -0,0 +1,695 @@
+/**
+ *  @file dynamic_gc.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of an optional tracing garbage collector for
+ *         elements, which are shared via references instead of copies.
+ *
+ * Elements are moved into cells of a collector, which are bump-allocated
+ * from arenas. Cells are referenced by REFERENCE elements from anywhere
+ * within other cells, cells that are not reachable from pinned cells are
+ * freed. Marking is incremental (tri-color with two whites), and cells that
+ * survived a collection become old. Minor collections trace young cells only,
+ * starting at the pinned cells and the remembered old cells, which were
+ * changed since the last collection, and sweep only the list of young cells.
+ * Old cells have their own two mark colors, which are flipped by major
+ * collections only, such that minor collections never touch untraced old
+ * cells. The write barrier dyn_gc_barrier has to be called after every change
+ * of a cell.
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+#include <stdint.h>
+
+//! Number of cells per arena
+#define GC_ARENA    256
+//! A major collection is started, if the old cells grew by this factor
+#define GC_MAJOR    2
+//! Frames of the scan stack, which are used without allocation
+#define GC_FRAMES   16
+
+//! Colors of young cells (white, gray, black) and marks of old cells
+enum {
+    GC_WHITE0,
+    GC_WHITE1,
+    GC_GRAY,
+    GC_BLACK,
+    GC_OLD0,
+    GC_OLD1,
+    GC_FREE
+};
+
+enum {
+    GC_IDLE,
+    GC_MARK,
+    GC_SWEEP
+};
+
+typedef struct gc_cell {
+    dyn_c           value;      //!< must be first, references point here
+    struct gc_cell* next;       //!< next free cell
+    dyn_ushort      pins;
+    dyn_char        color;
+    dyn_char        old;
+    dyn_char        remembered;
+} gc_cell;
+
+typedef struct {
+    gc_cell cell[GC_ARENA];
+} gc_arena;
+
+//! Growable array of cells
+typedef struct {
+    gc_cell**  item;
+    dyn_uint   length;
+    dyn_uint   space;
+} gc_vector;
+
+//! Frame of the explicit stack, which is used to scan the value of a cell
+typedef struct {
+    const dyn_c* src;
+    dyn_ushort   i;
+    dyn_ushort   n;
+} gc_frame;
+
+struct dynamic_gc {
+    gc_arena**  arena;          //!< in order of allocation
+    gc_arena**  sorted;         //!< by address, to find the cell of a pointer
+    dyn_uint    arenas;
+    dyn_uint    bump;           //!< next unused cell of the last arena
+    gc_cell*    free;
+
+    gc_vector   gray;
+    gc_vector   remembered;
+    gc_vector   pinned;
+    gc_vector   young;          //!< in order of allocation
+    trilean     overflow;       //!< gray cells were not stored in gray
+
+    dyn_char    phase;
+    dyn_char    white;          //!< current white, the other one is dead
+    dyn_char    mark;           //!< current mark of old cells, flipped by majors
+    trilean     minor;
+    trilean     major;          //!< next collection has to be a major one
+    dyn_uint    sweep_arena;
+    dyn_uint    sweep_cell;
+    dyn_uint    sweep_end;
+    dyn_uint    young_end;      //!< young cells allocated before the sweep
+
+    dyn_uint    cells;
+    dyn_uint    old;
+    dyn_uint    threshold;      //!< number of old cells for the next major
+};
+
+
+static trilean vector_push (gc_vector* v, gc_cell* cell)
+{
+    if (v->length == v->space) {
+        dyn_uint space = v->space ? 2 * v->space : 16;
+        gc_cell** tmp = (gc_cell**) realloc(v->item, space * sizeof(gc_cell*));
+        if (!tmp)
+            return DYN_FALSE;
+        v->item = tmp;
+        v->space = space;
+    }
+    v->item[v->length++] = cell;
+    return DYN_TRUE;
+}
+
+static void vector_free (gc_vector* v)
+{
+    free(v->item);
+    v->item = NULL;
+    v->length = v->space = 0;
+}
+
+/**
+ * Returns the cell whose value is stored at ptr, or NULL if ptr does not
+ * point to a used cell of this collector.
+ */
+static gc_cell* lookup (const dyn_gc* gc, const void* ptr)
+{
+    uintptr_t p = (uintptr_t) ptr;
+    dyn_uint lo = 0, hi = gc->arenas;
+
+    while (lo < hi) {
+        dyn_uint mid = (lo + hi) / 2;
+        if ((uintptr_t) gc->sorted[mid] <= p)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (!lo)
+        return NULL;
+
+    gc_arena* arena = gc->sorted[lo-1];
+    uintptr_t offset = p - (uintptr_t) arena->cell;
+    if (offset >= sizeof(gc_arena) || offset % sizeof(gc_cell))
+        return NULL;
+
+    dyn_uint i = offset / sizeof(gc_cell);
+    if (arena == gc->arena[gc->arenas-1] && i >= gc->bump)
+        return NULL;
+
+    gc_cell* cell = &arena->cell[i];
+    return cell->color == GC_FREE ? NULL : cell;
+}
+
+static gc_cell* cell_of (const dyn_gc* gc, const dyn_c* dyn)
+{
+    if (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+    return lookup(gc, dyn);
+}
+
+//! Cells that are not yet marked, old cells count as marked in minor cycles
+static trilean unmarked (const dyn_gc* gc, const gc_cell* cell)
+{
+    if (cell->old)
+        return !gc->minor && cell->color == (gc->mark ^ 1);
+    return cell->color == gc->white;
+}
+
+//! Cells that were already scanned within the current cycle
+static trilean marked (const dyn_gc* gc, const gc_cell* cell)
+{
+    return cell->color == GC_BLACK || cell->color == gc->mark;
+}
+
+static void gray (dyn_gc* gc, gc_cell* cell)
+{
+    cell->color = GC_GRAY;
+    if (!vector_push(&gc->gray, cell))
+        gc->overflow = DYN_TRUE;
+}
+
+static void mark_ref (dyn_gc* gc, const dyn_c* ref)
+{
+    gc_cell* cell = lookup(gc, DYN_DATA(ref, ref));
+    if (cell && unmarked(gc, cell))
+        gray(gc, cell);
+}
+
+static const dyn_list* elements (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == DICT ? DYN_DATA(&DYN_DATA(dyn, dict)->value, list)
+                                 : DYN_DATA(dyn, list);
+}
+
+static trilean is_container (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+#ifdef S2_SET
+        case SET:
+#endif
+        case LIST:
+        case DICT:  return DYN_TRUE;
+    }
+    return DYN_FALSE;
+}
+
+/**
+ * Grays all cells, which are referenced within dyn, nested containers are
+ * traversed with an explicit stack, that requires memory only for structures
+ * nested deeper than GC_FRAMES.
+ *
+ * @returns the number of traversed elements
+ */
+static dyn_uint scan (dyn_gc* gc, const dyn_c* dyn)
+{
+    gc_frame local[GC_FRAMES];
+    gc_frame* frame = local;
+    gc_frame* f;
+    dyn_uint count = 1, depth = 0, space = GC_FRAMES;
+
+    if (DYN_IS_REFERENCE(dyn))
+        mark_ref(gc, dyn);
+
+    if (!is_container(dyn))
+        return count;
+
+    f = &frame[depth++];
+    f->src = elements(dyn)->container;
+    f->i = 0;
+    f->n = elements(dyn)->length;
+
+    while (depth) {
+        f = &frame[depth-1];
+        if (f->i == f->n) {
+            --depth;
+            continue;
+        }
+
+        dyn = &f->src[f->i++];
+        ++count;
+
+        if (DYN_IS_REFERENCE(dyn)) {
+            mark_ref(gc, dyn);
+            continue;
+        }
+
+        if (!is_container(dyn))
+            continue;
+
+        if (depth == space) {
+            gc_frame* tmp = (gc_frame*) malloc(2 * space * sizeof(gc_frame));
+            if (!tmp) {
+                count += scan(gc, dyn) - 1;
+                continue;
+            }
+            memcpy(tmp, frame, depth * sizeof(gc_frame));
+            if (frame != local)
+                free(frame);
+            frame = tmp;
+            space *= 2;
+        }
+
+        f = &frame[depth++];
+        f->src = elements(dyn)->container;
+        f->i = 0;
+        f->n = elements(dyn)->length;
+    }
+
+    if (frame != local)
+        free(frame);
+
+    return count;
+}
+
+//! Calls fct for every used cell of all arenas
+static void for_cells (dyn_gc* gc, void (*fct)(dyn_gc*, gc_cell*))
+{
+    dyn_uint a, i;
+
+    for (a=0; a<gc->arenas; ++a) {
+        dyn_uint n = a == gc->arenas-1 ? gc->bump : GC_ARENA;
+        for (i=0; i<n; ++i)
+            if (gc->arena[a]->cell[i].color != GC_FREE)
+                fct(gc, &gc->arena[a]->cell[i]);
+    }
+}
+
+static void regray (dyn_gc* gc, gc_cell* cell)
+{
+    if (cell->color == GC_GRAY && !vector_push(&gc->gray, cell))
+        gc->overflow = DYN_TRUE;
+}
+
+static void start (dyn_gc* gc)
+{
+    dyn_uint i;
+
+    gc->minor = !gc->major && gc->old < gc->threshold;
+    gc->major = DYN_FALSE;
+
+    // all old cells become unmarked, without touching them
+    if (!gc->minor)
+        gc->mark ^= 1;
+
+    // old cells, which were changed since the last cycle, are scanned again
+    for (i=0; i<gc->remembered.length; ++i) {
+        gc_cell* cell = gc->remembered.item[i];
+        if (!cell->remembered)
+            continue;
+        cell->remembered = DYN_FALSE;
+        if (gc->minor && cell->old && cell->color == gc->mark)
+            gray(gc, cell);
+    }
+    gc->remembered.length = 0;
+
+    for (i=0; i<gc->pinned.length; ++i)
+        if (unmarked(gc, gc->pinned.item[i]))
+            gray(gc, gc->pinned.item[i]);
+
+    gc->phase = GC_MARK;
+}
+
+static dyn_uint mark (dyn_gc* gc, dyn_uint budget)
+{
+    while (budget) {
+        if (!gc->gray.length) {
+            if (gc->overflow) {
+                gc->overflow = DYN_FALSE;
+                for_cells(gc, regray);
+                continue;
+            }
+            // all reachable cells are marked, the current white becomes dead
+            gc->white ^= 1;
+            gc->phase = GC_SWEEP;
+            gc->sweep_arena = 0;
+            gc->sweep_cell = 0;
+            gc->sweep_end = gc->arenas;
+            gc->young_end = gc->young.length;
+            break;
+        }
+
+        gc_cell* cell = gc->gray.item[--gc->gray.length];
+        if (cell->color != GC_GRAY)
+            continue;
+
+        cell->color = cell->old ? gc->mark : GC_BLACK;
+        dyn_uint cost = scan(gc, &cell->value);
+        budget = cost < budget ? budget - cost : 0;
+    }
+
+    return budget;
+}
+
+static void release (dyn_gc* gc, gc_cell* cell)
+{
+    dyn_free(&cell->value);
+    if (cell->old)
+        gc->old--;
+    gc->cells--;
+
+    cell->color = GC_FREE;
+    cell->old = DYN_FALSE;
+    cell->remembered = DYN_FALSE;
+    cell->next = gc->free;
+    gc->free = cell;
+}
+
+//! Frees a dead cell or promotes a marked young cell
+static void sweep_one (dyn_gc* gc, gc_cell* cell)
+{
+    if (cell->old) {
+        if (cell->color == (gc->mark ^ 1))
+            release(gc, cell);
+    } else if (cell->color == (gc->white ^ 1)) {
+        release(gc, cell);
+    } else if (cell->color == GC_BLACK) {
+        cell->color = gc->mark;
+        cell->old = DYN_TRUE;
+        gc->old++;
+    }
+}
+
+/**
+ * Minor collections sweep only the young cells that were allocated before the
+ * sweep started, major collections all cells of all arenas. Young cells that
+ * are allocated while sweeping remain in the list for the next collection.
+ */
+static dyn_uint sweep (dyn_gc* gc, dyn_uint budget)
+{
+    if (gc->minor) {
+        while (budget && gc->sweep_cell < gc->young_end) {
+            sweep_one(gc, gc->young.item[gc->sweep_cell++]);
+            --budget;
+        }
+        if (gc->sweep_cell < gc->young_end)
+            return budget;
+    } else {
+        while (budget && gc->sweep_arena < gc->sweep_end) {
+            dyn_uint n = gc->sweep_arena == gc->arenas-1 ? gc->bump : GC_ARENA;
+            if (gc->sweep_cell >= n) {
+                ++gc->sweep_arena;
+                gc->sweep_cell = 0;
+                continue;
+            }
+
+            gc_cell* cell = &gc->arena[gc->sweep_arena]->cell[gc->sweep_cell++];
+            --budget;
+
+            if (cell->color != GC_FREE)
+                sweep_one(gc, cell);
+        }
+        if (gc->sweep_arena < gc->sweep_end)
+            return budget;
+
+        gc->threshold = gc->old * GC_MAJOR > GC_ARENA ? gc->old * GC_MAJOR
+                                                      : GC_ARENA;
+    }
+
+    // all young cells of this cycle were freed or promoted
+    gc->young.length -= gc->young_end;
+    memmove(gc->young.item, gc->young.item + gc->young_end,
+            gc->young.length * sizeof(gc_cell*));
+    gc->phase = GC_IDLE;
+
+    return budget;
+}
+
+/**
+ * Creates an empty collector, which is not thread-safe, every collector has
+ * to be used by a single thread only.
+ *
+ * @returns the new collector or NULL, if no memory could be allocated
+ */
+dyn_gc* dyn_gc_new (void)
+{
+    dyn_gc* gc = (dyn_gc*) calloc(1, sizeof(dyn_gc));
+    if (!gc)
+        return NULL;
+
+    gc->bump = GC_ARENA;
+    gc->white = GC_WHITE0;
+    gc->mark = GC_OLD0;
+    gc->phase = GC_IDLE;
+    gc->threshold = GC_ARENA;
+
+    return gc;
+}
+
+static void release_all (dyn_gc* gc, gc_cell* cell)
+{
+    dyn_free(&cell->value);
+}
+
+/**
+ * Frees the collector together with all cells, references to cells are
+ * dangling afterwards.
+ *
+ * @param[in, out] gc
+ */
+void dyn_gc_free (dyn_gc* gc)
+{
+    dyn_uint a;
+
+    for_cells(gc, release_all);
+    for (a=0; a<gc->arenas; ++a)
+        free(gc->arena[a]);
+
+    free(gc->arena);
+    free(gc->sorted);
+    vector_free(&gc->gray);
+    vector_free(&gc->remembered);
+    vector_free(&gc->pinned);
+    vector_free(&gc->young);
+    free(gc);
+}
+
+static trilean arena_new (dyn_gc* gc)
+{
+    gc_arena* arena = (gc_arena*) malloc(sizeof(gc_arena));
+    gc_arena** tmp;
+    dyn_uint i;
+
+    if (!arena)
+        return DYN_FALSE;
+
+    tmp = (gc_arena**) realloc(gc->arena, (gc->arenas + 1) * sizeof(gc_arena*));
+    if (tmp)
+        gc->arena = tmp;
+    tmp = tmp ? (gc_arena**) realloc(gc->sorted, (gc->arenas + 1) * sizeof(gc_arena*))
+              : NULL;
+    if (!tmp) {
+        free(arena);
+        return DYN_FALSE;
+    }
+    gc->sorted = tmp;
+
+    for (i=gc->arenas; i && (uintptr_t) gc->sorted[i-1] > (uintptr_t) arena; --i)
+        gc->sorted[i] = gc->sorted[i-1];
+    gc->sorted[i] = arena;
+
+    gc->arena[gc->arenas++] = arena;
+    gc->bump = 0;
+
+    return DYN_TRUE;
+}
+
+/**
+ * Moves an element into a new cell of the collector, the cell is young and
+ * has to be pinned or referenced from another cell, before the next step of
+ * the collector, otherwise it is freed.
+ *
+ * @code
+ * dyn_c* cell = dyn_gc_alloc(gc, &list);
+ * dyn_set_ref(dyn_list_push_none(root), cell);
+ * dyn_gc_barrier(gc, root);
+ * @endcode
+ *
+ * @param[in, out] gc
+ * @param[in, out] value element to move, NONE afterwards
+ *
+ * @returns the value of the new cell or NULL, if no memory could be allocated
+ */
+dyn_c* dyn_gc_alloc (dyn_gc* gc, dyn_c* value)
+{
+    gc_cell* cell;
+
+    if (gc->bump == GC_ARENA && !gc->free && !arena_new(gc))
+        return NULL;
+
+    cell = gc->bump < GC_ARENA ? &gc->arena[gc->arenas-1]->cell[gc->bump]
+                               : gc->free;
+    if (!vector_push(&gc->young, cell))
+        return NULL;
+
+    if (gc->bump < GC_ARENA)
+        gc->bump++;
+    else
+        gc->free = cell->next;
+
+    cell->next = NULL;
+    cell->pins = 0;
+    cell->color = gc->white;
+    cell->old = DYN_FALSE;
+    cell->remembered = DYN_FALSE;
+    DYN_MOVE(value, &cell->value);
+
+    gc->cells++;
+
+    return &cell->value;
+}
+
+/**
+ * Pins a cell, pinned cells are the roots of the collector and are never
+ * freed, pins are counted.
+ *
+ * @param[in, out] gc
+ * @param[in] cell value of a cell or a REFERENCE to it
+ *
+ * @retval DYN_TRUE   if the cell was pinned
+ * @retval DYN_FALSE  if cell is not part of gc or no memory is left
+ */
+trilean dyn_gc_pin (dyn_gc* gc, dyn_c* cell)
+{
+    gc_cell* c = cell_of(gc, cell);
+    if (!c)
+        return DYN_FALSE;
+
+    if (!c->pins) {
+        if (!vector_push(&gc->pinned, c))
+            return DYN_FALSE;
+        if (gc->phase == GC_MARK && unmarked(gc, c))
+            gray(gc, c);
+    }
+    c->pins++;
+
+    return DYN_TRUE;
+}
+
+/**
+ * Removes a pin, which was set with dyn_gc_pin.
+ *
+ * @param[in, out] gc
+ * @param[in] cell value of a cell or a REFERENCE to it
+ */
+void dyn_gc_unpin (dyn_gc* gc, dyn_c* cell)
+{
+    gc_cell* c = cell_of(gc, cell);
+    dyn_uint i;
+
+    if (!c || !c->pins || --c->pins)
+        return;
+
+    for (i=0; i<gc->pinned.length; ++i)
+        if (gc->pinned.item[i] == c) {
+            gc->pinned.item[i] = gc->pinned.item[--gc->pinned.length];
+            break;
+        }
+}
+
+/**
+ * Write barrier, which has to be called after the value of a cell was
+ * changed, before the collector continues. A cell that was already marked
+ * is scanned again, an old cell is remembered for the next minor collection.
+ *
+ * @param[in, out] gc
+ * @param[in] cell value of a cell or a REFERENCE to it
+ */
+void dyn_gc_barrier (dyn_gc* gc, dyn_c* cell)
+{
+    gc_cell* c = cell_of(gc, cell);
+    if (!c)
+        return;
+
+    if (gc->phase == GC_MARK) {
+        if (marked(gc, c))
+            gray(gc, c);
+    }
+    // black cells are promoted by the running sweep
+    else if ((c->old || c->color == GC_BLACK) && !c->remembered) {
+        c->remembered = DYN_TRUE;
+        if (!vector_push(&gc->remembered, c))
+            gc->major = DYN_TRUE;
+    }
+}
+
+/**
+ * Continues the current collection or starts a new one, at most budget
+ * elements are scanned or cells are swept per call. A major collection of
+ * all cells is started, if the number of old cells has grown by GC_MAJOR
+ * since the last major collection, otherwise only young cells are collected.
+ * The value of a single cell is always scanned at once.
+ *
+ * @code
+ * while (dyn_gc_step(gc, 1000) == DYN_NONE)
+ *     handle_events();
+ * @endcode
+ *
+ * @param[in, out] gc
+ * @param[in] budget maximal number of elements or cells to process
+ *
+ * @retval DYN_TRUE   if the collection is finished
+ * @retval DYN_NONE   if there is still work left
+ */
+trilean dyn_gc_step (dyn_gc* gc, dyn_uint budget)
+{
+    if (gc->phase == GC_IDLE)
+        start(gc);
+
+    while (budget && gc->phase != GC_IDLE)
+        budget = gc->phase == GC_MARK ? mark(gc, budget)
+                                      : sweep(gc, budget);
+
+    return gc->phase == GC_IDLE ? DYN_TRUE : DYN_NONE;
+}
+
+/**
+ * Finishes the current collection and runs a complete major collection
+ * afterwards, which frees all cells that are not reachable.
+ *
+ * @param[in, out] gc
+ */
+void dyn_gc_collect (dyn_gc* gc)
+{
+    while (gc->phase != GC_IDLE)
+        dyn_gc_step(gc, 0xFFFFFFFF);
+
+    gc->major = DYN_TRUE;
+    while (dyn_gc_step(gc, 0xFFFFFFFF) != DYN_TRUE);
+}
+
+/**
+ * @param[in] gc
+ * @param[out] old number of old cells, can be NULL
+ *
+ * @returns the number of allocated cells, including unreachable ones that
+ *          were not yet freed
+ */
+dyn_uint dyn_gc_cells (const dyn_gc* gc, dyn_uint* old)
+{
+    if (old)
+        *old = gc->old;
+
+    return gc->cells;
+}
@@ -0,0 +1,263 @@
+/**
+ *  @file dynamic_iter.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of dynamiC iterators.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+
+#define DEREF(X)  (DYN_IS_REFERENCE(X) ? DYN_DATA(X, ref) : (X))
+
+
+//! Number of elements within a LIST, SET, or DICT
+static dyn_ushort count (const dyn_c* container)
+{
+    return DYN_TYPE(container) == DICT ? DYN_DICT_LEN(container)
+                                       : DYN_LIST_LEN(container);
+}
+
+//! Reference to the ith element of a LIST, SET, or DICT
+static dyn_c* element (const dyn_c* container, const dyn_ushort i)
+{
+    return DYN_TYPE(container) == DICT ? DYN_DICT_GET_I_REF(container, i)
+                                       : DYN_LIST_GET_REF(container, i);
+}
+
+static trilean is_container (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+        case LIST:
+        case SET:
+        case DICT:  return DYN_TRUE;
+    }
+    return DYN_FALSE;
+}
+
+/**
+ * Initializes an iterator over all elements of a container, references are
+ * resolved. The container must not be changed while it is iterated.
+ *
+ * @param[out] it iterator
+ * @param[in] container of type LIST, SET, DICT, or STRING
+ *
+ * @retval DYN_TRUE   if container can be iterated
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_iter_init (dyn_iter* it, const dyn_c* container)
+{
+    container = DEREF(container);
+
+    it->container = container;
+    it->pos = 0;
+    DYN_INIT(&it->scratch);
+
+    if (DYN_TYPE(container) == STRING) {
+        it->chr[0] = '\0';
+        it->chr[1] = '\0';
+        DYN_SET_TYPE(&it->scratch, STRING);
+        DYN_SET_DATA(&it->scratch, str, it->chr);
+        return DYN_TRUE;
+    }
+
+    return is_container(container);
+}
+
+/**
+ * Returns the next element of the iterated container, without copying. For
+ * type STRING, a reference to an internal STRING element is returned, which
+ * contains only the current character and which must not be freed.
+ *
+ * @param[in, out] it iterator
+ *
+ * @returns reference to the next element or NULL, if there are no elements left
+ */
+dyn_c* dyn_iter_next (dyn_iter* it)
+{
+    const dyn_c* container = it->container;
+
+    switch (DYN_TYPE(container)) {
+        case STRING: {
+            it->chr[0] = DYN_DATA(container, str)[it->pos];
+            if (!it->chr[0])
+                return NULL;
+            ++it->pos;
+            return &it->scratch;
+        }
+        case LIST:
+        case SET:
+        case DICT: {
+            if (it->pos >= count(container))
+                return NULL;
+            return element(container, it->pos++);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @param[in] it iterator
+ *
+ * @returns the key of the element returned last, if a DICT is iterated,
+ *          otherwise NULL
+ */
+dyn_const_str dyn_iter_key (const dyn_iter* it)
+{
+    if (DYN_TYPE(it->container) == DICT && it->pos)
+        return DYN_DICT_GET_I_KEY(it->container, it->pos - 1);
+    return NULL;
+}
+
+/**
+ * Initializes a depth-first iterator, which returns all elements nested
+ * within root in pre-order, a container is returned before its elements.
+ * References are not followed, such that cyclic structures cannot occur. The
+ * structure must not be changed during the iteration.
+ *
+ * @code
+ * // pseudo code
+ * root  = [1, [2, {"a": 3}], 4]
+ * order = 1, [2, {"a": 3}], 2, {"a": 3}, 3, 4
+ * @endcode
+ *
+ * @param[out] it iterator, has to be released with dyn_tree_free
+ * @param[in] root of type LIST, SET, or DICT
+ *
+ * @retval DYN_TRUE   if root can be iterated
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_tree_init (dyn_tree_iter* it, const dyn_c* root)
+{
+    root = DEREF(root);
+
+    it->stack = it->frame;
+    it->space = DYN_TREE_STACK;
+    it->depth = 0;
+    it->pushed = DYN_FALSE;
+    it->key = NULL;
+
+    if (!is_container(root))
+        return DYN_FALSE;
+
+    it->stack[0].container = root;
+    it->stack[0].pos = 0;
+    it->depth = 1;
+
+    return DYN_TRUE;
+}
+
+/**
+ * Returns the next element in pre-order. The explicit stack of frames is only
+ * reallocated, if the structure is nested deeper than all previous ones, thus
+ * the traversal does not allocate memory in general.
+ *
+ * @param[in, out] it iterator
+ *
+ * @returns reference to the next element or NULL, if there are no elements left
+ *          or if the memory for a deeper frame could not be allocated
+ */
+dyn_c* dyn_tree_next (dyn_tree_iter* it)
+{
+    it->pushed = DYN_FALSE;
+    it->key = NULL;
+
+    while (it->depth) {
+        const dyn_c* container = it->stack[it->depth-1].container;
+        dyn_ushort pos = it->stack[it->depth-1].pos;
+
+        if (pos >= count(container)) {
+            --it->depth;
+            continue;
+        }
+
+        it->stack[it->depth-1].pos++;
+        dyn_c* elem = element(container, pos);
+
+        if (DYN_TYPE(container) == DICT)
+            it->key = DYN_DICT_GET_I_KEY(container, pos);
+
+        if (is_container(elem) && count(elem)) {
+            if (it->depth == it->space) {
+                dyn_uint space = it->space * 2;
+                void* stack = space > 0xFFFF ? NULL
+                                             : malloc(space * sizeof(it->frame[0]));
+                if (!stack) {
+                    it->depth = 0;
+                    return NULL;
+                }
+                memcpy(stack, it->stack, it->space * sizeof(it->frame[0]));
+                if (it->stack != it->frame)
+                    free(it->stack);
+                it->stack = stack;
+                it->space = space;
+            }
+            it->stack[it->depth].container = elem;
+            it->stack[it->depth].pos = 0;
+            it->depth++;
+            it->pushed = DYN_TRUE;
+        }
+
+        return elem;
+    }
+
+    return NULL;
+}
+
+/**
+ * Skips all elements of the container, which was returned last by
+ * dyn_tree_next. Has no effect if the last element was no container.
+ *
+ * @param[in, out] it iterator
+ */
+void dyn_tree_skip (dyn_tree_iter* it)
+{
+    if (it->pushed) {
+        --it->depth;
+        it->pushed = DYN_FALSE;
+    }
+}
+
+/**
+ * @param[in] it iterator
+ *
+ * @returns nesting depth of the element returned last, elements of root have
+ *          depth 1
+ */
+dyn_ushort dyn_tree_depth (const dyn_tree_iter* it)
+{
+    return it->depth - it->pushed;
+}
+
+/**
+ * @param[in] it iterator
+ *
+ * @returns the key of the element returned last, if it is stored within a
+ *          DICT, otherwise NULL
+ */
+dyn_const_str dyn_tree_key (const dyn_tree_iter* it)
+{
+    return it->key;
+}
+
+/**
+ * @param[in, out] it iterator
+ */
+void dyn_tree_free (dyn_tree_iter* it)
+{
+    if (it->stack != it->frame)
+        free(it->stack);
+
+    it->stack = it->frame;
+    it->space = DYN_TREE_STACK;
+    it->depth = 0;
+}
@@ -14,8 +14,13 @@
 
 #include "dynamic.h"
 
-#define LST_CONT(X)   X->data.list->container
-#define LST_SPACE(X)  X->data.list->space
+#include <string.h>
+
+#define LST_CONT(X)   DYN_DATA(X, list)->container
+#define LST_SPACE(X)  DYN_DATA(X, list)->space
+
+//! Begin of the allocated array, including the gap in front of container
+#define LST_BASE(P)   ((P)->container - (P)->front)
 
 
 /**
@@ -23,8 +28,8 @@
  * allocates a new array of dynamic elemens with a length defined in paramter
  * len. The len paramter us used to denote the max space available space,
  * initially the lenght of a list is marked as empty. Every application of
- * of dyn_list_push increases the internal counter of dyn->data.list->len,
- * until the max value dyn->data.list->space is reached, if so, new memory
+ * of dyn_list_push increases the internal counter of DYN_DATA(dyn, list)->len,
+ * until the max value DYN_DATA(dyn, list)->space is reached, if so, new memory
  * is allocated automatically. Every popped value by applying dyn_list_pop
  * decreases the internal counter.
  *
@@ -38,64 +43,79 @@ trilean dyn_set_list_len (dyn_c* dyn, dyn_ushort len)
 {
     dyn_free(dyn);
 
-    dyn_list *list = (dyn_list*) malloc(sizeof(dyn_list));
+    // header and small containers require only one block, see dyn_block_list
+    dyn_list *list = dyn_block_list(len);
 
     if (list) {
-
-        list->container = (dyn_c*) malloc(len * sizeof(dyn_c));
-
-        if (list->container) {
-            list->space = len;
-            list->length = 0;
-
-            // Initialize all elements in list with NONE
-            while (len--)
-                DYN_INIT(&list->container[len]);
-
-            dyn->type = LIST;
-            dyn->data.list = list;
-            return DYN_TRUE;
-        }
-        free(list);
+        DYN_SET_TYPE(dyn, LIST);
+        DYN_SET_DATA(dyn, list, list);
+        return DYN_TRUE;
     }
     return DYN_FALSE;
 }
 
 /**
+ * Frees the list and all nested elements, see dyn_free, which does not use
+ * recursion.
+ *
  * @param[in, out] list  input put has to be a list
  */
 void dyn_list_free (dyn_c* dyn)
 {
-    dyn_ushort len = DYN_LIST_LEN(dyn);
+    dyn_free(dyn);
+}
 
-    // free all elements within the allocated container element
-    dyn_c *ptr = dyn->data.list->container;
-    while (len--) {
-        dyn_free(ptr++);
-    }
+/**
+ * Moves the elements of a list back to the begin of its array, such that the
+ * gap in front of it becomes usable space at its end.
+ *
+ * @param[in, out] ptr list with a gap in front
+ */
+static void compact (dyn_list* ptr)
+{
+    dyn_c* base = LST_BASE(ptr);
+    dyn_uint i = ptr->length > ptr->front ? ptr->length : ptr->front;
+
+    memmove(base, ptr->container, ptr->length * sizeof(dyn_c));
+    for (; i<(dyn_uint) ptr->length + ptr->front; ++i)
+        DYN_INIT(&base[i]);
 
-    free(dyn->data.list->container);
-    free(dyn->data.list);
+    ptr->container = base;
+    ptr->space += ptr->front;
+    ptr->front = 0;
 }
 
 /**
  * Resize the maximal usable space, if the size decreases then the removed
- * elements have to be removed previously.
+ * elements have to be removed previously. If the list has to grow and the gap
+ * in front of it is at least as large as the list (e.g. a queue filled with
+ * dyn_list_push and emptied with dyn_list_pop_front), then the elements are
+ * moved to the begin of the array instead of allocating more memory, which is
+ * O(1) amortized. The same is done, if the gap and size would together exceed
+ * 0xFFFF elements. Otherwise the gap in front of the list is not affected.
  *
  * @param[in, out] list  input put has to be a list
- * @param[in] size new maximal available space
+ * @param[in] size new maximal available space, the resulting space can be
+ *                 larger if the gap was reused
  *
  * @retval DYN_TRUE   if the required memory could be allocated
  * @retval DYN_FALSE  otherwise
  */
 trilean dyn_list_resize (dyn_c* list, dyn_ushort size)
 {
-    dyn_list *ptr = list->data.list;
+    dyn_list *ptr = DYN_DATA(list, list);
+
+    if (ptr->front && size > ptr->space &&
+        (ptr->front >= ptr->length || (dyn_uint) ptr->front + size > 0xFFFF)) {
+        compact(ptr);
+        if (size <= ptr->space)
+            return DYN_TRUE;
+    }
 
-    dyn_c* new_list = (dyn_c*) realloc(ptr->container, size * sizeof(dyn_c));
+    dyn_c* new_list = dyn_block_resize(ptr, ptr->front + size);
 
     if (new_list) {
-        ptr->container = new_list;
+        ptr->container = new_list + ptr->front;
 
         if (ptr->space < size) {
             dyn_ushort i = ptr->length;
@@ -123,7 +143,7 @@ trilean dyn_list_resize (dyn_c* list, dyn_ushort size)
  */
 dyn_c* dyn_list_push (dyn_c* list, const dyn_c* element)
 {
-    dyn_list *ptr = list->data.list;
+    dyn_list *ptr = DYN_DATA(list, list);
 
     if (ptr->length == ptr->space)
         if (!dyn_list_resize(list, ptr->space + LIST_DEFAULT))
@@ -134,6 +154,102 @@ dyn_c* dyn_list_push (dyn_c* list, const dyn_c* element)
     return &ptr->container[ ptr->length-1 ];
 }
 
+/**
+ * Prepends one NONE element to the list by using the gap in front of
+ * container. If there is no gap left, a new array is allocated with a gap that
+ * equals the current length (at least LIST_DEFAULT), such that consecutive
+ * front operations are O(1) amortized.
+ *
+ * @param[in, out] list input has to be of type LIST
+ *
+ * @returns reference to the new first NONE element
+ */
+static dyn_c* front_none (dyn_c* list)
+{
+    dyn_list *ptr = DYN_DATA(list, list);
+
+    if (!ptr->front) {
+        dyn_uint gap = ptr->length > LIST_DEFAULT ? ptr->length : LIST_DEFAULT;
+        if (gap + ptr->space > 0xFFFF)
+            gap = 0xFFFF - ptr->space;
+        if (!gap)
+            return NULL;
+
+        dyn_c* base = (dyn_c*) dyn_mem_alloc((gap + ptr->space) * sizeof(dyn_c));
+        if (!base)
+            return NULL;
+
+        dyn_uint i;
+        for (i=0; i<gap; ++i)
+            DYN_INIT(&base[i]);
+
+        memcpy(&base[gap], ptr->container, ptr->space * sizeof(dyn_c));
+        dyn_block_release(ptr);
+
+        ptr->container = &base[gap];
+        ptr->front = gap;
+    }
+
+    --ptr->front;
+    --ptr->container;
+    ++ptr->space;
+    ++ptr->length;
+
+    return ptr->container;
+}
+
+/**
+ * Pushes (copies) an additional element to the front of a list, which is O(1)
+ * amortized, since unused space in front of the list is reused.
+ *
+ * @code
+ * // pseudo code
+ * dyn_list_push_front([1,2,3], 0) == [0,1,2,3]
+ * @endcode
+ *
+ * @param[in, out] list input has to be of type LIST
+ * @param[in]      element to be pushed
+ *
+ * @returns a reference to the first element of the list
+ */
+dyn_c* dyn_list_push_front (dyn_c* list, const dyn_c* element)
+{
+    dyn_c* first = front_none(list);
+
+    if (first)
+        dyn_copy(element, first);
+
+    return first;
+}
+
+/**
+ * Pops the first element from the list and moves its content to parameter
+ * element in O(1), the freed space is kept in front of the list and reused by
+ * dyn_list_push_front or dyn_list_insert, or by dyn_list_resize.
+ *
+ * @param[in, out] list input has to be of type LIST
+ * @param[in, out] element where the first dynamic value is moved to
+ *
+ * @retval DYN_TRUE   if worked properly
+ * @retval DYN_FALSE  if the list is empty
+ */
+trilean dyn_list_pop_front (dyn_c* list, dyn_c* element)
+{
+    dyn_list *ptr = DYN_DATA(list, list);
+
+    if (!ptr->length)
+        return DYN_FALSE;
+
+    dyn_move(ptr->container, element);
+
+    ++ptr->front;
+    ++ptr->container;
+    --ptr->space;
+    --ptr->length;
+
+    return DYN_TRUE;
+}
+
 /**
  * Increses the length value of the list by one and returns a reference to the
  * last NONE element of the list. This reference can be used to move a larger
@@ -145,7 +261,7 @@ dyn_c* dyn_list_push (dyn_c* list, const dyn_c* element)
  */
 dyn_c* dyn_list_push_none (dyn_c* list)
 {
-    dyn_list *ptr = list->data.list;
+    dyn_list *ptr = DYN_DATA(list, list);
     if (ptr->length == ptr->space)
         if (!dyn_list_resize(list, ptr->space + LIST_DEFAULT))
             return NULL;
@@ -153,10 +269,212 @@ dyn_c* dyn_list_push_none (dyn_c* list)
     return &ptr->container[ ptr->length++ ];
 }
 
+//! Elements that do not own any memory and can thus be copied bitwise,
+//! references are resolved by dyn_copy
+static trilean is_flat (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+        case STRING:
+        case LIST:
+        case SET:
+        case DICT:
+        case FUNCTION:
+        case REFERENCE:
+        case REFERENCE2:    return DYN_FALSE;
+    }
+    return DYN_TRUE;
+}
+
 /**
- * Delete an element from the list at position i, successive elements are moved
- * to close this gap. This function can be interpeted as the opposite to
- * \p dyp_list_insert
+ * Copies len elements to dest, consecutive runs of elements without own
+ * memory (NONE, BOOL, INTEGER, FLOAT, EXTERN, etc.) are copied with a
+ * single memcpy, all others with dyn_copy. If an element cannot be copied,
+ * all previous copies are freed again.
+ *
+ * @param[out] dest array of NONE elements
+ * @param[in] src array of elements to copy
+ * @param[in] len number of elements
+ *
+ * @retval DYN_TRUE   if all elements could be copied
+ * @retval DYN_FALSE  otherwise
+ */
+static trilean copy_array (dyn_c* dest, const dyn_c* src, const dyn_ushort len)
+{
+    dyn_ushort i = 0, run;
+
+    while (i < len) {
+        for (run = i; run < len && is_flat(&src[run]); ++run);
+
+        if (run > i) {
+            memcpy(&dest[i], &src[i], (run - i) * sizeof(dyn_c));
+            i = run;
+        } else if (dyn_copy(&src[i], &dest[i])) {
+            ++i;
+        } else {
+            while (i--)
+                dyn_free(&dest[i]);
+            return DYN_FALSE;
+        }
+    }
+
+    return DYN_TRUE;
+}
+
+//! Moves len elements bitwise from src to dest, src is NONE afterwards
+static void move_array (dyn_c* dest, dyn_c* src, dyn_ushort len)
+{
+    memcpy(dest, src, len * sizeof(dyn_c));
+    while (len--)
+        DYN_INIT(&src[len]);
+}
+
+/**
+ * Creates a list of exactly len elements, which are copied from an array of
+ * dynamic elements, see dyn_list_append for copying details.
+ *
+ * @code
+ * dyn_c array[3], list;
+ * // ... set array and init list
+ * dyn_set_list_array(&list, array, 3); // list == [array[0], array[1], array[2]]
+ * @endcode
+ *
+ * @param[in, out] dyn input any, output LIST
+ * @param[in] array of elements to copy, must not be part of dyn
+ * @param[in] len number of elements
+ *
+ * @retval DYN_TRUE   if the required memory could be allocated
+ * @retval DYN_FALSE  otherwise, dyn is of type NONE
+ */
+trilean dyn_set_list_array (dyn_c* dyn, const dyn_c* array, const dyn_ushort len)
+{
+    if (!dyn_set_list_len(dyn, len))
+        return DYN_FALSE;
+
+    if (!copy_array(LST_CONT(dyn), array, len)) {
+        dyn_free(dyn);
+        return DYN_FALSE;
+    }
+
+    DYN_LIST_LEN(dyn) = len;
+    return DYN_TRUE;
+}
+
+/**
+ * Creates a list of exactly len elements, which are moved from an array of
+ * dynamic elements, all elements of array are of type NONE afterwards.
+ *
+ * @param[in, out] dyn input any, output LIST
+ * @param[in, out] array of elements to move, must not be part of dyn
+ * @param[in] len number of elements
+ *
+ * @retval DYN_TRUE   if the required memory could be allocated
+ * @retval DYN_FALSE  otherwise, array remains unchanged
+ */
+trilean dyn_set_list_array_move (dyn_c* dyn, dyn_c* array, const dyn_ushort len)
+{
+    if (!dyn_set_list_len(dyn, len))
+        return DYN_FALSE;
+
+    move_array(LST_CONT(dyn), array, len);
+
+    DYN_LIST_LEN(dyn) = len;
+    return DYN_TRUE;
+}
+
+/**
+ * Ensures that at least len further elements fit into the list, the space is
+ * increased only once. If array points into the list itself, the pointer is
+ * adapted to the new memory location.
+ */
+static trilean reserve (dyn_c* list, const dyn_c** array, const dyn_ushort len)
+{
+    dyn_list *ptr = DYN_DATA(list, list);
+    dyn_uint size = (dyn_uint) ptr->length + len;
+
+    if (size <= ptr->space)
+        return DYN_TRUE;
+
+    if (size > 0xFFFF)
+        return DYN_FALSE;
+
+    trilean inside = *array >= ptr->container &&
+                     *array < ptr->container + ptr->space;
+    size_t offset = *array - ptr->container;
+
+    if (!dyn_list_resize(list, size))
+        return DYN_FALSE;
+
+    if (inside)
+        *array = ptr->container + offset;
+
+    return DYN_TRUE;
+}
+
+/**
+ * Appends copies of len elements to the end of a list, the list space is
+ * increased at most once. Consecutive elements without own memory (NONE,
+ * BOOL, INTEGER, FLOAT, EXTERN, etc.) are copied with a single memcpy. To
+ * append a range of another list, simply pass a reference to its first
+ * element, it is also valid to pass a range of the list itself.
+ *
+ * @code
+ * // pseudo code
+ * dyn_list_append([1,2], DYN_LIST_GET_REF([3,4,5,6], 1), 2) == [1,2,4,5]
+ * @endcode
+ *
+ * @param[in, out] list input has to be of type LIST
+ * @param[in] array of elements to copy
+ * @param[in] len number of elements
+ *
+ * @retval DYN_TRUE   if all elements could be appended
+ * @retval DYN_FALSE  otherwise, the list remains unchanged
+ */
+trilean dyn_list_append (dyn_c* list, const dyn_c* array, const dyn_ushort len)
+{
+    if (!reserve(list, &array, len))
+        return DYN_FALSE;
+
+    dyn_list *ptr = DYN_DATA(list, list);
+
+    if (!copy_array(&ptr->container[ptr->length], array, len))
+        return DYN_FALSE;
+
+    ptr->length += len;
+    return DYN_TRUE;
+}
+
+/**
+ * Appends len elements to the end of a list, by moving them bitwise, all
+ * elements of array are of type NONE afterwards. The elements of array must
+ * not be part of list.
+ *
+ * @param[in, out] list input has to be of type LIST
+ * @param[in, out] array of elements to move
+ * @param[in] len number of elements
+ *
+ * @retval DYN_TRUE   if all elements could be appended
+ * @retval DYN_FALSE  otherwise, list and array remain unchanged
+ */
+trilean dyn_list_append_move (dyn_c* list, dyn_c* array, const dyn_ushort len)
+{
+    const dyn_c* ref = array;
+
+    if (!reserve(list, &ref, len))
+        return DYN_FALSE;
+
+    dyn_list *ptr = DYN_DATA(list, list);
+
+    move_array(&ptr->container[ptr->length], array, len);
+
+    ptr->length += len;
+    return DYN_TRUE;
+}
+
+/**
+ * Delete an element from the list at position i, the shorter side of the list
+ * (preceding or successive elements) is moved with one memmove to close this
+ * gap, such that removing the first element is O(1). This function can be
+ * interpeted as the opposite to \p dyp_list_insert
  *
  * @code
  * // pseudo code
@@ -171,19 +489,32 @@ dyn_c* dyn_list_push_none (dyn_c* list)
  */
 trilean dyn_list_remove (dyn_c* list, dyn_ushort i)
 {
-    dyn_list *ptr = list->data.list;
+    dyn_list *ptr = DYN_DATA(list, list);
     if (ptr->length > i) {
-        for(; i<ptr->length-1; ++i) {
-            dyn_move(&ptr->container[i+1], &ptr->container[i]);
+        dyn_free(&ptr->container[i]);
+
+        if (i < ptr->length / 2) {
+            memmove(&ptr->container[1], &ptr->container[0], i * sizeof(dyn_c));
+            DYN_INIT(&ptr->container[0]);
+            ++ptr->container;
+            ++ptr->front;
+            --ptr->space;
+            --ptr->length;
+        } else {
+            memmove(&ptr->container[i], &ptr->container[i+1],
+                    (ptr->length - i - 1) * sizeof(dyn_c));
+            DYN_INIT(&ptr->container[--ptr->length]);
         }
-        dyn_list_popi(list, 1);
     }
     return DYN_TRUE;
 }
 
 /**
  * Insert a new element at position i to a list, all other elements with pos>i
- * are shifted "to the left" befor the element gets inserted (moved).
+ * are shifted "to the left" with one memmove befor the element gets inserted
+ * (moved). If i lies within the first half and there is free space in front of
+ * the list, then the preceding elements are shifted "to the right" instead.
+ * Inserting at position 0 is thus O(1) amortized, see dyn_list_push_front.
  *
  * @code
  * // pseudo code
@@ -195,24 +526,152 @@ trilean dyn_list_remove (dyn_c* list, dyn_ushort i)
  * @param[in] i position
  *
  * @retval DYN_TRUE   if the required memory could be allocated
+ * @retval DYN_FALSE  otherwise
  */
 trilean dyn_list_insert (dyn_c* list, dyn_c* element, const dyn_ushort i)
 {
     dyn_ushort n = DYN_LIST_LEN(list);
     if (n >= i) {
-        dyn_list_push_none(list);
+        if (i <= n / 2 && (i == 0 || DYN_DATA(list, list)->front)) {
+            if (!front_none(list))
+                return DYN_FALSE;
 
-        dyn_c *ptr = list->data.list->container;
+            dyn_c *ptr = DYN_DATA(list, list)->container;
+            memmove(&ptr[0], &ptr[1], i * sizeof(dyn_c));
+            DYN_INIT(&ptr[i]);
+            dyn_move(element, &ptr[i]);
+            return DYN_TRUE;
+        }
+
+        if (!dyn_list_push_none(list))
+            return DYN_FALSE;
+
+        dyn_c *ptr = DYN_DATA(list, list)->container;
 
-        ++n;
-        while(--n > i)
-            dyn_move(&ptr[n-1], &ptr[n]);
+        memmove(&ptr[i+1], &ptr[i], (n - i) * sizeof(dyn_c));
+        DYN_INIT(&ptr[i]);
 
         dyn_move(element, &ptr[i]);
     }
     return DYN_TRUE;
 }
 
+/**
+ * Replaces the range [i, i+del) of a list with all elements of param insert,
+ * similar to list[i:i+del] = insert in Python. The elements of insert are
+ * moved, not copied, such that insert is an empty list afterwards. Successive
+ * elements are relocated with one memmove, thus this function can be used to
+ * remove (insert == NULL), insert (del == 0), or replace whole ranges at once.
+ *
+ * @code
+ * // pseudo code
+ * dyn_list_splice([0,1,2,3,4], 1, 3, NULL)     == [0,4]
+ * dyn_list_splice([0,1,2,3,4], 1, 0, ["a"])    == [0,"a",1,2,3,4]
+ * dyn_list_splice([0,1,2,3,4], 1, 3, ["a"])    == [0,"a",4]
+ * @endcode
+ *
+ * @param[in, out] list input has to be of type LIST
+ * @param[in] i start position
+ * @param[in] del number of elements to be removed, cropped at the end
+ * @param[in, out] insert LIST or SET with elements to insert, or NULL
+ *
+ * @retval DYN_TRUE   if the required memory could be allocated
+ * @retval DYN_FALSE  otherwise, if i is out of range, or if the result would
+ *                    be longer than 0xFFFF elements
+ */
+trilean dyn_list_splice (dyn_c* list, const dyn_ushort i, dyn_ushort del, dyn_c* insert)
+{
+    dyn_list *ptr = DYN_DATA(list, list);
+    dyn_ushort n = ptr->length;
+    dyn_ushort k = 0;
+
+    if (i > n)
+        return DYN_FALSE;
+
+    if (insert) {
+        if (DYN_TYPE(insert) != LIST && DYN_TYPE(insert) != SET)
+            return DYN_FALSE;
+        if (DYN_DATA(insert, list) == ptr)
+            return DYN_FALSE;
+        k = DYN_LIST_LEN(insert);
+    }
+
+    if (del > n - i)
+        del = n - i;
+
+    dyn_uint len = (dyn_uint) n - del + k;
+
+    if (len > 0xFFFF)
+        return DYN_FALSE;
+
+    if (len > ptr->space)
+        if (!dyn_list_resize(list, len))
+            return DYN_FALSE;
+
+    dyn_c *c = ptr->container;
+    dyn_ushort j;
+
+    for (j=i; j<i+del; ++j)
+        dyn_free(&c[j]);
+
+    memmove(&c[i+k], &c[i+del], (n - i - del) * sizeof(dyn_c));
+
+    for (j=len; j<n; ++j)
+        DYN_INIT(&c[j]);
+
+    if (k) {
+        dyn_c *from = DYN_DATA(insert, list)->container;
+        memcpy(&c[i], from, k * sizeof(dyn_c));
+        for (j=0; j<k; ++j)
+            DYN_INIT(&from[j]);
+        DYN_LIST_LEN(insert) = 0;
+    }
+
+    ptr->length = len;
+    return DYN_TRUE;
+}
+
+/**
+ * Removes all elements from a list for which fct returns DYN_TRUE. The list is
+ * compacted within one pass, every remaining element is moved at most once.
+ * The relative order of the remaining elements is preserved.
+ *
+ * @code
+ * // pseudo code
+ * dyn_list_remove_if([0,1,2,3,4], is_odd, NULL) == [0,2,4]
+ * @endcode
+ *
+ * @param[in, out] list input has to be of type LIST
+ * @param[in] fct predicate, called with every element and param ctx
+ * @param[in] ctx additional parameter passed to fct
+ *
+ * @returns number of removed elements
+ */
+dyn_ushort dyn_list_remove_if (dyn_c* list,
+                               trilean (*fct)(const dyn_c*, const void*),
+                               const void* ctx)
+{
+    dyn_list *ptr = DYN_DATA(list, list);
+    dyn_c *c = ptr->container;
+    dyn_ushort i, j = 0;
+
+    for (i=0; i<ptr->length; ++i) {
+        if (fct(&c[i], ctx) == DYN_TRUE) {
+            dyn_free(&c[i]);
+        } else {
+            if (i != j) {
+                c[j] = c[i];
+                DYN_INIT(&c[i]);
+            }
+            ++j;
+        }
+    }
+
+    i = ptr->length - j;
+    ptr->length = j;
+    return i;
+}
+
 /**
  * Pops the last element from the list and moves its content to parameter
  * element. The length of the list decreases by one.
@@ -224,7 +683,7 @@ trilean dyn_list_insert (dyn_c* list, dyn_c* element, const dyn_ushort i)
  */
 trilean dyn_list_pop(dyn_c* list, dyn_c* element)
 {
-    dyn_list *ptr = list->data.list;
+    dyn_list *ptr = DYN_DATA(list, list);
 
     dyn_move(&ptr->container[--ptr->length], element);
 
@@ -242,7 +701,7 @@ trilean dyn_list_pop(dyn_c* list, dyn_c* element)
 trilean dyn_list_popi (dyn_c* list, dyn_short i)
 {
     while(i--)
-        dyn_free(&list->data.list->container[ --list->data.list->length ]);
+        dyn_free(&DYN_DATA(list, list)->container[ --DYN_DATA(list, list)->length ]);
 
     return DYN_TRUE;
 }
@@ -288,7 +747,7 @@ trilean dyn_list_get (const dyn_c* list, dyn_c* element, const dyn_short i)
  */
 dyn_c* dyn_list_get_ref (const dyn_c* list, const dyn_short i)
 {
-    dyn_list *ptr = list->data.list;
+    dyn_list *ptr = DYN_DATA(list, list);
     if (i >= 0 && i<= ptr->length)
         return &ptr->container[i];
     else if (i < 0 && -i <= ptr->length)
@@ -307,19 +766,7 @@ dyn_c* dyn_list_get_ref (const dyn_c* list, const dyn_short i)
  */
 trilean dyn_list_copy (const dyn_c* list, dyn_c* copy)
 {
-    dyn_ushort len = DYN_LIST_LEN(list);
-
-    if (dyn_set_list_len(copy, len)) {
-        list = list->data.list->container;
-        while (len--) {
-            if (!dyn_list_push(copy, list++)) {
-                dyn_free(copy);
-                return DYN_FALSE;
-            }
-        }
-        return DYN_TRUE;
-    }
-    return DYN_FALSE;
+    return dyn_set_list_array(copy, LST_CONT(list), DYN_LIST_LEN(list));
 }
 
 /**
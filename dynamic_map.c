@@ -0,0 +1,438 @@
+/**
+ *  @file dynamic_map.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of map, filter, and reduce over the elements of
+ *         LIST, SET, and DICT, sequentially or in parallel chunks.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+
+//! Number of chunks per thread, if a pool is used
+#define MAP_CHUNKS 8
+
+typedef trilean (*map_fct)    (const dyn_c*, dyn_c*, void*);
+typedef trilean (*filter_fct) (const dyn_c*, void*);
+typedef trilean (*reduce_fct) (dyn_c*, const dyn_c*, void*);
+
+typedef struct {
+    const dyn_c* src;
+    dyn_c*       dst;
+    dyn_uint     chunk;     //!< number of elements per chunk
+    dyn_ushort*  offset;    //!< kept elements per chunk, then first position
+    dyn_char*    keep;      //!< filter result per element
+    map_fct      map;
+    filter_fct   filter;
+    reduce_fct   reduce;
+    void*        ctx;
+    trilean      failed;
+} map_ctx;
+
+
+//! Elements of a LIST, SET, or DICT, the list that stores the values of a DICT
+static dyn_list* elements (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == DICT ? DYN_DATA(&DYN_DATA(dyn, dict)->value, list)
+                                 : DYN_DATA(dyn, list);
+}
+
+static trilean is_container (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+        case LIST:
+        case SET:
+        case DICT:  return DYN_TRUE;
+    }
+    return DYN_FALSE;
+}
+
+//! Number of elements per chunk, only one chunk without a pool
+static dyn_uint chunk_size (dyn_pool* pool, const dyn_uint n)
+{
+#ifdef S2_THREADS
+    if (pool)
+        return n / (dyn_pool_threads(pool) * MAP_CHUNKS) + 1;
+#endif
+    return n ? n : 1;
+}
+
+static void run (dyn_pool* pool, const dyn_uint n, const dyn_uint chunk,
+                 void (*fct)(dyn_uint, dyn_uint, void*), void* ctx)
+{
+#ifdef S2_THREADS
+    if (pool) {
+        dyn_pool_for(pool, n, chunk, fct, ctx);
+        return;
+    }
+#endif
+    dyn_uint begin;
+    for (begin=0; begin<n; begin+=chunk)
+        fct(begin, begin + chunk < n ? begin + chunk : n, ctx);
+}
+
+static trilean failed (map_ctx* ctx)
+{
+    return __atomic_load_n(&ctx->failed, __ATOMIC_RELAXED);
+}
+
+static void fail (map_ctx* ctx)
+{
+    __atomic_store_n(&ctx->failed, DYN_TRUE, __ATOMIC_RELAXED);
+}
+
+/**
+ * Creates an empty container for len results, a DICT gets the shape of dyn,
+ * otherwise a LIST or SET is created with the type of dyn.
+ */
+static trilean result_new (const dyn_c* dyn, dyn_c* result, const dyn_ushort len,
+                           const dyn_ushort type)
+{
+    if (DYN_TYPE(dyn) == DICT) {
+        if (!dyn_set_dict(result, len))
+            return DYN_FALSE;
+        if (len == DYN_DICT_LENGTH(DYN_DATA(dyn, dict)))
+            DYN_DATA(result, dict)->shape = dyn_shape_ref(DYN_DATA(dyn, dict)->shape);
+    } else {
+        if (!dyn_set_list_len(result, len))
+            return DYN_FALSE;
+        DYN_SET_TYPE(result, type);
+    }
+    elements(result)->length = len;
+
+    return DYN_TRUE;
+}
+
+static void map_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    map_ctx* ctx = (map_ctx*) arg;
+
+    for (; begin<end && !failed(ctx); ++begin)
+        if (!ctx->map(&ctx->src[begin], &ctx->dst[begin], ctx->ctx))
+            fail(ctx);
+}
+
+/**
+ * Applies fct onto every element of a LIST, SET, or every value of a DICT,
+ * the results are stored at the same position within a new LIST or within a
+ * DICT with the same keys. The results of a SET are stored within a LIST,
+ * since they might not be unique anymore.
+ *
+ * If a pool is passed, the elements are split into chunks, which are
+ * processed in parallel, thus fct must not change shared state. The order of
+ * the results is the same in both modes.
+ *
+ * @code
+ * trilean twice (const dyn_c* elem, dyn_c* out, void* ctx)
+ * {
+ *     dyn_set_int(out, 2 * dyn_get_int(elem));
+ *     return DYN_TRUE;
+ * }
+ * ...
+ * dyn_map(NULL, &list, &result, twice, NULL);   // [1,2,3] -> [2,4,6]
+ * @endcode
+ *
+ * @param[in] pool thread pool (requires S2_THREADS) or NULL
+ * @param[in] dyn LIST, SET, or DICT
+ * @param[out] result LIST or DICT, can be dyn itself
+ * @param[in] fct called with an element, an output element of type NONE,
+ *                and ctx, returns DYN_FALSE to abort
+ * @param[in] ctx passed to fct
+ *
+ * @retval DYN_TRUE   if fct succeeded for all elements
+ * @retval DYN_FALSE  otherwise, result remains unchanged
+ */
+trilean dyn_map (dyn_pool* pool, const dyn_c* dyn, dyn_c* result,
+                 trilean (*fct)(const dyn_c*, dyn_c*, void*), void* ctx)
+{
+    if (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    if (!is_container(dyn))
+        return DYN_FALSE;
+
+    dyn_ushort len = elements(dyn)->length;
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+
+    if (!result_new(dyn, &tmp, len, LIST))
+        return DYN_FALSE;
+
+    map_ctx c;
+    memset(&c, 0, sizeof(map_ctx));
+    c.src = elements(dyn)->container;
+    c.dst = elements(&tmp)->container;
+    c.chunk = chunk_size(pool, len);
+    c.map = fct;
+    c.ctx = ctx;
+
+    run(pool, len, c.chunk, map_chunk, &c);
+
+    if (c.failed) {
+        dyn_free(&tmp);
+        return DYN_FALSE;
+    }
+
+    dyn_move(&tmp, result);
+    return DYN_TRUE;
+}
+
+static void filter_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    map_ctx* ctx = (map_ctx*) arg;
+    dyn_ushort count = 0;
+    dyn_uint i = begin;
+
+    for (; i<end; ++i) {
+        ctx->keep[i] = ctx->filter(&ctx->src[i], ctx->ctx) == DYN_TRUE;
+        count += ctx->keep[i];
+    }
+
+    ctx->offset[begin / ctx->chunk] = count;
+}
+
+static void gather_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    map_ctx* ctx = (map_ctx*) arg;
+    dyn_ushort pos = ctx->offset[begin / ctx->chunk];
+
+    for (; begin<end && !failed(ctx); ++begin)
+        if (ctx->keep[begin] && !dyn_copy(&ctx->src[begin], &ctx->dst[pos++]))
+            fail(ctx);
+}
+
+/**
+ * Copies all elements of a LIST, SET, or all key-value pairs of a DICT, for
+ * which fct returns DYN_TRUE, into a new container of the same type. The
+ * original order is preserved.
+ *
+ * If a pool is passed, fct is called in parallel chunks first, afterwards
+ * every chunk copies its selected elements directly to their final positions,
+ * such that no intermediate lists have to be merged.
+ *
+ * @param[in] pool thread pool (requires S2_THREADS) or NULL
+ * @param[in] dyn LIST, SET, or DICT
+ * @param[out] result of the same type as dyn, can be dyn itself
+ * @param[in] fct called with an element and ctx, DYN_TRUE keeps the element
+ * @param[in] ctx passed to fct
+ *
+ * @retval DYN_TRUE   if the result could be created
+ * @retval DYN_FALSE  otherwise, result remains unchanged
+ */
+trilean dyn_filter (dyn_pool* pool, const dyn_c* dyn, dyn_c* result,
+                    trilean (*fct)(const dyn_c*, void*), void* ctx)
+{
+    if (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    if (!is_container(dyn))
+        return DYN_FALSE;
+
+    dyn_ushort len = elements(dyn)->length;
+    dyn_ushort total = 0;
+    dyn_uint i, chunks;
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+
+    map_ctx c;
+    memset(&c, 0, sizeof(map_ctx));
+    c.src = elements(dyn)->container;
+    c.chunk = chunk_size(pool, len);
+    c.filter = fct;
+    c.ctx = ctx;
+
+    chunks = (len + c.chunk - 1) / c.chunk;
+    c.keep = (dyn_char*) malloc(len + 1);
+    c.offset = (dyn_ushort*) malloc((chunks + 1) * sizeof(dyn_ushort));
+    if (!c.keep || !c.offset)
+        goto GOTO__ERROR;
+
+    run(pool, len, c.chunk, filter_chunk, &c);
+
+    // turn the counts into the first position of every chunk
+    for (i=0; i<chunks; ++i) {
+        dyn_ushort count = c.offset[i];
+        c.offset[i] = total;
+        total += count;
+    }
+
+    if (!result_new(dyn, &tmp, total, DYN_TYPE(dyn)))
+        goto GOTO__ERROR;
+
+    if (DYN_TYPE(dyn) == DICT && total != len) {
+        dyn_dict* ptr = DYN_DATA(&tmp, dict);
+        for (i=0; i<len; ++i) {
+            if (c.keep[i]) {
+                dyn_shape* shape = dyn_shape_add(ptr->shape, DYN_DICT_GET_I_KEY(dyn, i));
+                if (!shape)
+                    goto GOTO__ERROR;
+                ptr->shape = shape;
+            }
+        }
+    }
+
+    c.dst = elements(&tmp)->container;
+    run(pool, len, c.chunk, gather_chunk, &c);
+
+    if (c.failed)
+        goto GOTO__ERROR;
+
+    free(c.keep);
+    free(c.offset);
+    dyn_move(&tmp, result);
+    return DYN_TRUE;
+
+GOTO__ERROR:
+    free(c.keep);
+    free(c.offset);
+    dyn_free(&tmp);
+    return DYN_FALSE;
+}
+
+static void reduce_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    map_ctx* ctx = (map_ctx*) arg;
+    dyn_c* acc = &ctx->dst[begin / ctx->chunk];
+
+    if (!dyn_copy(&ctx->src[begin], acc)) {
+        fail(ctx);
+        return;
+    }
+
+    for (++begin; begin<end && !failed(ctx); ++begin)
+        if (!ctx->reduce(acc, &ctx->src[begin], ctx->ctx))
+            fail(ctx);
+}
+
+/**
+ * Combines all elements of a LIST, SET, or all values of a DICT into acc, by
+ * calling fct(acc, element, ctx) for every element in order, acc has to be
+ * initialized with the start value.
+ *
+ * If a pool is passed, every chunk is reduced in parallel into a partial
+ * result, starting with its first element, afterwards all partial results
+ * are combined in order with acc, by calling fct(acc, partial, ctx). This
+ * requires fct to be associative and to accept partial results as elements,
+ * such as dyn_op_add for numbers. The order of the elements is preserved,
+ * thus the result is deterministic.
+ *
+ * @param[in] pool thread pool (requires S2_THREADS) or NULL
+ * @param[in] dyn LIST, SET, or DICT
+ * @param[in, out] acc start value and result
+ * @param[in] fct called with acc, an element, and ctx, returns DYN_FALSE to
+ *                abort
+ * @param[in] ctx passed to fct
+ *
+ * @retval DYN_TRUE   if fct succeeded for all elements
+ * @retval DYN_FALSE  otherwise, acc contains an intermediate result
+ */
+trilean dyn_reduce (dyn_pool* pool, const dyn_c* dyn, dyn_c* acc,
+                    trilean (*fct)(dyn_c*, const dyn_c*, void*), void* ctx)
+{
+    if (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    if (!is_container(dyn))
+        return DYN_FALSE;
+
+    const dyn_c* src = elements(dyn)->container;
+    dyn_ushort len = elements(dyn)->length;
+    dyn_uint chunk = chunk_size(pool, len);
+    dyn_uint i, chunks = (len + chunk - 1) / chunk;
+
+    if (chunks < 2) {
+        for (i=0; i<len; ++i)
+            if (!fct(acc, &src[i], ctx))
+                return DYN_FALSE;
+        return DYN_TRUE;
+    }
+
+    dyn_c partial;
+    DYN_INIT(&partial);
+    if (!dyn_set_list_len(&partial, chunks))
+        return DYN_FALSE;
+    elements(&partial)->length = chunks;
+
+    map_ctx c;
+    memset(&c, 0, sizeof(map_ctx));
+    c.src = src;
+    c.dst = elements(&partial)->container;
+    c.chunk = chunk;
+    c.reduce = fct;
+    c.ctx = ctx;
+
+    run(pool, len, chunk, reduce_chunk, &c);
+
+    for (i=0; i<chunks && !c.failed; ++i)
+        if (!fct(acc, &c.dst[i], ctx))
+            c.failed = DYN_TRUE;
+
+    dyn_free(&partial);
+
+    return c.failed ? DYN_FALSE : DYN_TRUE;
+}
+
+
+//! Returns the C function of a FUNCTION element, procedures cannot be called
+static void* callback (const dyn_c* fct)
+{
+    if (DYN_TYPE(fct) == FUNCTION && DYN_DATA(fct, fct)->type < DYN_FCT_PROC)
+        return DYN_DATA(fct, fct)->ptr;
+
+    return NULL;
+}
+
+/**
+ * Same as dyn_map, but the callback is taken from a FUNCTION element of type
+ * DYN_FCT_C or DYN_FCT_SYS, which is passed as ctx to the callback itself.
+ *
+ * @retval DYN_FALSE  also if fct is not a C function
+ */
+trilean dyn_map_fct (dyn_pool* pool, const dyn_c* dyn, dyn_c* result,
+                     const dyn_c* fct)
+{
+    void* ptr = callback(fct);
+
+    return ptr ? dyn_map(pool, dyn, result, (map_fct) ptr, (void*) fct)
+               : DYN_FALSE;
+}
+
+/**
+ * Same as dyn_filter, but the callback is taken from a FUNCTION element of
+ * type DYN_FCT_C or DYN_FCT_SYS, which is passed as ctx to the callback
+ * itself.
+ *
+ * @retval DYN_FALSE  also if fct is not a C function
+ */
+trilean dyn_filter_fct (dyn_pool* pool, const dyn_c* dyn, dyn_c* result,
+                        const dyn_c* fct)
+{
+    void* ptr = callback(fct);
+
+    return ptr ? dyn_filter(pool, dyn, result, (filter_fct) ptr, (void*) fct)
+               : DYN_FALSE;
+}
+
+/**
+ * Same as dyn_reduce, but the callback is taken from a FUNCTION element of
+ * type DYN_FCT_C or DYN_FCT_SYS, which is passed as ctx to the callback
+ * itself.
+ *
+ * @retval DYN_FALSE  also if fct is not a C function
+ */
+trilean dyn_reduce_fct (dyn_pool* pool, const dyn_c* dyn, dyn_c* acc,
+                        const dyn_c* fct)
+{
+    void* ptr = callback(fct);
+
+    return ptr ? dyn_reduce(pool, dyn, acc, (reduce_fct) ptr, (void*) fct)
+               : DYN_FALSE;
+}
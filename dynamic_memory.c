@@ -0,0 +1,305 @@
+/**
+ *  @file dynamic_memory.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of memory contexts, which account for the memory
+ *         of elements and limit it.
+ *
+ * Every block that is allocated with dyn_mem_alloc carries a header with its
+ * size and the context that was in use by the allocating thread, such that
+ * it is always returned to the same context, also if it is freed by another
+ * thread. All counters are updated in O(1) with atomic operations.
+ *
+ * Interned keys (dynamic_atom.c) and shapes (dynamic_shape.c) are shared by
+ * all dictionaries of the process and can outlive the context that created
+ * them. They are thus allocated with plain malloc and are outside the limit
+ * of every context, a tenant that inserts dictionaries with ever new keys
+ * grows this global memory without bound. Untrusted keys should be checked
+ * by the caller (e.g. against a fixed set or dyn_atom_count) before insertion.
+ *
+ */
+
+#include "dynamic.h"
+
+#ifdef S2_MEMORY
+
+// the context is thread-local also without S2_THREADS, see dynamic_block.c
+#ifndef TARGET_ARDUNINO
+#define LOCAL __thread
+#else
+#define LOCAL
+#endif
+
+struct dynamic_memory {
+    dyn_uint bytes;     //!< including the headers of all blocks
+    dyn_uint peak;
+    dyn_uint blocks;
+    dyn_uint total;     //!< number of allocations since creation
+    dyn_uint limit;     //!< 0 for unlimited
+};
+
+//! Prefix of every block, which keeps the alignment of malloc
+typedef union {
+    struct {
+        dyn_memory* memory;
+        size_t      size;
+    } h;
+    long double align;
+} mem_header;
+
+static LOCAL dyn_memory* current = NULL;
+
+
+static trilean charge (dyn_memory* mem, const dyn_uint bytes, const dyn_uint blocks)
+{
+    if (!mem)
+        return DYN_TRUE;
+
+    dyn_uint limit = __atomic_load_n(&mem->limit, __ATOMIC_RELAXED);
+    dyn_uint used = __atomic_add_fetch(&mem->bytes, bytes, __ATOMIC_RELAXED);
+
+    if (limit && used > limit) {
+        __atomic_sub_fetch(&mem->bytes, bytes, __ATOMIC_RELAXED);
+        return DYN_FALSE;
+    }
+
+    dyn_uint peak = __atomic_load_n(&mem->peak, __ATOMIC_RELAXED);
+    while (used > peak &&
+           !__atomic_compare_exchange_n(&mem->peak, &peak, used, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    if (blocks) {
+        __atomic_add_fetch(&mem->blocks, blocks, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&mem->total, blocks, __ATOMIC_RELAXED);
+    }
+
+    return DYN_TRUE;
+}
+
+static void credit (dyn_memory* mem, const dyn_uint bytes, const dyn_uint blocks)
+{
+    if (!mem)
+        return;
+
+    __atomic_sub_fetch(&mem->bytes, bytes, __ATOMIC_RELAXED);
+    if (blocks)
+        __atomic_sub_fetch(&mem->blocks, blocks, __ATOMIC_RELAXED);
+}
+
+/**
+ * Creates a new memory context, which is not in use by any thread.
+ *
+ * @param[in] limit maximal number of bytes, 0 for unlimited
+ *
+ * @returns the new context or NULL, if no memory could be allocated
+ */
+dyn_memory* dyn_memory_new (const dyn_uint limit)
+{
+    dyn_memory* mem = (dyn_memory*) calloc(1, sizeof(dyn_memory));
+
+    if (mem)
+        mem->limit = limit;
+
+    return mem;
+}
+
+/**
+ * Frees a context, all blocks that were allocated within it have to be freed
+ * previously and no thread may use it anymore.
+ *
+ * @param[in, out] mem
+ */
+void dyn_memory_free (dyn_memory* mem)
+{
+    if (current == mem)
+        current = NULL;
+    free(mem);
+}
+
+/**
+ * Sets the context of the calling thread, all following allocations of
+ * elements are accounted to it and fail, if its limit would be exceeded.
+ *
+ * @code
+ * dyn_memory* prev = dyn_memory_use(tenant);
+ * if (!dyn_copy(&request, &state))
+ *     reject();
+ * dyn_memory_use(prev);
+ * @endcode
+ *
+ * @param[in] mem new context, NULL disables the accounting
+ *
+ * @returns the previous context of the calling thread
+ */
+dyn_memory* dyn_memory_use (dyn_memory* mem)
+{
+    dyn_memory* prev = current;
+    current = mem;
+    return prev;
+}
+
+/**
+ * @returns the context of the calling thread, NULL if there is none
+ */
+dyn_memory* dyn_memory_current (void)
+{
+    return current;
+}
+
+/**
+ * Changes the limit of a context, the memory that is already in use is not
+ * affected, but further allocations fail while it exceeds the new limit.
+ *
+ * @param[in, out] mem
+ * @param[in] limit maximal number of bytes, 0 for unlimited
+ */
+void dyn_memory_limit (dyn_memory* mem, const dyn_uint limit)
+{
+    __atomic_store_n(&mem->limit, limit, __ATOMIC_RELAXED);
+}
+
+/**
+ * @param[in] mem
+ * @param[out] peak maximal number of bytes used at once, can be NULL
+ *
+ * @returns the number of bytes in use, including the headers of all blocks
+ */
+dyn_uint dyn_memory_bytes (const dyn_memory* mem, dyn_uint* peak)
+{
+    if (peak)
+        *peak = __atomic_load_n(&mem->peak, __ATOMIC_RELAXED);
+
+    return __atomic_load_n(&mem->bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @param[in] mem
+ * @param[out] total number of allocations since creation, can be NULL
+ *
+ * @returns the number of blocks in use
+ */
+dyn_uint dyn_memory_blocks (const dyn_memory* mem, dyn_uint* total)
+{
+    if (total)
+        *total = __atomic_load_n(&mem->total, __ATOMIC_RELAXED);
+
+    return __atomic_load_n(&mem->blocks, __ATOMIC_RELAXED);
+}
+
+/**
+ * Allocates a block within the context of the calling thread, as malloc.
+ *
+ * @param[in] size number of bytes
+ *
+ * @returns the new block or NULL, if no memory is left or the limit of the
+ *          context would be exceeded
+ */
+void* dyn_mem_alloc (const size_t size)
+{
+    dyn_memory* mem = current;
+    dyn_uint bytes = sizeof(mem_header) + size;
+
+    if (!charge(mem, bytes, 1))
+        return NULL;
+
+    mem_header* h = (mem_header*) malloc(bytes);
+    if (!h) {
+        credit(mem, bytes, 1);
+        return NULL;
+    }
+
+    h->h.memory = mem;
+    h->h.size = size;
+
+    return h + 1;
+}
+
+/**
+ * Changes the size of a block as realloc, the block remains within the
+ * context it was allocated in.
+ *
+ * @param[in] ptr block of dyn_mem_alloc or NULL
+ * @param[in] size new number of bytes
+ *
+ * @returns the new block or NULL, then ptr remains valid
+ */
+void* dyn_mem_realloc (void* ptr, const size_t size)
+{
+    if (!ptr)
+        return dyn_mem_alloc(size);
+
+    mem_header* h = (mem_header*) ptr - 1;
+    dyn_memory* mem = h->h.memory;
+    size_t old = h->h.size;
+
+    if (size > old && !charge(mem, size - old, 0))
+        return NULL;
+
+    mem_header* tmp = (mem_header*) realloc(h, sizeof(mem_header) + size);
+    if (!tmp) {
+        if (size > old)
+            credit(mem, size - old, 0);
+        return NULL;
+    }
+
+    if (size < old)
+        credit(mem, old - size, 0);
+    tmp->h.size = size;
+
+    return tmp + 1;
+}
+
+/**
+ * Frees a block of dyn_mem_alloc and returns its memory to its context.
+ *
+ * @param[in] ptr block or NULL
+ */
+void dyn_mem_free (void* ptr)
+{
+    if (!ptr)
+        return;
+
+    mem_header* h = (mem_header*) ptr - 1;
+    credit(h->h.memory, sizeof(mem_header) + h->h.size, 1);
+    free(h);
+}
+
+/**
+ * Moves a detached block into the context of the calling thread, this is used
+ * for blocks that are cached for reuse, see dyn_mem_detach.
+ *
+ * @param[in] ptr block of dyn_mem_alloc
+ *
+ * @retval DYN_TRUE   if the block is accounted to the context
+ * @retval DYN_FALSE  if the limit would be exceeded, ptr remains detached
+ */
+trilean dyn_mem_attach (void* ptr)
+{
+    mem_header* h = (mem_header*) ptr - 1;
+
+    if (!charge(current, sizeof(mem_header) + h->h.size, 1))
+        return DYN_FALSE;
+
+    h->h.memory = current;
+    return DYN_TRUE;
+}
+
+/**
+ * Returns the memory of a block to its context, without freeing it.
+ *
+ * @param[in] ptr block of dyn_mem_alloc
+ */
+void dyn_mem_detach (void* ptr)
+{
+    mem_header* h = (mem_header*) ptr - 1;
+
+    credit(h->h.memory, sizeof(mem_header) + h->h.size, 1);
+    h->h.memory = NULL;
+}
+
+#endif
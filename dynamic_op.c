@@ -14,17 +14,19 @@
 
 #include "dynamic.h"
 
+#include <math.h>
+
 #define max_type(A, B) (DYN_TYPE(A) > DYN_TYPE(B)) ? DYN_TYPE(A) : DYN_TYPE(B)
 
 #define CHECK_COPY_REFERENCE(X1)        \
     if (DYN_TYPE(X1) == REFERENCE2)     \
-        DYN_TYPE(X1) = REFERENCE;       \
+        DYN_SET_TYPE(X1, REFERENCE);    \
     if(DYN_TYPE(X1) == REFERENCE)       \
-        dyn_copy(X1->data.ref, X1);     \
+        dyn_copy(DYN_DATA(X1, ref), X1);     \
 
 #define CHECK_NOCOPY_REFERENCE(X2)      \
     if(DYN_IS_REFERENCE(X2))            \
-        X2=X2->data.ref;                \
+        X2=DYN_DATA(X2, ref);                \
 
 
 #define CHECK_REFERENCE(X1, X2)         \
@@ -32,12 +34,18 @@
     CHECK_NOCOPY_REFERENCE(X2)
 
 
-static dyn_ushort search (const dyn_c *container, dyn_c *element)
+static dyn_ushort search (const dyn_c *container, const dyn_c *element)
 {
     dyn_ushort i = 0;
 
+    if (DYN_IS_REFERENCE(element))
+        element = DYN_DATA(element, ref);
+
     switch (DYN_TYPE(container)) {
         case DICT: {
+            if (DYN_TYPE(element) == STRING)
+                return dyn_dict_has_key(container, DYN_DATA(element, str));
+
             dyn_str key = dyn_get_string(element);
             i = dyn_dict_has_key(container, key);
             free(key);
@@ -45,13 +53,11 @@ static dyn_ushort search (const dyn_c *container, dyn_c *element)
         }
         case SET:
         case LIST: {
-            dyn_c tmp;
-            DYN_INIT(&tmp);
-            for (; i<DYN_LIST_LEN(container); ++i) {
-                dyn_set_ref(&tmp, DYN_LIST_GET_REF(container, i));
-                dyn_op_id(&tmp, element);
-
-                if (dyn_get_bool(&tmp))
+            const dyn_c *ptr = DYN_LIST_GET_REF(container, 0);
+            const dyn_char type = DYN_TYPE(element);
+            for (; i<DYN_LIST_LEN(container); ++i, ++ptr) {
+                if (DYN_TYPE(DYN_IS_REFERENCE(ptr) ? DYN_DATA(ptr, ref) : ptr) == type &&
+                    dyn_op_cmp(ptr, element) == DYN_CMP_EQ)
                     return ++i;
             }
         }
@@ -60,6 +66,12 @@ static dyn_ushort search (const dyn_c *container, dyn_c *element)
     return 0;
 }
 
+//! Predicate for dyn_list_remove_if, DYN_TRUE if element is in container
+static trilean contained (const dyn_c* element, const void* container)
+{
+    return search((const dyn_c*) container, element) ? DYN_TRUE : DYN_FALSE;
+}
+
 /**
  * The negation operation is only be applied onto numeric or boolean/trilean
  * data types. For all other types the result of dyn is set to type NONE.
@@ -75,11 +87,11 @@ trilean dyn_op_neg (dyn_c* dyn)
 
     switch (DYN_TYPE(dyn)) {
         case NONE:    goto LABEL_OK;
-        case BOOL:    dyn->data.b = !dyn->data.b;
+        case BOOL:    DYN_SET_DATA(dyn, b, !DYN_DATA(dyn, b));
                       goto LABEL_OK;
-        case INTEGER: dyn->data.i = -dyn->data.i;
+        case INTEGER: DYN_SET_DATA(dyn, i, -DYN_DATA(dyn, i));
                       goto LABEL_OK;
-        case FLOAT:   dyn->data.f = -dyn->data.f;
+        case FLOAT:   DYN_SET_DATA(dyn, f, -DYN_DATA(dyn, f));
                       goto LABEL_OK;
     }
 
@@ -138,16 +150,17 @@ trilean dyn_op_add (dyn_c* dyn1, dyn_c* dyn2)
                           goto LABEL_OK;
             case STRING:  {
                 if (DYN_TYPE(dyn1) == STRING) {
-                    dyn1->data.str = (dyn_str) realloc(dyn1->data.str, dyn_strlen(dyn1->data.str) +
-                                                                      dyn_string_len(dyn2) + 1 );
-                    dyn_string_add(dyn2, dyn1->data.str);
+                    DYN_SET_DATA(dyn1, str, (dyn_str) dyn_mem_realloc(DYN_DATA(dyn1, str),
+                                                              dyn_strlen(DYN_DATA(dyn1, str)) +
+                                                              dyn_string_len(dyn2) + 1 ));
+                    dyn_string_add(dyn2, DYN_DATA(dyn1, str));
                 }
                 else {
-                    tmp.type = STRING;
-                    tmp.data.str = (dyn_str) malloc(dyn_string_len(dyn1) + dyn_string_len(dyn2) + 1);
-                    tmp.data.str[0]='\0';
-                    dyn_string_add(dyn1, tmp.data.str);
-                    dyn_string_add(dyn2, tmp.data.str);
+                    DYN_SET_TYPE(&tmp, STRING);
+                    DYN_SET_DATA(&tmp, str, (dyn_str) dyn_mem_alloc(dyn_string_len(dyn1) + dyn_string_len(dyn2) + 1));
+                    DYN_DATA(&tmp, str)[0]='\0';
+                    dyn_string_add(dyn1, DYN_DATA(&tmp, str));
+                    dyn_string_add(dyn2, DYN_DATA(&tmp, str));
                     dyn_move(&tmp, dyn1);
                 }
                 goto LABEL_OK;
@@ -222,12 +235,10 @@ trilean dyn_op_sub (dyn_c* dyn1, dyn_c* dyn2)
             case SET: {
                 dyn_ushort pos;
                 if (DYN_TYPE(dyn1) == DYN_TYPE(dyn2)) {
-                    dyn_ushort i;
-                    for (i=0; i<DYN_LIST_LEN(dyn2); ++i) {
-                        pos = search(dyn1, DYN_LIST_GET_REF(dyn2, i));
-                        if (pos)
-                            dyn_list_remove(dyn1, pos-1);
-                    }
+                    if (DYN_DATA(dyn1, list) == DYN_DATA(dyn2, list))
+                        dyn_list_popi(dyn1, DYN_LIST_LEN(dyn1));
+                    else
+                        dyn_list_remove_if(dyn1, contained, dyn2);
                 } else if (DYN_TYPE(dyn1) == SET) {
                     pos = search(dyn1, dyn2);
                     if (pos)
@@ -292,14 +303,15 @@ trilean dyn_op_mul (dyn_c* dyn1, dyn_c* dyn2)
                     case 0: dyn_set_string(dyn1, "");
                     case 1: break;
                     default: {
-                        dyn_ushort len = dyn_strlen(dyn1->data.str);
-                        dyn1->data.str = (dyn_str) realloc(dyn1->data.str, len * i + 1);
+                        dyn_ushort len = dyn_strlen(DYN_DATA(dyn1, str));
+                        dyn_str str = (dyn_str) dyn_mem_realloc(DYN_DATA(dyn1, str), len * i + 1);
+                        DYN_SET_DATA(dyn1, str, str);
 
-                        dyn_str c = &dyn1->data.str[len];
+                        dyn_str c = &str[len];
                         dyn_ushort j;
                         while(--i) {
                             for(j=0; j<len; ++j) {
-                                *c++ = dyn1->data.str[j];
+                                *c++ = str[j];
                             }
                         }
                         *c = '\0';
@@ -439,10 +451,104 @@ float fast_approx_pow (float x, float p)
     return mx.f;
 }
 
+#ifdef TARGET_ARDUNINO
+static trilean pow_approx = DYN_TRUE;
+#else
+static trilean pow_approx = DYN_FALSE;
+#endif
+
+/**
+ * Switches the evaluation of FLOAT exponents between the precise powf function
+ * of the math library and fast_approx_pow. The default is the precise mode,
+ * except for embedded targets (TARGET_ARDUNINO). INTEGER exponents are always
+ * evaluated exactly via exponentiation by squaring.
+ *
+ * @param approx DYN_TRUE to apply fast_approx_pow, DYN_FALSE for powf
+ *
+ * @returns the previous mode
+ */
+trilean dyn_op_pow_approx (const trilean approx)
+{
+    trilean prev = pow_approx;
+    pow_approx = approx ? DYN_TRUE : DYN_FALSE;
+    return prev;
+}
+
+/**
+ * Exponentiation by squaring for INTEGER values, which requires O(log n)
+ * multiplications. The calculation is aborted as soon as an intermediate
+ * result exceeds the range of dyn_int.
+ *
+ * @param[in]  base
+ * @param[in]  exp  non negative exponent
+ * @param[out] rslt base^exp
+ *
+ * @retval DYN_TRUE   if the result fits into dyn_int
+ * @retval DYN_FALSE  on overflow
+ */
+static trilean int_pow (const dyn_int base, dyn_uint exp, dyn_int* rslt)
+{
+    int64_t r = 1;
+    int64_t b = base;
+
+    while (exp) {
+        if (exp & 1) {
+            r *= b;
+            if (r > INT32_MAX || r < INT32_MIN)
+                return DYN_FALSE;
+        }
+        exp >>= 1;
+        if (exp) {
+            b *= b;
+            if (b > INT32_MAX)
+                return DYN_FALSE;
+        }
+    }
+
+    *rslt = (dyn_int) r;
+    return DYN_TRUE;
+}
+
+/**
+ * Exponentiation by squaring for FLOAT values with INTEGER exponents, negative
+ * exponents result in the reciprocal value.
+ *
+ * @param base
+ * @param exp
+ *
+ * @returns base^exp
+ */
+static dyn_float float_pow (dyn_float base, const dyn_int exp)
+{
+    dyn_uint e = exp < 0 ? -(dyn_uint)exp : (dyn_uint)exp;
+    dyn_float r = 1.0f;
+
+    while (e) {
+        if (e & 1)
+            r *= base;
+        e >>= 1;
+        if (e)
+            base *= base;
+    }
+
+    return exp < 0 ? 1.0f / r : r;
+}
+
 /**
- * Power function is only applied onto NUMERIC values less than FLOAT, in case
- * of a FLOAT value the system pow function gets applied or in case of the
- * usage of an embedded system, fast_approx_pow algorithm is applied.
+ * Power function is only applied onto NUMERIC values. INTEGER (and BOOL) values
+ * with non negative INTEGER exponents result in an exact INTEGER value, if the
+ * result exceeds the range of an INTEGER or the exponent is negative, then the
+ * result is of type FLOAT. Integral exponents are calculated by squaring,
+ * FLOAT exponents are either passed to the system function powf or to
+ * fast_approx_pow, see dyn_op_pow_approx.
+ *
+ * @code
+ * dyn_op_pow(2, 10)     == 1024
+ * dyn_op_pow(2, 0)      == 1
+ * dyn_op_pow(2, -1)     == 0.5
+ * dyn_op_pow(2, 40)     == 1099511627776.0
+ * dyn_op_pow(2.0, 0.5)  == 1.414214
+ * @endcode
  *
  * @param[in, out] dyn1 base value and result value
  * @param[in]      dyn2 exponent value
@@ -450,54 +556,212 @@ float fast_approx_pow (float x, float p)
  * @retval DYN_TRUE   if operation could be applied onto the input data types
  * @retval DYN_FALSE  otherwise
  */
-trilean dyn_op_pow (dyn_c* dyn1, dyn_c* dyn2)
+trilean dyn_op_pow (dyn_c *dyn1, dyn_c *dyn2)
 {
     CHECK_REFERENCE(dyn1, dyn2)
 
-    if (DYN_IS_NONE(dyn1) || DYN_IS_NONE(dyn2)) {
+    if (DYN_IS_NONE(dyn1) || DYN_IS_NONE(dyn2) ||
+        DYN_TYPE(dyn1) > FLOAT || DYN_TYPE(dyn2) > FLOAT) {
         dyn_free(dyn1);
         return DYN_FALSE;
     }
 
-    if (DYN_TYPE(dyn1) <= FLOAT && DYN_TYPE(dyn2) == FLOAT) {
-        dyn_set_float(dyn1, fast_approx_pow(dyn_get_float(dyn1),
-                                            dyn_get_float(dyn2)));
+    if (DYN_TYPE(dyn2) == FLOAT) {
+        dyn_float base = dyn_get_float(dyn1);
+        dyn_float exponent = dyn_get_float(dyn2);
+
+        dyn_set_float(dyn1, pow_approx ? fast_approx_pow(base, exponent)
+                                       : powf(base, exponent));
         return DYN_TRUE;
     }
 
-    if (DYN_TYPE(dyn2) == INTEGER) {
-        dyn_int exponent = dyn_get_int(dyn2);
-
-        if (DYN_TYPE(dyn1) == INTEGER) {
-            dyn_int base = dyn_get_int(dyn1);
-            if (exponent > 0) {
-                while (--exponent)
-                    dyn1->data.i *= base;
-            } else {
-                dyn_set_float(dyn1, base);
-                --exponent;
-                while (exponent++)
-                    dyn1->data.f /= base;
-            }
-            return DYN_TRUE;
-        } else if (DYN_TYPE(dyn1) == FLOAT) {
-            dyn_float base = dyn_get_float(dyn1);
-            if (exponent > 0) {
-                while (--exponent)
-                    dyn1->data.f *= base;
-            } else {
-                --exponent;
-                while (exponent++)
-                    dyn1->data.f /= base;
-            }
+    dyn_int exponent = dyn_get_int(dyn2);
+
+    if (DYN_TYPE(dyn1) != FLOAT && exponent >= 0) {
+        dyn_int rslt;
+        if (int_pow(dyn_get_int(dyn1), exponent, &rslt)) {
+            dyn_set_int(dyn1, rslt);
             return DYN_TRUE;
         }
     }
 
+    dyn_set_float(dyn1, float_pow(dyn_get_float(dyn1), exponent));
+    return DYN_TRUE;
+}
+
+/**
+ * Fused multiply-add, dyn1 = dyn1 + dyn2 * dyn3. If all parameters are
+ * NUMERIC, the result is calculated directly within dyn1, without any
+ * temporary element. For all other types, the product is calculated within a
+ * temporary copy of dyn2 and added afterwards, see dyn_op_mul and dyn_op_add.
+ *
+ * @code
+ * dyn_op_muladd(1, 2, 3)      == 7
+ * dyn_op_muladd(1, 2.5, 2)    == 6.0
+ * dyn_op_muladd([1], [2], 2)  == [1,[2,2]]
+ * @endcode
+ *
+ * @param[in, out] dyn1 summand and result value
+ * @param[in]      dyn2 first factor
+ * @param[in]      dyn3 second factor
+ *
+ * @retval DYN_TRUE   if operation could be applied onto the input data types
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_op_muladd (dyn_c* dyn1, dyn_c* dyn2, dyn_c* dyn3)
+{
+    CHECK_REFERENCE(dyn1, dyn2)
+    CHECK_NOCOPY_REFERENCE(dyn3)
+
+    if (DYN_TYPE(dyn1) && DYN_TYPE(dyn2) && DYN_TYPE(dyn3) &&
+        DYN_TYPE(dyn1) <= FLOAT && DYN_TYPE(dyn2) <= FLOAT && DYN_TYPE(dyn3) <= FLOAT) {
+        if (DYN_TYPE(dyn1) == FLOAT || DYN_TYPE(dyn2) == FLOAT || DYN_TYPE(dyn3) == FLOAT)
+            dyn_set_float(dyn1, dyn_get_float(dyn1) + dyn_get_float(dyn2) * dyn_get_float(dyn3));
+        else
+            dyn_set_int(dyn1, dyn_get_int(dyn1) + dyn_get_int(dyn2) * dyn_get_int(dyn3));
+        return DYN_TRUE;
+    }
+
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+
+    if (dyn_copy(dyn2, &tmp) && dyn_op_mul(&tmp, dyn3) && dyn_op_add(dyn1, &tmp)) {
+        dyn_free(&tmp);
+        return DYN_TRUE;
+    }
+
+    dyn_free(&tmp);
     dyn_free(dyn1);
     return DYN_FALSE;
 }
 
+/**
+ * Increment a NUMERIC value by a constant step, the type of FLOAT values
+ * remains, BOOL values are turned into INTEGER.
+ *
+ * @param[in, out] dyn  in- and output parameter
+ * @param[in]      step constant to add
+ *
+ * @retval DYN_TRUE   if dyn is of type NUMERIC
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_op_inc (dyn_c* dyn, const dyn_int step)
+{
+    CHECK_COPY_REFERENCE(dyn)
+
+    switch (DYN_TYPE(dyn)) {
+        case BOOL:
+        case INTEGER: dyn_set_int(dyn, dyn_get_int(dyn) + step);
+                      return DYN_TRUE;
+        case FLOAT:   DYN_SET_DATA(dyn, f, DYN_DATA(dyn, f) + step);
+                      return DYN_TRUE;
+    }
+
+    dyn_free(dyn);
+    return DYN_FALSE;
+}
+
+/**
+ * Decrement a NUMERIC value by a constant step, see dyn_op_inc.
+ *
+ * @param[in, out] dyn  in- and output parameter
+ * @param[in]      step constant to subtract
+ *
+ * @retval DYN_TRUE   if dyn is of type NUMERIC
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_op_dec (dyn_c* dyn, const dyn_int step)
+{
+    return dyn_op_inc(dyn, -step);
+}
+
+/**
+ * Limit a value to the range [min, max], the bounds are compared with
+ * dyn_op_cmp, such that every comparable type can be clamped. If dyn is
+ * outside of the range, it is replaced by a copy of the according bound.
+ *
+ * @code
+ * dyn_op_clamp(12, 0, 10)        == 10
+ * dyn_op_clamp(-1.5, 0, 10)      == 0
+ * dyn_op_clamp("b", "a", "c")    == "b"
+ * dyn_op_clamp("b", 1, 2)        == None (DYN_FALSE)
+ * @endcode
+ *
+ * @param[in, out] dyn in- and output parameter
+ * @param[in]      min lower bound
+ * @param[in]      max upper bound
+ *
+ * @retval DYN_TRUE   if dyn could be compared with both bounds
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_op_clamp (dyn_c* dyn, dyn_c* min, dyn_c* max)
+{
+    CHECK_REFERENCE(dyn, min)
+    CHECK_NOCOPY_REFERENCE(max)
+
+    dyn_char lo = dyn_op_cmp(dyn, min);
+    dyn_char hi = dyn_op_cmp(dyn, max);
+
+    if (lo > DYN_CMP_GT || hi > DYN_CMP_GT) {
+        dyn_free(dyn);
+        return DYN_FALSE;
+    }
+
+    if (lo == DYN_CMP_LT) {
+        dyn_free(dyn);
+        return dyn_copy(min, dyn);
+    }
+
+    if (hi == DYN_CMP_GT) {
+        dyn_free(dyn);
+        return dyn_copy(max, dyn);
+    }
+
+    return DYN_TRUE;
+}
+
+/**
+ * Accumulate into target, applies a binary operation directly onto the target
+ * element. Other than calling the operation directly, a target of type
+ * REFERENCE is not copied, the referenced element itself is changed. This way
+ * chained expressions, such as acc = acc * b + c, can reuse the storage of
+ * acc. If the operation fails, the referenced element is set to NONE, as with
+ * every other operation.
+ *
+ * @code
+ * // pseudo code, x is a list element and ref a reference to it
+ * dyn_op_acc(ref, dyn_op_add, 1)      // x += 1
+ * dyn_op_acc(ref, dyn_op_mul, 2)      // x *= 2
+ * @endcode
+ *
+ * @param[in, out] target element or reference to it
+ * @param[in]      op binary operation, such as dyn_op_add or dyn_op_mul
+ * @param[in]      dyn2 second parameter of op
+ *
+ * @returns the result of op
+ */
+trilean dyn_op_acc (dyn_c* target, trilean (*op)(dyn_c*, dyn_c*), dyn_c* dyn2)
+{
+    if (DYN_IS_REFERENCE(target))
+        target = DYN_DATA(target, ref);
+
+    CHECK_NOCOPY_REFERENCE(dyn2)
+
+    // self-application, the operation might overwrite its own parameter
+    if (target == dyn2) {
+        dyn_c tmp;
+        DYN_INIT(&tmp);
+        if (!dyn_copy(dyn2, &tmp))
+            return DYN_FALSE;
+
+        trilean rslt = op(target, &tmp);
+        dyn_free(&tmp);
+        return rslt;
+    }
+
+    return op(target, dyn2);
+}
+
 /**
  * In case of a NONE value or a FUNCTION the unknown truth value DYN_NONE gets
  * returned otherwise the boolean truth value from dyn_get_bool.
@@ -509,7 +773,7 @@ trilean dyn_op_pow (dyn_c* dyn1, dyn_c* dyn2)
 trilean dyn_get_bool_3 (const dyn_c* dyn)
 {
     if(DYN_IS_REFERENCE(dyn))
-        dyn=dyn->data.ref;
+        dyn=DYN_DATA(dyn, ref);
 
     return (DYN_IS_NONE(dyn) || DYN_TYPE(dyn) == FUNCTION) ? DYN_NONE : dyn_get_bool(dyn);
 }
@@ -665,166 +929,6 @@ trilean dyn_op_not (dyn_c* dyn)
     return DYN_TRUE;
 }
 
-/**
- * @brief Common compare function for dynamic elements
- *
- * Basic compare function for dynamic data dypes, based on the relation between
- * the input parameters, different values are returned, see the list below.
- *
- * @param dyn1 first dynamic parameter
- * @param dyn2 second dynamic parameter
- *
- * @retval 0   if dyn1 == dyn2
- * @retval 1   if dyn1 < dyn2
- * @retval 2   if dyn1 > dyn2
- * @retval 3   if dyn1 != dyn2
- * @retval 4   if not comparable due to different data types (STRING <= SET)
- */
-dyn_char dyn_op_cmp (dyn_c* dyn1, dyn_c* dyn2)
-{
-    enum{EQ,LT,GT,NEQ,TYPE,MARK};//0,1,2,3,4
-
-    dyn_c  *tmp = DYN_IS_REFERENCE(dyn1) ? dyn1->data.ref : dyn1;
-    dyn_char ret;
-    dyn_c tmp2;
-    DYN_INIT(&tmp2);
-    dyn_ushort i;
-
-    if(DYN_IS_REFERENCE(dyn2))
-        dyn2=dyn2->data.ref;
-
-    if (DYN_IS_NONE(tmp) && DYN_IS_NONE(dyn2))
-        goto GOTO_EQ;
-
-    if (DYN_IS_NONE(tmp) && DYN_NOT_NONE(dyn2))
-        goto GOTO_LT;
-
-    if (DYN_NOT_NONE(tmp) && DYN_IS_NONE(dyn2))
-        goto GOTO_GT;
-
-    //this switch has no breaks goto is used to leave to desired return
-    switch (max_type(tmp, dyn2)) {
-        case BOOL:
-            if (dyn_get_bool(tmp) < dyn_get_bool(dyn2))
-                goto GOTO_LT;
-            if (dyn_get_bool(tmp) > dyn_get_bool(dyn2))
-                goto GOTO_GT;
-            goto GOTO_EQ;
-        case INTEGER:
-            if (dyn_get_int(tmp) < dyn_get_int(dyn2))
-                goto GOTO_LT;
-            if (dyn_get_int(tmp) > dyn_get_int(dyn2))
-                goto GOTO_GT;
-            goto GOTO_EQ;
-        case FLOAT:
-            if (dyn_get_float(tmp) < dyn_get_float(dyn2))
-                goto GOTO_LT;
-            if (dyn_get_float(tmp) > dyn_get_float(dyn2))
-                goto GOTO_GT;
-            goto GOTO_EQ;
-        case STRING: {
-            if (DYN_TYPE(tmp) != DYN_TYPE(dyn2))
-                goto GOTO_TYPE;
-            //i = dyn_strcmp(tmp->data.str, dyn2->data.str);
-            //if (i < 0)
-            ret = dyn_strcmp(tmp->data.str, dyn2->data.str);
-            if (ret < 0)
-                goto GOTO_LT;
-            //if (i > 0)
-            if (ret > 0)
-                goto GOTO_GT;
-            goto GOTO_EQ;
-        }
-        case SET: {
-            if (DYN_TYPE(tmp) != DYN_TYPE(dyn2))
-                goto GOTO_TYPE;
-            {
-                dyn_c * lset = NULL;
-                dyn_c * rset;
-                if (DYN_LIST_LEN(tmp) == DYN_LIST_LEN(dyn2)){
-                    // list might be EQ
-                    ret = EQ;
-                    lset = tmp;
-                    rset = dyn2;
-                } else if (DYN_LIST_LEN(tmp) < DYN_LIST_LEN(dyn2)) {
-                    // list might be EQ
-                    ret = LT;
-                    lset = tmp;
-                    rset = dyn2;
-                } else /*if (DYN_LIST_LEN(tmp) > DYN_LIST_LEN(dyn2)) */{
-                    // list might be GT
-                    ret = GT;
-                    lset = dyn2;
-                    rset = tmp;
-                }
-                //check if all elements of lset are in rset
-                //break to NEQ or complete to confirm
-                for (i=0; i<DYN_LIST_LEN(lset); ++i) {
-                    dyn_set_ref(&tmp2, DYN_LIST_GET_REF(lset, i));
-                    dyn_op_in(&tmp2, rset);
-                    if (!dyn_get_bool(&tmp2)){
-                        ret = NEQ;
-                        break;
-                    }
-
-                }
-                goto GOTO_RET;
-
-            }
-            //unreachable
-        }
-        case LIST: {
-            if (DYN_TYPE(tmp) != DYN_TYPE(dyn2))
-                goto GOTO_TYPE;
-            if (DYN_LIST_LEN(tmp) < DYN_LIST_LEN(dyn2))
-                goto GOTO_LT;
-            if (DYN_LIST_LEN(tmp) > DYN_LIST_LEN(dyn2))
-                goto GOTO_GT;
-            if (DYN_LIST_LEN(tmp) == DYN_LIST_LEN(dyn2)) {
-                if (DYN_LIST_LEN(tmp) == 0)
-                    goto GOTO_EQ;
-
-                //put marker into return value
-                ret = MARK;
-                for (i=0; i<DYN_LIST_LEN(tmp); ++i) {
-                    dyn_set_ref(&tmp2, DYN_LIST_GET_REF(tmp, i));
-                    ret = dyn_op_cmp(&tmp2, DYN_LIST_GET_REF(dyn2, i));
-                    if (ret != EQ)
-                        break;
-                }
-                //reached the end of the for loop
-                goto GOTO_RET;
-            }
-            //unreachable
-        }
-    }
-    //unreachable
-    // break with diffent type (string, list and set)
-    goto GOTO_TYPE;
-GOTO_TYPE:
-    ret = TYPE;
-    goto GOTO_RET;
-
-GOTO_EQ:
-    ret = EQ;
-    goto GOTO_RET;
-GOTO_LT:
-    ret = LT;
-    goto GOTO_RET;
-GOTO_GT:
-    ret = GT;
-    goto GOTO_RET;
-/*
-GOTO_NEQ:
-    ret = NEQ;
-    goto GOTO_RET;
-*/
-GOTO_RET:
-    //dyn_set_int(dyn1, ret);
-    return ret;
-
-}
-
 /**
  * @param[in, out] dyn1 in and output parameter
  * @param[in]      dyn2 exponent value
@@ -833,8 +937,8 @@ GOTO_RET:
  */
 trilean dyn_op_id (dyn_c* dyn1, dyn_c* dyn2)
 {
-    if( DYN_TYPE(DYN_IS_REFERENCE(dyn1) ? dyn1->data.ref : dyn1) ==
-        DYN_TYPE(DYN_IS_REFERENCE(dyn2) ? dyn2->data.ref : dyn2) )
+    if( DYN_TYPE(DYN_IS_REFERENCE(dyn1) ? DYN_DATA(dyn1, ref) : dyn1) ==
+        DYN_TYPE(DYN_IS_REFERENCE(dyn2) ? DYN_DATA(dyn2, ref) : dyn2) )
       dyn_op_eq(dyn1, dyn2);
     else
       dyn_set_bool(dyn1, DYN_FALSE);
@@ -880,10 +984,10 @@ trilean dyn_op_lt (dyn_c* dyn1, dyn_c* dyn2)
     dyn_char rslt = dyn_op_cmp (dyn1, dyn2);
 
     // types not comparable
-    if (rslt == 4)
+    if (rslt == DYN_CMP_TYPE)
         dyn_free(dyn1);
     else
-        dyn_set_bool(dyn1, (rslt == 1)
+        dyn_set_bool(dyn1, (rslt == DYN_CMP_LT)
                            ? DYN_TRUE
                            : DYN_FALSE);
     return DYN_TRUE;
@@ -914,10 +1018,10 @@ trilean dyn_op_gt (dyn_c* dyn1, dyn_c* dyn2)
     dyn_char rslt = dyn_op_cmp (dyn1, dyn2);
 
     // types not comparable
-    if (rslt == 4)
+    if (rslt == DYN_CMP_TYPE)
         dyn_free(dyn1);
     else
-        dyn_set_bool(dyn1, (rslt == 2)
+        dyn_set_bool(dyn1, (rslt == DYN_CMP_GT)
                            ? DYN_TRUE
                            : DYN_FALSE );
     return DYN_TRUE;
@@ -948,10 +1052,10 @@ trilean dyn_op_le (dyn_c* dyn1, dyn_c* dyn2)
  */
 trilean dyn_op_in (dyn_c *element, dyn_c *container)
 {
-    dyn_c *tmp = DYN_IS_REFERENCE(element) ? element->data.ref : element;
+    dyn_c *tmp = DYN_IS_REFERENCE(element) ? DYN_DATA(element, ref) : element;
 
     if(DYN_IS_REFERENCE(container))
-        container = container->data.ref;
+        container = DYN_DATA(container, ref);
 
     switch (DYN_TYPE(container)) {
         case SET:
@@ -969,13 +1073,13 @@ trilean dyn_op_in (dyn_c *element, dyn_c *container)
 trilean dyn_op_b_not(dyn_c *dyn)
 {
     if (DYN_TYPE(dyn) == REFERENCE2)
-        DYN_TYPE(dyn) = REFERENCE;
+        DYN_SET_TYPE(dyn, REFERENCE);
 
     if(DYN_TYPE(dyn) == REFERENCE)
-        dyn_copy(dyn->data.ref, dyn);
+        dyn_copy(DYN_DATA(dyn, ref), dyn);
 
     if (DYN_TYPE(dyn)==INTEGER) {
-        dyn->data.i = ~dyn->data.i;
+        DYN_SET_DATA(dyn, i, ~DYN_DATA(dyn, i));
         return DYN_TRUE;
     }
 
@@ -989,7 +1093,7 @@ trilean dyn_op_b_and(dyn_c *dyn1, dyn_c *dyn2)
     CHECK_REFERENCE(dyn1, dyn2)
 
     if (DYN_TYPE(dyn1)==INTEGER && DYN_TYPE(dyn2)==INTEGER) {
-        dyn1->data.i = dyn1->data.i & dyn2->data.i;
+        DYN_SET_DATA(dyn1, i, DYN_DATA(dyn1, i) & DYN_DATA(dyn2, i));
         return DYN_TRUE;
     }
 
@@ -1002,7 +1106,7 @@ trilean dyn_op_b_or(dyn_c *dyn1, dyn_c *dyn2)
     CHECK_REFERENCE(dyn1, dyn2)
 
     if (DYN_TYPE(dyn1)==INTEGER && DYN_TYPE(dyn2)==INTEGER) {
-        dyn1->data.i = dyn1->data.i | dyn2->data.i;
+        DYN_SET_DATA(dyn1, i, DYN_DATA(dyn1, i) | DYN_DATA(dyn2, i));
         return DYN_TRUE;
     }
 
@@ -1016,7 +1120,7 @@ trilean dyn_op_b_xor(dyn_c *dyn1, dyn_c *dyn2)
     CHECK_REFERENCE(dyn1, dyn2)
 
     if (DYN_TYPE(dyn1)==INTEGER && DYN_TYPE(dyn2)==INTEGER) {
-        dyn1->data.i ^= dyn2->data.i;
+        DYN_SET_DATA(dyn1, i, DYN_DATA(dyn1, i) ^ DYN_DATA(dyn2, i));
         return DYN_TRUE;
     }
 
@@ -1030,7 +1134,7 @@ trilean dyn_op_b_shift_l(dyn_c *dyn1, dyn_c *dyn2)
     CHECK_REFERENCE(dyn1, dyn2)
 
     if (DYN_TYPE(dyn1)==INTEGER && DYN_TYPE(dyn2)==INTEGER) {
-        dyn1->data.i <<= dyn2->data.i;
+        DYN_SET_DATA(dyn1, i, DYN_DATA(dyn1, i) << DYN_DATA(dyn2, i));
         return DYN_TRUE;
     }
 
@@ -1043,7 +1147,7 @@ trilean dyn_op_b_shift_r(dyn_c *dyn1, dyn_c *dyn2)
     CHECK_REFERENCE(dyn1, dyn2)
 
     if (DYN_TYPE(dyn1)==INTEGER && DYN_TYPE(dyn2)==INTEGER) {
-        dyn1->data.i >>= dyn2->data.i;
+        DYN_SET_DATA(dyn1, i, DYN_DATA(dyn1, i) >> DYN_DATA(dyn2, i));
         return DYN_TRUE;
     }
 
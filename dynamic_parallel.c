@@ -0,0 +1,487 @@
+/**
+ *  @file dynamic_parallel.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of a work-stealing thread pool and parallel variants
+ *         of copy, free, and size for large containers.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#ifdef S2_THREADS
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+//! Containers with less elements are processed sequentially
+#define PARALLEL_MIN    1024
+//! Number of chunks per thread, smaller chunks balance better
+#define PARALLEL_CHUNKS 8
+//! Initial number of tasks per deque
+#define POOL_TASKS      64
+
+#define CACHE_LINE      64
+
+
+typedef struct {
+    void      (*fct)(dyn_uint, dyn_uint, void*);
+    void*     ctx;
+    dyn_uint  begin;
+    dyn_uint  end;
+    dyn_uint* pending;      //!< unfinished tasks of the same dyn_pool_for
+#ifdef S2_MEMORY
+    dyn_memory* memory;     //!< context of the calling thread
+#endif
+} pool_task;
+
+/**
+ * Every thread owns one deque, it takes tasks from the back, while other
+ * threads steal from the front.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pool_task*      task;
+    dyn_uint        head;
+    dyn_uint        tail;
+    dyn_uint        space;
+} __attribute__ ((aligned (CACHE_LINE))) pool_deque;
+
+struct dynamic_pool {
+    pthread_t*      thread;
+    pool_deque*     deque;  //!< one per worker, the last one for callers
+    dyn_ushort      deques;
+    dyn_ushort      threads;
+    dyn_uint        queued; //!< number of tasks within all deques
+    trilean         stop;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+};
+
+typedef struct {
+    dyn_pool*  pool;
+    dyn_ushort id;
+} worker_arg;
+
+
+static trilean deque_push (pool_deque* d, const pool_task* task)
+{
+    trilean rv = DYN_TRUE;
+
+    pthread_mutex_lock(&d->lock);
+    if (d->tail - d->head == d->space) {
+        dyn_uint space = d->space * 2;
+        pool_task* t = (pool_task*) malloc(space * sizeof(pool_task));
+        if (t) {
+            dyn_uint i;
+            for (i=d->head; i<d->tail; ++i)
+                t[i - d->head] = d->task[i % d->space];
+            free(d->task);
+            d->task = t;
+            d->tail -= d->head;
+            d->head = 0;
+            d->space = space;
+        } else {
+            rv = DYN_FALSE;
+        }
+    }
+    if (rv)
+        d->task[d->tail++ % d->space] = *task;
+    pthread_mutex_unlock(&d->lock);
+
+    return rv;
+}
+
+//! Takes a task from the back (owner) or from the front (thief)
+static trilean deque_pop (pool_deque* d, pool_task* task, const trilean steal)
+{
+    trilean rv = DYN_FALSE;
+
+    pthread_mutex_lock(&d->lock);
+    if (d->head != d->tail) {
+        *task = steal ? d->task[d->head++ % d->space]
+                      : d->task[--d->tail % d->space];
+        rv = DYN_TRUE;
+    }
+    pthread_mutex_unlock(&d->lock);
+
+    return rv;
+}
+
+//! Takes a task from the own deque or steals one from another thread
+static trilean pool_take (dyn_pool* pool, const dyn_ushort id, pool_task* task)
+{
+    dyn_ushort n = pool->deques;
+    dyn_ushort i;
+
+    if (!__atomic_load_n(&pool->queued, __ATOMIC_ACQUIRE))
+        return DYN_FALSE;
+
+    for (i=0; i<n; ++i) {
+        if (deque_pop(&pool->deque[(id + i) % n], task, i ? DYN_TRUE : DYN_FALSE)) {
+            __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_ACQ_REL);
+            return DYN_TRUE;
+        }
+    }
+
+    return DYN_FALSE;
+}
+
+static void pool_run (const pool_task* task)
+{
+#ifdef S2_MEMORY
+    // memory is accounted to the caller of dyn_pool_for
+    dyn_memory* prev = dyn_memory_use(task->memory);
+#endif
+    task->fct(task->begin, task->end, task->ctx);
+#ifdef S2_MEMORY
+    dyn_memory_use(prev);
+#endif
+    __atomic_sub_fetch(task->pending, 1, __ATOMIC_ACQ_REL);
+}
+
+static void* pool_worker (void* arg)
+{
+    dyn_pool* pool = ((worker_arg*) arg)->pool;
+    dyn_ushort id = ((worker_arg*) arg)->id;
+    pool_task task;
+
+    free(arg);
+
+    for (;;) {
+        if (pool_take(pool, id, &task)) {
+            pool_run(&task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop && !__atomic_load_n(&pool->queued, __ATOMIC_ACQUIRE))
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        trilean stop = pool->stop;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stop)
+            return NULL;
+    }
+}
+
+/**
+ * Creates a pool of worker threads, every thread owns a deque of tasks and
+ * steals tasks from other threads, if its own deque is empty. The calling
+ * thread of dyn_pool_for participates as well. Memory is allocated with
+ * malloc, which uses separate arenas per thread, such that the threads do
+ * not contend on a single allocator.
+ *
+ * @param[in] threads number of worker threads
+ *
+ * @returns the new pool or NULL, if the threads could not be created
+ */
+dyn_pool* dyn_pool_new (const dyn_ushort threads)
+{
+    dyn_pool* pool = (dyn_pool*) malloc(sizeof(dyn_pool));
+    dyn_ushort i;
+
+    if (!pool)
+        return NULL;
+
+    pool->threads = 0;
+    pool->deques = 0;
+    pool->queued = 0;
+    pool->stop = DYN_FALSE;
+    pool->thread = (pthread_t*) malloc((threads + 1) * sizeof(pthread_t));
+    if (posix_memalign((void**) &pool->deque, CACHE_LINE,
+                       (threads + 1) * sizeof(pool_deque)))
+        pool->deque = NULL;
+
+    if (!pool->thread || !pool->deque)
+        goto GOTO__ERROR;
+
+    for (; pool->deques<=threads; ++pool->deques) {
+        pool_deque* d = &pool->deque[pool->deques];
+        d->task = (pool_task*) malloc(POOL_TASKS * sizeof(pool_task));
+        if (!d->task)
+            goto GOTO__ERROR;
+        pthread_mutex_init(&d->lock, NULL);
+        d->head = d->tail = 0;
+        d->space = POOL_TASKS;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    // workers use the deques 0 to threads-1, callers use the last one
+    for (i=0; i<threads; ++i) {
+        worker_arg* arg = (worker_arg*) malloc(sizeof(worker_arg));
+        if (!arg)
+            break;
+        arg->pool = pool;
+        arg->id = i;
+        if (pthread_create(&pool->thread[i], NULL, pool_worker, arg)) {
+            free(arg);
+            break;
+        }
+        pool->threads++;
+    }
+
+    return pool;
+
+GOTO__ERROR:
+    while (pool->deques--) {
+        pthread_mutex_destroy(&pool->deque[pool->deques].lock);
+        free(pool->deque[pool->deques].task);
+    }
+    free(pool->thread);
+    free(pool->deque);
+    free(pool);
+    return NULL;
+}
+
+/**
+ * Stops all worker threads and frees the pool, there must not be any running
+ * dyn_pool_for call.
+ *
+ * @param[in, out] pool
+ */
+void dyn_pool_free (dyn_pool* pool)
+{
+    dyn_ushort i, n = pool->threads;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = DYN_TRUE;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i=0; i<n; ++i)
+        pthread_join(pool->thread[i], NULL);
+
+    for (i=0; i<pool->deques; ++i) {
+        pthread_mutex_destroy(&pool->deque[i].lock);
+        free(pool->deque[i].task);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->thread);
+    free(pool->deque);
+    free(pool);
+}
+
+/**
+ * @param[in] pool
+ *
+ * @returns the number of threads that work on dyn_pool_for, including the
+ *          calling thread
+ */
+dyn_ushort dyn_pool_threads (const dyn_pool* pool)
+{
+    return pool ? pool->threads + 1 : 1;
+}
+
+/**
+ * Splits the range [0, n) into chunks of at most chunk indices and calls
+ * fct(begin, end, ctx) for every chunk on any thread of the pool. The calling
+ * thread participates and the function returns, after all chunks have been
+ * processed. Chunks are distributed round-robin onto all deques, idle threads
+ * steal chunks from busy ones, such that unevenly sized chunks are balanced.
+ * Calls must not be nested, fct must not call dyn_pool_for again.
+ *
+ * @param[in] pool can be NULL, then everything is processed sequentially
+ * @param[in] n number of indices
+ * @param[in] chunk maximal number of indices per task, 0 for automatic
+ * @param[in] fct function to call for every chunk
+ * @param[in] ctx passed to fct
+ */
+void dyn_pool_for (dyn_pool* pool, const dyn_uint n, dyn_uint chunk,
+                   void (*fct)(dyn_uint, dyn_uint, void*), void* ctx)
+{
+    dyn_ushort threads = dyn_pool_threads(pool);
+    dyn_uint pending = 0;
+    dyn_uint begin;
+    pool_task task;
+
+    if (!chunk)
+        chunk = n / (threads * PARALLEL_CHUNKS) + 1;
+
+    if (threads == 1 || chunk >= n) {
+        if (n)
+            fct(0, n, ctx);
+        return;
+    }
+
+    task.fct = fct;
+    task.ctx = ctx;
+    task.pending = &pending;
+#ifdef S2_MEMORY
+    task.memory = dyn_memory_current();
+#endif
+
+    dyn_ushort d = 0;
+    // the caller deque is the one behind the last running worker
+    for (begin=0; begin<n; begin+=chunk) {
+        task.begin = begin;
+        task.end = begin + chunk < n ? begin + chunk : n;
+
+        __atomic_add_fetch(&pending, 1, __ATOMIC_ACQ_REL);
+        if (deque_push(&pool->deque[d], &task)) {
+            __atomic_add_fetch(&pool->queued, 1, __ATOMIC_ACQ_REL);
+            d = (d + 1) % threads;
+        } else {
+            pool_run(&task);
+        }
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    while (__atomic_load_n(&pending, __ATOMIC_ACQUIRE)) {
+        if (pool_take(pool, threads - 1, &task))
+            pool_run(&task);
+        else
+            sched_yield();
+    }
+}
+
+
+//! Elements of a LIST, SET, or DICT, the list that stores the values of a DICT
+static dyn_list* elements (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == DICT ? DYN_DATA(&DYN_DATA(dyn, dict)->value, list)
+                                 : DYN_DATA(dyn, list);
+}
+
+static trilean is_large (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+        case LIST:
+        case SET:
+        case DICT:  return elements(dyn)->length >= PARALLEL_MIN;
+    }
+    return DYN_FALSE;
+}
+
+typedef struct {
+    const dyn_c* src;
+    dyn_c*       dst;
+    dyn_uint     bytes;
+    trilean      failed;
+} parallel_ctx;
+
+static void copy_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    parallel_ctx* ctx = (parallel_ctx*) arg;
+
+    for (; begin<end; ++begin)
+        if (!dyn_copy(&ctx->src[begin], &ctx->dst[begin]))
+            __atomic_store_n(&ctx->failed, DYN_TRUE, __ATOMIC_RELAXED);
+}
+
+/**
+ * Deep copy, the elements of a large LIST, SET, or DICT are copied in
+ * parallel, smaller elements are copied with dyn_copy.
+ *
+ * @param[in] pool thread pool, see dyn_pool_new
+ * @param[in] dyn original element
+ * @param[out] copy newly created element
+ *
+ * @retval DYN_TRUE   if element could be copied
+ * @retval DYN_FALSE  otherwise, copy is of type NONE
+ */
+trilean dyn_copy_parallel (dyn_pool* pool, const dyn_c* dyn, dyn_c* copy)
+{
+    if (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    if (!is_large(dyn))
+        return dyn_copy(dyn, copy);
+
+    dyn_ushort len = elements(dyn)->length;
+
+    if (DYN_TYPE(dyn) == DICT) {
+        if (!dyn_set_dict(copy, len))
+            return DYN_FALSE;
+        DYN_DATA(copy, dict)->shape = dyn_shape_ref(DYN_DATA(dyn, dict)->shape);
+    } else {
+        if (!dyn_set_list_len(copy, len))
+            return DYN_FALSE;
+        DYN_SET_TYPE(copy, DYN_TYPE(dyn));
+    }
+    elements(copy)->length = len;
+
+    parallel_ctx ctx = { elements(dyn)->container, elements(copy)->container,
+                         0, DYN_FALSE };
+    dyn_pool_for(pool, len, 0, copy_chunk, &ctx);
+
+    if (ctx.failed) {
+        dyn_free_parallel(pool, copy);
+        return DYN_FALSE;
+    }
+
+    return DYN_TRUE;
+}
+
+static void free_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    parallel_ctx* ctx = (parallel_ctx*) arg;
+
+    for (; begin<end; ++begin)
+        dyn_free(&ctx->dst[begin]);
+}
+
+/**
+ * Frees an element, the elements of a large LIST, SET, or DICT are freed in
+ * parallel.
+ *
+ * @param[in] pool thread pool, see dyn_pool_new
+ * @param[in, out] dyn element to free, NONE afterwards
+ */
+void dyn_free_parallel (dyn_pool* pool, dyn_c* dyn)
+{
+    if (is_large(dyn)) {
+        parallel_ctx ctx = { NULL, elements(dyn)->container, 0, DYN_FALSE };
+        dyn_pool_for(pool, elements(dyn)->length, 0, free_chunk, &ctx);
+    }
+
+    dyn_free(dyn);
+}
+
+static void size_chunk (dyn_uint begin, dyn_uint end, void* arg)
+{
+    parallel_ctx* ctx = (parallel_ctx*) arg;
+    dyn_uint bytes = 0;
+
+    for (; begin<end; ++begin)
+        bytes += dyn_size(&ctx->src[begin]);
+
+    __atomic_add_fetch(&ctx->bytes, bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Calculates the same size as dyn_size, the elements of a large LIST, SET,
+ * or DICT are processed in parallel.
+ *
+ * @param[in] pool thread pool, see dyn_pool_new
+ * @param[in] dyn element to check
+ *
+ * @returns size in bytes
+ */
+dyn_uint dyn_size_parallel (dyn_pool* pool, const dyn_c* dyn)
+{
+    if (!is_large(dyn))
+        return dyn_size(dyn);
+
+    parallel_ctx ctx = { elements(dyn)->container, NULL,
+                         dyn_size_shallow(dyn), DYN_FALSE };
+    dyn_pool_for(pool, elements(dyn)->space, 0, size_chunk, &ctx);
+
+    return ctx.bytes;
+}
+
+#endif
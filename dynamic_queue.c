@@ -0,0 +1,389 @@
+/**
+ *  @file dynamic_queue.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of a bounded lock-free multi-producer multi-consumer
+ *         queue, which moves elements between threads.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#ifdef S2_THREADS
+
+#include <pthread.h>
+
+//! Number of failed attempts, before a blocking call sleeps
+#define QUEUE_SPIN      64
+
+#define CACHE_LINE      64
+
+
+/**
+ * Every cell carries a sequence number, which tells producers and consumers
+ * at which position of the queue the cell can be used next: pos if it is
+ * free for the producer of pos, pos + 1 if it holds the element of pos.
+ */
+typedef struct {
+    dyn_uint seq;
+    dyn_c    value;
+} queue_cell;
+
+struct dynamic_queue {
+    queue_cell*     cell;
+    dyn_uint        mask;
+    trilean         closed;
+
+    dyn_uint        head __attribute__ ((aligned (CACHE_LINE))); //!< next push
+    dyn_uint        tail __attribute__ ((aligned (CACHE_LINE))); //!< next pop
+
+    pthread_mutex_t lock __attribute__ ((aligned (CACHE_LINE)));
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    dyn_uint        consumers;  //!< number of sleeping consumers
+    dyn_uint        producers;  //!< number of sleeping producers
+};
+
+
+/**
+ * Creates an empty queue, the capacity is rounded up to a power of two.
+ *
+ * @param[in] size minimal number of elements
+ *
+ * @returns the new queue or NULL, if no memory could be allocated
+ */
+dyn_queue* dyn_queue_new (const dyn_uint size)
+{
+    dyn_queue* q;
+    dyn_uint space = 2;
+    dyn_uint i;
+
+    while (space < size && space < 0x80000000)
+        space <<= 1;
+
+    if (posix_memalign((void**) &q, CACHE_LINE, sizeof(dyn_queue)))
+        return NULL;
+
+    q->cell = (queue_cell*) malloc(space * sizeof(queue_cell));
+    if (!q->cell) {
+        free(q);
+        return NULL;
+    }
+
+    for (i=0; i<space; ++i) {
+        q->cell[i].seq = i;
+        DYN_INIT(&q->cell[i].value);
+    }
+
+    q->mask = space - 1;
+    q->closed = DYN_FALSE;
+    q->head = 0;
+    q->tail = 0;
+    q->consumers = 0;
+    q->producers = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+
+    return q;
+}
+
+/**
+ * Frees the queue and all remaining elements, no other thread may access it.
+ *
+ * @param[in, out] q
+ */
+void dyn_queue_free (dyn_queue* q)
+{
+    dyn_uint i;
+
+    for (i=0; i<=q->mask; ++i)
+        dyn_free(&q->cell[i].value);
+
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->cell);
+    free(q);
+}
+
+/**
+ * Reserves up to n consecutive cells at pos, which are marked with seq equal
+ * to pos + offset (0 for producers, 1 for consumers).
+ *
+ * @returns the first reserved position, the number of cells is stored in n,
+ *          which is 0 if the queue is full or empty
+ */
+static dyn_uint reserve (dyn_queue* q, dyn_uint* pos, dyn_uint* n,
+                         const dyn_uint offset)
+{
+    dyn_uint p = __atomic_load_n(pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        dyn_uint k = 0;
+
+        while (k < *n) {
+            dyn_uint seq = __atomic_load_n(&q->cell[(p + k) & q->mask].seq,
+                                           __ATOMIC_SEQ_CST);
+            int diff = (int) (seq - (p + k + offset));
+            if (diff)
+                break;
+            ++k;
+        }
+
+        if (!k) {
+            dyn_uint seq = __atomic_load_n(&q->cell[p & q->mask].seq,
+                                           __ATOMIC_SEQ_CST);
+            // the cell is still used by the previous round
+            if ((int) (seq - (p + offset)) < 0) {
+                *n = 0;
+                return p;
+            }
+            // another thread was faster
+            p = __atomic_load_n(pos, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if (__atomic_compare_exchange_n(pos, &p, p + k, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *n = k;
+            return p;
+        }
+    }
+}
+
+//! Wakes sleeping threads, only if there are some
+static void wake (dyn_queue* q, dyn_uint* sleeping, pthread_cond_t* cond)
+{
+    if (__atomic_load_n(sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&q->lock);
+        pthread_cond_broadcast(cond);
+        pthread_mutex_unlock(&q->lock);
+    }
+}
+
+static dyn_uint push (dyn_queue* q, dyn_c* array, const dyn_uint n)
+{
+    dyn_uint k = n, i;
+
+    if (!n || __atomic_load_n(&q->closed, __ATOMIC_ACQUIRE))
+        return 0;
+
+    dyn_uint p = reserve(q, &q->head, &k, 0);
+
+    for (i=0; i<k; ++i) {
+        queue_cell* cell = &q->cell[(p + i) & q->mask];
+        DYN_MOVE(&array[i], &cell->value);
+        __atomic_store_n(&cell->seq, p + i + 1, __ATOMIC_SEQ_CST);
+    }
+
+    return k;
+}
+
+static dyn_uint pop (dyn_queue* q, dyn_c* array, const dyn_uint n)
+{
+    dyn_uint k = n, i;
+
+    if (!n)
+        return 0;
+
+    dyn_uint p = reserve(q, &q->tail, &k, 1);
+
+    for (i=0; i<k; ++i) {
+        queue_cell* cell = &q->cell[(p + i) & q->mask];
+        dyn_free(&array[i]);
+        DYN_MOVE(&cell->value, &array[i]);
+        __atomic_store_n(&cell->seq, p + i + q->mask + 1, __ATOMIC_SEQ_CST);
+    }
+
+    return k;
+}
+
+/**
+ * Moves up to n elements to the end of the queue, without blocking. The moved
+ * elements are of type NONE afterwards, all others remain unchanged.
+ *
+ * @param[in, out] q
+ * @param[in, out] array elements to move
+ * @param[in] n number of elements
+ *
+ * @returns the number of moved elements from the beginning of array, 0 if the
+ *          queue is full or closed
+ */
+dyn_uint dyn_queue_push_array (dyn_queue* q, dyn_c* array, const dyn_uint n)
+{
+    dyn_uint k = push(q, array, n);
+
+    if (k)
+        wake(q, &q->consumers, &q->not_empty);
+
+    return k;
+}
+
+/**
+ * Moves up to n elements from the front of the queue into array, without
+ * blocking. Previous elements of array are freed.
+ *
+ * @param[in, out] q
+ * @param[out] array for the elements
+ * @param[in] n maximal number of elements
+ *
+ * @returns the number of elements, 0 if the queue is empty
+ */
+dyn_uint dyn_queue_pop_array (dyn_queue* q, dyn_c* array, const dyn_uint n)
+{
+    dyn_uint k = pop(q, array, n);
+
+    if (k)
+        wake(q, &q->producers, &q->not_full);
+
+    return k;
+}
+
+/**
+ * Moves an element to the end of the queue, without blocking.
+ *
+ * @param[in, out] q
+ * @param[in, out] value element to move, NONE afterwards
+ *
+ * @retval DYN_TRUE   if value was moved
+ * @retval DYN_FALSE  if the queue is full or closed, value remains unchanged
+ */
+trilean dyn_queue_push (dyn_queue* q, dyn_c* value)
+{
+    return dyn_queue_push_array(q, value, 1) ? DYN_TRUE : DYN_FALSE;
+}
+
+/**
+ * Moves the first element of the queue into value, without blocking.
+ *
+ * @param[in, out] q
+ * @param[out] value for the element, previous content is freed
+ *
+ * @retval DYN_TRUE   if an element was moved
+ * @retval DYN_FALSE  if the queue is empty
+ */
+trilean dyn_queue_pop (dyn_queue* q, dyn_c* value)
+{
+    return dyn_queue_pop_array(q, value, 1) ? DYN_TRUE : DYN_FALSE;
+}
+
+/**
+ * Repeats op until at least one element was transferred, first spinning, then
+ * sleeping on cond, until the queue is closed. Afterwards, the threads that
+ * wait for the opposite direction are woken up.
+ */
+static dyn_uint queue_wait (dyn_queue* q,
+                            dyn_uint (*op)(dyn_queue*, dyn_c*, const dyn_uint),
+                            dyn_c* array, const dyn_uint n,
+                            dyn_uint* sleeping, pthread_cond_t* cond,
+                            dyn_uint* other, pthread_cond_t* other_cond)
+{
+    dyn_uint i, k = 0;
+
+    for (i=0; i<QUEUE_SPIN && !k; ++i) {
+        k = op(q, array, n);
+        if (__atomic_load_n(&q->closed, __ATOMIC_ACQUIRE))
+            break;
+    }
+
+    if (!k) {
+        pthread_mutex_lock(&q->lock);
+        // the counter has to be visible, before the queue is checked again
+        __atomic_add_fetch(sleeping, 1, __ATOMIC_SEQ_CST);
+        while (!(k = op(q, array, n)) && !__atomic_load_n(&q->closed, __ATOMIC_ACQUIRE))
+            pthread_cond_wait(cond, &q->lock);
+        __atomic_sub_fetch(sleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&q->lock);
+    }
+
+    if (k)
+        wake(q, other, other_cond);
+
+    return k;
+}
+
+/**
+ * Moves up to n elements to the end of the queue, blocks until at least one
+ * element fits into the queue.
+ *
+ * @returns the number of moved elements, 0 only if the queue was closed
+ */
+dyn_uint dyn_queue_push_array_wait (dyn_queue* q, dyn_c* array, const dyn_uint n)
+{
+    return n ? queue_wait(q, push, array, n, &q->producers, &q->not_full,
+                                          &q->consumers, &q->not_empty)
+             : 0;
+}
+
+/**
+ * Moves up to n elements from the front of the queue, blocks until at least
+ * one element is available.
+ *
+ * @returns the number of elements, 0 only if the queue was closed and empty
+ */
+dyn_uint dyn_queue_pop_array_wait (dyn_queue* q, dyn_c* array, const dyn_uint n)
+{
+    return n ? queue_wait(q, pop, array, n, &q->consumers, &q->not_empty,
+                                         &q->producers, &q->not_full)
+             : 0;
+}
+
+/**
+ * Same as dyn_queue_push, but blocks while the queue is full.
+ *
+ * @retval DYN_TRUE   if value was moved
+ * @retval DYN_FALSE  if the queue was closed, value remains unchanged
+ */
+trilean dyn_queue_push_wait (dyn_queue* q, dyn_c* value)
+{
+    return dyn_queue_push_array_wait(q, value, 1) ? DYN_TRUE : DYN_FALSE;
+}
+
+/**
+ * Same as dyn_queue_pop, but blocks while the queue is empty.
+ *
+ * @retval DYN_TRUE   if an element was moved
+ * @retval DYN_FALSE  if the queue was closed and is empty
+ */
+trilean dyn_queue_pop_wait (dyn_queue* q, dyn_c* value)
+{
+    return dyn_queue_pop_array_wait(q, value, 1) ? DYN_TRUE : DYN_FALSE;
+}
+
+/**
+ * Closes the queue, all following pushes fail and blocked threads wake up.
+ * Consumers can still pop the remaining elements.
+ *
+ * @param[in, out] q
+ */
+void dyn_queue_close (dyn_queue* q)
+{
+    pthread_mutex_lock(&q->lock);
+    __atomic_store_n(&q->closed, DYN_TRUE, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * @param[in] q
+ *
+ * @returns the number of elements within the queue, which is only a snapshot,
+ *          if other threads change the queue concurrently
+ */
+dyn_uint dyn_queue_len (dyn_queue* q)
+{
+    dyn_uint tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    dyn_uint head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+
+    return (int) (head - tail) > 0 ? head - tail : 0;
+}
+
+#endif
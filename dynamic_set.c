@@ -29,7 +29,7 @@
 trilean dyn_set_set_len (dyn_c* dyn, const dyn_ushort len)
 {
     if (dyn_set_list_len(dyn, len)) {
-        dyn->type = SET;
+        DYN_SET_TYPE(dyn, SET);
         return DYN_TRUE;
     }
     return DYN_FALSE;
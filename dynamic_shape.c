@@ -0,0 +1,294 @@
+/**
+ *  @file dynamic_shape.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of shared dictionary layouts (shapes).
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+
+/**
+ * The transition tree is shared by all threads, it is only changed while the
+ * lock is held. Reference counters are changed atomically, the last reference
+ * is released with the lock held, such that shapes within the tree are alive.
+ * Copying or freeing dictionaries with shared shapes is thus lock-free.
+ */
+#ifndef TARGET_ARDUNINO
+#include <pthread.h>
+static pthread_mutex_t shape_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK()      pthread_mutex_lock(&shape_lock)
+#define UNLOCK()    pthread_mutex_unlock(&shape_lock)
+#else
+#define LOCK()
+#define UNLOCK()
+#endif
+
+//! Shape of all empty dictionaries, root of the transition tree
+static dyn_shape root = { NULL, NULL, NULL, 1, 1, 0, 0, 0 };
+
+//! Last assigned shape id, 0 is never used
+static dyn_uint last_id = 1;
+
+
+/**
+ * Allocates a new shape with the first len keys of shape (whose reference
+ * counters are increased) and space for at least one additional key.
+ */
+static dyn_shape* shape_new (const dyn_shape* shape, const dyn_ushort len,
+                             const dyn_ushort space)
+{
+    dyn_shape* s = (dyn_shape*) malloc(sizeof(dyn_shape));
+
+    if (s) {
+        s->key = (dyn_str*) malloc(space * sizeof(dyn_str));
+        if (s->key) {
+            dyn_ushort i;
+            for (i=0; i<len; ++i)
+                s->key[i] = dyn_atom_ref(shape->key[i]);
+
+            s->parent = NULL;
+            s->child = NULL;
+            s->id = ++last_id;
+            s->refs = 1;
+            s->length = len;
+            s->space = space;
+            s->children = 0;
+            return s;
+        }
+        free(s);
+    }
+    return NULL;
+}
+
+//! Releases a shape, the global lock has to be held
+static void shape_free (dyn_shape* shape)
+{
+    while (shape != &root &&
+           !__atomic_sub_fetch(&shape->refs, 1, __ATOMIC_ACQ_REL)) {
+        dyn_shape* parent = shape->parent;
+
+        while (shape->length)
+            dyn_atom_free(shape->key[--shape->length]);
+        free(shape->key);
+        free(shape->child);
+
+        if (parent) {
+            dyn_ushort i;
+            for (i=0; parent->child[i] != shape; ++i);
+            parent->child[i] = parent->child[--parent->children];
+        }
+
+        free(shape);
+        // the child held a reference onto its parent
+        shape = parent ? parent : &root;
+    }
+}
+
+/**
+ * Returns the shape for dictionaries without any keys, which is never freed.
+ *
+ * @returns the root of all shapes
+ */
+dyn_shape* dyn_shape_empty (void)
+{
+    return &root;
+}
+
+/**
+ * Increases the reference counter of a shape, which is shared by another
+ * dictionary afterwards.
+ *
+ * @param[in, out] shape
+ *
+ * @returns shape
+ */
+dyn_shape* dyn_shape_ref (dyn_shape* shape)
+{
+    if (shape != &root)
+        __atomic_add_fetch(&shape->refs, 1, __ATOMIC_RELAXED);
+
+    return shape;
+}
+
+/**
+ * Decreases the reference counter of a shape. Unused shapes are freed and
+ * removed from the transition tree, which also releases their parents.
+ *
+ * @param[in, out] shape
+ */
+void dyn_shape_free (dyn_shape* shape)
+{
+    if (shape == &root)
+        return;
+
+    // only the last reference requires the lock
+    dyn_uint refs = __atomic_load_n(&shape->refs, __ATOMIC_RELAXED);
+    while (refs > 1)
+        if (__atomic_compare_exchange_n(&shape->refs, &refs, refs - 1, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+
+    LOCK();
+    shape_free(shape);
+    UNLOCK();
+}
+
+/**
+ * Returns the shape with an additional key at the end. For shared shapes,
+ * the transition tree is searched for an existing child with this key, thus
+ * dictionaries that are filled in the same order share the same shape. Shapes
+ * with more than SHAPE_MAX keys are private and are extended in place, as long
+ * as they are not shared by another dictionary (copy on write).
+ *
+ * The reference of the caller onto shape is passed to the returned shape,
+ * only if NULL is returned, the caller still owns shape.
+ *
+ * @param[in, out] shape current layout
+ * @param[in] key C string, which is interned, see dyn_atom
+ *
+ * @returns the new shape or NULL, if no memory could be allocated
+ */
+dyn_shape* dyn_shape_add (dyn_shape* shape, dyn_const_str key)
+{
+    dyn_str atom = dyn_atom(key);
+    dyn_shape* s = NULL;
+    dyn_ushort i;
+
+    if (!atom)
+        return NULL;
+
+    LOCK();
+    if (shape != &root && !shape->parent) {
+        // private shape
+        if (__atomic_load_n(&shape->refs, __ATOMIC_ACQUIRE) == 1) {
+            if (shape->length == shape->space) {
+                dyn_str* k = (dyn_str*) realloc(shape->key, (shape->space + DICT_DEFAULT)
+                                                            * sizeof(dyn_str));
+                if (!k)
+                    goto GOTO__ERROR;
+                shape->key = k;
+                shape->space += DICT_DEFAULT;
+            }
+            shape->key[shape->length++] = atom;
+            shape->id = ++last_id;
+            UNLOCK();
+            return shape;
+        }
+    } else if (shape->length < SHAPE_MAX) {
+        // follow or create a transition
+        for (i=0; i<shape->children; ++i) {
+            s = shape->child[i];
+            if (s->key[shape->length] == atom) {
+                __atomic_add_fetch(&s->refs, 1, __ATOMIC_RELAXED);
+                dyn_atom_free(atom);
+                goto GOTO__RELEASE;
+            }
+        }
+
+        dyn_shape** child = (dyn_shape**) realloc(shape->child,
+                                                  (shape->children + 1) * sizeof(dyn_shape*));
+        if (!child)
+            goto GOTO__ERROR;
+        shape->child = child;
+
+        s = shape_new(shape, shape->length, shape->length + 1);
+        if (!s)
+            goto GOTO__ERROR;
+
+        s->key[s->length++] = atom;
+        s->parent = shape;
+        shape->child[shape->children++] = s;
+        if (shape != &root)
+            __atomic_add_fetch(&shape->refs, 1, __ATOMIC_RELAXED);
+
+        goto GOTO__RELEASE;
+    }
+
+    // create a new private shape
+    s = shape_new(shape, shape->length, shape->length + DICT_DEFAULT);
+    if (!s)
+        goto GOTO__ERROR;
+    s->key[s->length++] = atom;
+
+GOTO__RELEASE:
+    shape_free(shape);
+    UNLOCK();
+    return s;
+
+GOTO__ERROR:
+    UNLOCK();
+    dyn_atom_free(atom);
+    return NULL;
+}
+
+/**
+ * Returns the shape without the key at position i, the last key is moved to
+ * position i, as done by dyn_dict_remove. The reference of the caller is
+ * passed as in dyn_shape_add.
+ *
+ * @param[in, out] shape current layout
+ * @param[in] i position of the key to remove
+ *
+ * @returns the new shape or NULL, if no memory could be allocated
+ */
+dyn_shape* dyn_shape_remove (dyn_shape* shape, const dyn_ushort i)
+{
+    dyn_ushort len = shape->length - 1;
+    dyn_ushort j;
+
+    LOCK();
+    if (!shape->parent && shape != &root &&
+        __atomic_load_n(&shape->refs, __ATOMIC_ACQUIRE) == 1) {
+        dyn_atom_free(shape->key[i]);
+        shape->key[i] = shape->key[len];
+        shape->length = len;
+        shape->id = ++last_id;
+        UNLOCK();
+        return shape;
+    }
+    UNLOCK();
+
+    // rebuild the new order of keys, starting from the empty shape
+    dyn_shape* s = &root;
+    for (j=0; j<len && s; ++j) {
+        dyn_shape* next = dyn_shape_add(s, shape->key[j == i ? len : j]);
+        if (!next)
+            dyn_shape_free(s);
+        s = next;
+    }
+
+    if (s)
+        dyn_shape_free(shape);
+
+    return s;
+}
+
+/**
+ * Searches a shape for an interned key, by comparing addresses only.
+ *
+ * @param[in] shape
+ * @param[in] atom interned C string, see dyn_atom
+ *
+ * @retval 0 if the key was not found
+ * @retval position+1 otherwise
+ */
+dyn_ushort dyn_shape_has_atom (const dyn_shape* shape, dyn_const_str atom)
+{
+    dyn_str* key = shape->key;
+    dyn_ushort i;
+
+    for (i=0; i<shape->length; ++i)
+        if (key[i] == atom)
+            return i+1;
+
+    return 0;
+}
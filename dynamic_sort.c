@@ -0,0 +1,412 @@
+/**
+ *  @file dynamic_sort.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of dynamiC list sorting.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+
+#define DEREF(X)  (DYN_IS_REFERENCE(X) ? DYN_DATA(X, ref) : (X))
+
+#define SWAP(A, B) { dyn_c t = A; A = B; B = t; }
+
+//! sequences up to this length are sorted with insertion sort
+#define SORT_SMALL  16
+
+typedef int (*sort_cmp) (const dyn_c* a, const dyn_c* b, const void* ctx);
+
+
+/**
+ * Order of types, that cannot be compared with dyn_op_cmp, all numeric types
+ * share the same rank.
+ */
+static dyn_char type_rank (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+        case NONE:      return 0;
+        case BOOL:
+        case INTEGER:
+        case FLOAT:     return 1;
+    }
+    return DYN_TYPE(dyn);
+}
+
+static int is_nan (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == FLOAT && DYN_DATA(dyn, f) != DYN_DATA(dyn, f);
+}
+
+/**
+ * Total order, derived from dyn_op_cmp. Elements which are not comparable,
+ * due to different types, are ordered by type (NONE < numeric < STRING < LIST
+ * < SET < DICT < ...). Sets that are no subsets of each other, as well as all
+ * other types without a natural order are ordered by length and hash value.
+ * NaN is larger than all other numeric values.
+ */
+static int total_cmp (const dyn_c* a, const dyn_c* b, const void* ctx)
+{
+    a = DEREF(a);
+    b = DEREF(b);
+
+    if (is_nan(a) || is_nan(b))
+        return is_nan(a) - is_nan(b);
+
+    switch (dyn_op_cmp(a, b)) {
+        case DYN_CMP_EQ:    return  0;
+        case DYN_CMP_LT:    return -1;
+        case DYN_CMP_GT:    return  1;
+    }
+
+    dyn_char ra = type_rank(a);
+    dyn_char rb = type_rank(b);
+    if (ra != rb)
+        return ra < rb ? -1 : 1;
+
+    if (DYN_TYPE(a) == LIST) {
+        // equal length, but elements not comparable
+        dyn_ushort i;
+        int r;
+        for (i=0; i<DYN_LIST_LEN(a); ++i) {
+            r = total_cmp(DYN_LIST_GET_REF(a, i), DYN_LIST_GET_REF(b, i), ctx);
+            if (r)
+                return r;
+        }
+        return 0;
+    }
+
+    if (dyn_length(a) != dyn_length(b))
+        return dyn_length(a) < dyn_length(b) ? -1 : 1;
+
+    dyn_uint ha = dyn_hash(a);
+    dyn_uint hb = dyn_hash(b);
+    return ha < hb ? -1 : (ha > hb ? 1 : 0);
+}
+
+static int string_cmp (const dyn_c* a, const dyn_c* b, const void* ctx)
+{
+    return dyn_strcmp(DYN_DATA(a, str), DYN_DATA(b, str));
+}
+
+/**
+ * Compares the values of two dictionaries stored under the same key (ctx),
+ * elements that are no dictionaries or do not contain the key are treated as
+ * NONE.
+ */
+static int key_cmp (const dyn_c* a, const dyn_c* b, const void* ctx)
+{
+    dyn_c none;
+    DYN_INIT(&none);
+
+    const dyn_c* va = NULL;
+    const dyn_c* vb = NULL;
+
+    a = DEREF(a);
+    b = DEREF(b);
+
+    if (DYN_TYPE(a) == DICT)
+        va = dyn_dict_get(a, (dyn_const_str) ctx);
+    if (DYN_TYPE(b) == DICT)
+        vb = dyn_dict_get(b, (dyn_const_str) ctx);
+
+    return total_cmp(va ? va : &none, vb ? vb : &none, NULL);
+}
+
+static void insertion_sort (dyn_c* a, const dyn_uint n, sort_cmp cmp, const void* ctx)
+{
+    dyn_uint i, j;
+    dyn_c tmp;
+
+    for (i=1; i<n; ++i) {
+        tmp = a[i];
+        for (j=i; j>0 && cmp(&tmp, &a[j-1], ctx) < 0; --j)
+            a[j] = a[j-1];
+        a[j] = tmp;
+    }
+}
+
+static void sift_down (dyn_c* a, dyn_uint i, const dyn_uint n, sort_cmp cmp, const void* ctx)
+{
+    dyn_uint child;
+
+    while ((child = 2*i + 1) < n) {
+        if (child + 1 < n && cmp(&a[child], &a[child+1], ctx) < 0)
+            ++child;
+        if (cmp(&a[i], &a[child], ctx) >= 0)
+            return;
+        SWAP(a[i], a[child]);
+        i = child;
+    }
+}
+
+static void heap_sort (dyn_c* a, dyn_uint n, sort_cmp cmp, const void* ctx)
+{
+    dyn_uint i = n / 2;
+
+    while (i--)
+        sift_down(a, i, n, cmp, ctx);
+
+    while (--n) {
+        SWAP(a[0], a[n]);
+        sift_down(a, 0, n, cmp, ctx);
+    }
+}
+
+/**
+ * Introspective sort, quicksort with a median of three pivot that switches to
+ * heap sort, if the recursion gets too deep, and to insertion sort for small
+ * partitions. Only the smaller partition is sorted recursively.
+ */
+static void intro_sort (dyn_c* a, dyn_uint n, dyn_uint depth, sort_cmp cmp, const void* ctx)
+{
+    while (n > SORT_SMALL) {
+        if (!depth--) {
+            heap_sort(a, n, cmp, ctx);
+            return;
+        }
+
+        dyn_uint m = n / 2;
+        if (cmp(&a[m], &a[0], ctx) < 0)
+            SWAP(a[m], a[0]);
+        if (cmp(&a[n-1], &a[0], ctx) < 0)
+            SWAP(a[n-1], a[0]);
+        if (cmp(&a[n-1], &a[m], ctx) < 0)
+            SWAP(a[n-1], a[m]);
+        SWAP(a[0], a[m]);
+
+        dyn_uint i = 0;
+        dyn_uint j = n;
+        for (;;) {
+            do ++i; while (i < n && cmp(&a[i], &a[0], ctx) < 0);
+            do --j; while (j > 0 && cmp(&a[0], &a[j], ctx) < 0);
+            if (i >= j)
+                break;
+            SWAP(a[i], a[j]);
+        }
+        SWAP(a[0], a[j]);
+
+        if (j < n - j - 1) {
+            intro_sort(a, j, depth, cmp, ctx);
+            a += j + 1;
+            n -= j + 1;
+        } else {
+            intro_sort(a + j + 1, n - j - 1, depth, cmp, ctx);
+            n = j;
+        }
+    }
+
+    insertion_sort(a, n, cmp, ctx);
+}
+
+/**
+ * Bottom-up merge sort, runs of SORT_SMALL elements are sorted with insertion
+ * sort first, afterwards they are merged alternating between a and buffer.
+ */
+static trilean merge_sort (dyn_c* a, const dyn_uint n, sort_cmp cmp, const void* ctx)
+{
+    dyn_uint i, width;
+
+    for (i=0; i<n; i+=SORT_SMALL)
+        insertion_sort(&a[i], n-i < SORT_SMALL ? n-i : SORT_SMALL, cmp, ctx);
+
+    if (n <= SORT_SMALL)
+        return DYN_TRUE;
+
+    dyn_c* buffer = (dyn_c*) malloc(n * sizeof(dyn_c));
+    if (!buffer)
+        return DYN_FALSE;
+
+    dyn_c* from = a;
+    dyn_c* to = buffer;
+
+    for (width=SORT_SMALL; width<n; width*=2) {
+        for (i=0; i<n; i+=2*width) {
+            dyn_uint l = i;
+            dyn_uint m = i + width < n ? i + width : n;
+            dyn_uint r = i + 2*width < n ? i + 2*width : n;
+            dyn_uint k = i;
+            dyn_uint j = m;
+
+            while (l < m && j < r)
+                to[k++] = cmp(&from[j], &from[l], ctx) < 0 ? from[j++] : from[l++];
+            while (l < m)
+                to[k++] = from[l++];
+            while (j < r)
+                to[k++] = from[j++];
+        }
+        dyn_c* tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    if (from != a)
+        memcpy(a, from, n * sizeof(dyn_c));
+
+    free(buffer);
+    return DYN_TRUE;
+}
+
+/**
+ * Radix keys preserve the order of the numeric values as unsigned integers,
+ * for floats the sign bit is flipped for positive values and all bits for
+ * negative values (-0.0 is treated as 0.0). All NaNs share the key of a
+ * positive quiet NaN, such that they are ordered last as in total_cmp.
+ */
+static dyn_uint radix_key (const dyn_c* dyn)
+{
+    if (DYN_TYPE(dyn) == INTEGER)
+        return (dyn_uint) DYN_DATA(dyn, i) ^ 0x80000000u;
+
+    union { dyn_float f; dyn_uint u; } v = { DYN_DATA(dyn, f) };
+    if (v.f == 0.0f)
+        v.u = 0;
+    else if (v.f != v.f)
+        v.u = 0x7FC00000u;
+
+    return (v.u & 0x80000000u) ? ~v.u : v.u | 0x80000000u;
+}
+
+/**
+ * Stable least significant digit radix sort for lists that contain only
+ * INTEGER or only FLOAT values, 4 passes of 8 bit each, passes where all
+ * elements share the same byte are skipped.
+ */
+static trilean radix_sort (dyn_c* a, const dyn_uint n)
+{
+    dyn_c* buffer = (dyn_c*) malloc(n * sizeof(dyn_c));
+    if (!buffer)
+        return DYN_FALSE;
+
+    dyn_c* from = a;
+    dyn_c* to = buffer;
+    dyn_uint count[256];
+    dyn_uint shift, i;
+
+    for (shift=0; shift<32; shift+=8) {
+        for (i=0; i<256; ++i)
+            count[i] = 0;
+        for (i=0; i<n; ++i)
+            count[(radix_key(&from[i]) >> shift) & 0xFF]++;
+
+        if (count[(radix_key(&from[0]) >> shift) & 0xFF] == n)
+            continue;
+
+        dyn_uint sum = 0, c;
+        for (i=0; i<256; ++i) {
+            c = count[i];
+            count[i] = sum;
+            sum += c;
+        }
+        for (i=0; i<n; ++i)
+            to[count[(radix_key(&from[i]) >> shift) & 0xFF]++] = from[i];
+
+        dyn_c* tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    if (from != a)
+        memcpy(a, from, n * sizeof(dyn_c));
+
+    free(buffer);
+    return DYN_TRUE;
+}
+
+static trilean sort (dyn_c* a, const dyn_uint n, sort_cmp cmp, const void* ctx,
+                     const trilean stable)
+{
+    if (stable)
+        return merge_sort(a, n, cmp, ctx);
+
+    dyn_uint depth = 0, i;
+    for (i=n; i; i>>=1)
+        depth += 2;
+
+    intro_sort(a, n, depth, cmp, ctx);
+    return DYN_TRUE;
+}
+
+/**
+ * Sorts all elements of a list (or set) in place in ascending order, elements
+ * are only moved and never copied. The order is derived from dyn_op_cmp, types
+ * that cannot be compared are ordered by their type, see the code below. Lists
+ * that contain only INTEGER or only FLOAT values are sorted with radix sort,
+ * lists with only STRING values are compared directly by dyn_strcmp. All other
+ * lists are sorted with introsort (unstable) or merge sort (stable).
+ *
+ * @code
+ * // pseudo code
+ * dyn_list_sort([3,"b",1.5,None,[1],"a"]) == [None,1.5,3,"a","b",[1]]
+ * @endcode
+ *
+ * @param[in, out] list input has to be of type LIST or SET
+ * @param[in] stable if DYN_TRUE, the order of equal elements is preserved
+ *
+ * @retval DYN_TRUE   if the list was sorted
+ * @retval DYN_FALSE  if it is not a list or memory could not be allocated
+ */
+trilean dyn_list_sort (dyn_c* list, const trilean stable)
+{
+    if (DYN_TYPE(list) != LIST && DYN_TYPE(list) != SET)
+        return DYN_FALSE;
+
+    dyn_ushort n = DYN_LIST_LEN(list);
+    if (n < 2)
+        return DYN_TRUE;
+
+    dyn_c* a = DYN_LIST_GET_REF(list, 0);
+    dyn_char type = DYN_TYPE(&a[0]);
+    dyn_ushort i;
+
+    for (i=1; i<n; ++i)
+        if (DYN_TYPE(&a[i]) != type)
+            break;
+
+    if (i == n) {
+        switch (type) {
+            case INTEGER:
+            case FLOAT:
+                if (n > SORT_SMALL)
+                    return radix_sort(a, n);
+                break;
+            case STRING:
+                return sort(a, n, string_cmp, NULL, stable);
+        }
+    }
+
+    return sort(a, n, total_cmp, NULL, stable);
+}
+
+/**
+ * Sorts a list of dictionaries in place by the values stored at key, the
+ * values are compared in the same way as in dyn_list_sort. Elements that are
+ * not of type DICT or that do not contain key are treated as NONE and are
+ * thus moved to the front.
+ *
+ * @param[in, out] list input has to be of type LIST or SET
+ * @param[in] key to compare
+ * @param[in] stable if DYN_TRUE, the order of equal elements is preserved
+ *
+ * @retval DYN_TRUE   if the list was sorted
+ * @retval DYN_FALSE  if it is not a list or memory could not be allocated
+ */
+trilean dyn_list_sort_key (dyn_c* list, dyn_const_str key, const trilean stable)
+{
+    if (DYN_TYPE(list) != LIST && DYN_TYPE(list) != SET)
+        return DYN_FALSE;
+
+    dyn_ushort n = DYN_LIST_LEN(list);
+    if (n < 2)
+        return DYN_TRUE;
+
+    return sort(DYN_LIST_GET_REF(list, 0), n, key_cmp, key, stable);
+}
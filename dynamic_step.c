@@ -0,0 +1,483 @@
+/**
+ *  @file dynamic_step.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of resumable string conversion, copy, and encoding,
+ *         which are processed in steps with a bounded number of elements.
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+#include <string.h>
+
+//! Initial number of frames and bytes of the output buffer
+#define STEP_FRAMES 16
+#define STEP_BUFFER 64
+
+enum {
+    STEP_STRING,
+    STEP_COPY,
+    STEP_ENCODE
+};
+
+//! Container that is currently traversed
+typedef struct {
+    const dyn_c* node;      //!< LIST, SET, or DICT
+    const dyn_c* src;       //!< elements of node
+    dyn_c*       dst;       //!< elements of the copy (STEP_COPY only)
+    dyn_ushort   i;         //!< next element
+    dyn_ushort   n;         //!< number of elements
+} step_frame;
+
+struct dynamic_step {
+    dyn_ushort   kind;
+    trilean      state;     //!< DYN_NONE while running, DYN_TRUE, or DYN_FALSE
+    const dyn_c* root;      //!< element to start with, NULL afterwards
+
+    step_frame*  frame;
+    dyn_uint     depth;
+    dyn_uint     space;
+
+    dyn_c*       copy;      //!< result of STEP_COPY
+    dyn_char*    buffer;    //!< result of STEP_STRING and STEP_ENCODE
+    dyn_uint     length;
+    dyn_uint     size;
+    dyn_char**   result;
+    dyn_uint*    result_length;
+};
+
+
+//! Elements of a LIST, SET, or DICT, the list that stores the values of a DICT
+static dyn_list* elements (const dyn_c* dyn)
+{
+    return DYN_TYPE(dyn) == DICT ? DYN_DATA(&DYN_DATA(dyn, dict)->value, list)
+                                 : DYN_DATA(dyn, list);
+}
+
+static trilean is_container (const dyn_c* dyn)
+{
+    switch (DYN_TYPE(dyn)) {
+#ifdef S2_SET
+        case SET:
+#endif
+        case LIST:
+        case DICT:  return DYN_TRUE;
+    }
+    return DYN_FALSE;
+}
+
+static dyn_step* step_new (const dyn_ushort kind, const dyn_c* dyn)
+{
+    dyn_step* step = (dyn_step*) malloc(sizeof(dyn_step));
+    if (!step)
+        return NULL;
+
+    step->frame = (step_frame*) malloc(STEP_FRAMES * sizeof(step_frame));
+    if (!step->frame) {
+        free(step);
+        return NULL;
+    }
+
+    step->kind = kind;
+    step->state = DYN_NONE;
+    step->root = dyn;
+    step->depth = 0;
+    step->space = STEP_FRAMES;
+    step->copy = NULL;
+    step->buffer = NULL;
+    step->length = 0;
+    step->size = 0;
+    step->result = NULL;
+    step->result_length = NULL;
+
+    return step;
+}
+
+//! Returns a new frame for the elements of node, or NULL on failure
+static step_frame* push (dyn_step* step, const dyn_c* node)
+{
+    if (step->depth == step->space) {
+        step_frame* tmp = (step_frame*) realloc(step->frame,
+                                                2 * step->space * sizeof(step_frame));
+        if (!tmp) {
+            step->state = DYN_FALSE;
+            return NULL;
+        }
+        step->frame = tmp;
+        step->space *= 2;
+    }
+
+    step_frame* f = &step->frame[step->depth++];
+    f->node = node;
+    f->src = elements(node)->container;
+    f->dst = NULL;
+    f->i = 0;
+    f->n = elements(node)->length;
+
+    return f;
+}
+
+//! Returns space for n more bytes at the end of the buffer, or NULL
+static dyn_char* reserve (dyn_step* step, const dyn_uint n)
+{
+    if (step->length + n > step->size) {
+        dyn_uint size = step->size ? step->size : STEP_BUFFER;
+        while (step->length + n > size)
+            size *= 2;
+
+        dyn_char* tmp = (dyn_char*) realloc(step->buffer, size);
+        if (!tmp) {
+            step->state = DYN_FALSE;
+            return NULL;
+        }
+        step->buffer = tmp;
+        step->size = size;
+    }
+
+    return &step->buffer[step->length];
+}
+
+static void append (dyn_step* step, const void* data, const dyn_uint n)
+{
+    dyn_char* p = reserve(step, n);
+    if (p) {
+        memcpy(p, data, n);
+        step->length += n;
+    }
+}
+
+static void append_str (dyn_step* step, dyn_const_str str)
+{
+    append(step, str, dyn_strlen(str));
+}
+
+/**
+ * Appends the string representation of an element, for elements of a parent
+ * container prefixed with a comma and the key of a DICT, as dyn_string_add.
+ */
+static void string_node (dyn_step* step, const dyn_c* dyn, step_frame* parent)
+{
+    if (parent) {
+        if (parent->i)
+            append_str(step, ",");
+        if (DYN_TYPE(parent->node) == DICT) {
+            append_str(step, DYN_DICT_GET_I_KEY(parent->node, parent->i));
+            append_str(step, ":");
+        }
+    }
+
+    while (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    if (is_container(dyn)) {
+        append_str(step, DYN_TYPE(dyn) == LIST ? "[" : "{");
+        push(step, dyn);
+        return;
+    }
+
+    dyn_uint len = DYN_TYPE(dyn) == STRING ? dyn_strlen(DYN_DATA(dyn, str))
+                                           : dyn_string_len(dyn);
+    dyn_str p = (dyn_str) reserve(step, len + 1);
+    if (p) {
+        p[0] = '\0';
+        dyn_string_add(dyn, p);
+        step->length += dyn_strlen(p);
+    }
+}
+
+static void string_close (dyn_step* step, const step_frame* f)
+{
+    append_str(step, DYN_TYPE(f->node) == LIST ? "]" : "}");
+}
+
+/**
+ * Copies an element into dst, containers are created as shells with NONE
+ * elements, which are copied afterwards, as within dyn_copy.
+ */
+static void copy_node (dyn_step* step, const dyn_c* dyn, dyn_c* dst)
+{
+    while (DYN_TYPE(dyn) == REFERENCE)
+        dyn = DYN_DATA(dyn, ref);
+
+    if (!is_container(dyn)) {
+        if (!dyn_copy(dyn, dst))
+            step->state = DYN_FALSE;
+        return;
+    }
+
+    dyn_ushort len = elements(dyn)->length;
+    if (DYN_TYPE(dyn) == DICT) {
+        if (!dyn_set_dict(dst, len)) {
+            step->state = DYN_FALSE;
+            return;
+        }
+        DYN_DATA(dst, dict)->shape = dyn_shape_ref(DYN_DATA(dyn, dict)->shape);
+    } else {
+        if (!dyn_set_list_len(dst, len)) {
+            step->state = DYN_FALSE;
+            return;
+        }
+        DYN_SET_TYPE(dst, DYN_TYPE(dyn));
+    }
+    elements(dst)->length = len;
+
+    step_frame* f = push(step, dyn);
+    if (f)
+        f->dst = elements(dst)->container;
+}
+
+/**
+ * Appends the encoding of an element, as done by dyn_encode, nested elements
+ * are followed by the type and length of their container. Elements without
+ * encoding, such as functions, are encoded as NONE.
+ */
+static void encode_node (dyn_step* step, const dyn_c* dyn)
+{
+    dyn_char code;
+
+    while (DYN_IS_REFERENCE(dyn))
+        dyn = DYN_DATA(dyn, ref);
+
+    switch (DYN_TYPE(dyn)) {
+        case BOOL:
+            code = DYN_DATA(dyn, b) ? ENC_TRUE : ENC_FALSE;
+            append(step, &code, 1);
+            return;
+        case INTEGER: {
+            dyn_int v = DYN_DATA(dyn, i);
+            if (v > -128 && v < 127) {
+                dyn_char c = (dyn_char) v;
+                code = ENC_INT1;
+                append(step, &code, 1);
+                append(step, &c, 1);
+            } else if (v > -32768 && v < 32767) {
+                dyn_short s = (dyn_short) v;
+                code = ENC_INT2;
+                append(step, &code, 1);
+                append(step, &s, 2);
+            } else {
+                code = ENC_INT4;
+                append(step, &code, 1);
+                append(step, &v, 4);
+            }
+            return;
+        }
+        case FLOAT: {
+            dyn_float v = DYN_DATA(dyn, f);
+            code = ENC_FLOAT;
+            append(step, &code, 1);
+            append(step, &v, 4);
+            return;
+        }
+        case STRING:
+            code = ENC_STRING;
+            append(step, &code, 1);
+            append(step, DYN_DATA(dyn, str), dyn_strlen(DYN_DATA(dyn, str)) + 1);
+            return;
+#ifdef S2_SET
+        case SET:
+#endif
+        case LIST:
+        case DICT:
+            push(step, dyn);
+            return;
+    }
+
+    code = ENC_NONE;
+    append(step, &code, 1);
+}
+
+static void encode_close (dyn_step* step, const step_frame* f)
+{
+    dyn_char code = DYN_TYPE(f->node) == LIST ? ENC_LIST
+                  : DYN_TYPE(f->node) == DICT ? ENC_DICT
+                                              : ENC_SET;
+    dyn_ushort n = f->n;
+
+    append(step, &code, 1);
+    append(step, &n, 2);
+}
+
+static void visit (dyn_step* step, const dyn_c* dyn, dyn_c* dst, step_frame* parent)
+{
+    switch (step->kind) {
+        case STEP_STRING:   string_node(step, dyn, parent);
+                            break;
+        case STEP_COPY:     copy_node(step, dyn, dst);
+                            break;
+        case STEP_ENCODE:   encode_node(step, dyn);
+    }
+}
+
+//! Hands over the result, the buffer is terminated by '\0' or ENC_HALT
+static void finish (dyn_step* step)
+{
+    dyn_char end = step->kind == STEP_STRING ? '\0' : ENC_HALT;
+
+    if (step->kind != STEP_COPY) {
+        append(step, &end, 1);
+        if (step->state == DYN_FALSE)
+            return;
+
+        *step->result = step->buffer;
+        if (step->result_length)
+            *step->result_length = step->length;
+        step->buffer = NULL;
+    }
+
+    step->state = DYN_TRUE;
+}
+
+/**
+ * Starts a resumable conversion into a string, which equals the result of
+ * dyn_get_string, see dyn_step_run.
+ *
+ * @param[in] dyn element to convert, must not be changed until the step is
+ *                finished or freed
+ * @param[out] string the new string is stored here when finished, it has to be
+ *                    freed afterwards, NULL until then
+ *
+ * @returns the continuation or NULL, if no memory could be allocated
+ */
+dyn_step* dyn_step_string (const dyn_c* dyn, dyn_str* string)
+{
+    dyn_step* step = step_new(STEP_STRING, dyn);
+
+    *string = NULL;
+    if (step)
+        step->result = (dyn_char**) string;
+
+    return step;
+}
+
+/**
+ * Starts a resumable deep copy, the copy is always a valid element that
+ * contains NONE elements at the positions, which were not yet copied.
+ *
+ * @param[in] dyn original element, must not be changed until the step is
+ *                finished or freed
+ * @param[out] copy newly created element, as with dyn_copy
+ *
+ * @returns the continuation or NULL, if no memory could be allocated
+ */
+dyn_step* dyn_step_copy (const dyn_c* dyn, dyn_c* copy)
+{
+    dyn_step* step = step_new(STEP_COPY, dyn);
+
+    if (step)
+        step->copy = copy;
+
+    return step;
+}
+
+/**
+ * Starts a resumable encoding, the result is terminated by ENC_HALT and can be
+ * decoded with dyn_decode_all.
+ *
+ * @param[in] dyn element to encode, must not be changed until the step is
+ *                finished or freed
+ * @param[out] code the new byte array is stored here when finished, it has to
+ *                  be freed afterwards, NULL until then
+ * @param[out] length number of bytes including ENC_HALT, can be NULL
+ *
+ * @returns the continuation or NULL, if no memory could be allocated
+ */
+dyn_step* dyn_step_encode (const dyn_c* dyn, dyn_char** code, dyn_uint* length)
+{
+    dyn_step* step = step_new(STEP_ENCODE, dyn);
+
+    *code = NULL;
+    if (step) {
+        step->result = code;
+        step->result_length = length;
+    }
+
+    return step;
+}
+
+/**
+ * Continues an operation that was started with dyn_step_string, dyn_step_copy,
+ * or dyn_step_encode, at most budget elements are processed per call, such
+ * that the caller is never blocked for long.
+ *
+ * @code
+ * dyn_str str;
+ * dyn_step* step = dyn_step_string(&huge_dict, &str);
+ * while (dyn_step_run(step, 1000) == DYN_NONE)
+ *     handle_events();
+ * dyn_step_free(step);
+ * @endcode
+ *
+ * @param[in, out] step continuation
+ * @param[in] budget maximal number of elements to process
+ *
+ * @retval DYN_TRUE   if the operation is finished and the result was stored
+ * @retval DYN_NONE   if there is still work left
+ * @retval DYN_FALSE  if memory was exhausted, copies are of type NONE
+ */
+trilean dyn_step_run (dyn_step* step, dyn_uint budget)
+{
+    for (;;) {
+        if (step->state != DYN_NONE)
+            break;
+
+        if (step->depth) {
+            step_frame* f = &step->frame[step->depth-1];
+            if (f->i == f->n) {
+                switch (step->kind) {
+                    case STEP_STRING:   string_close(step, f);
+                                        break;
+                    case STEP_ENCODE:   encode_close(step, f);
+                }
+                --step->depth;
+                continue;
+            }
+        } else if (!step->root) {
+            finish(step);
+            break;
+        }
+
+        if (!budget)
+            break;
+        --budget;
+
+        if (step->root) {
+            visit(step, step->root, step->copy, NULL);
+            step->root = NULL;
+        } else {
+            // frames might be moved by visit
+            dyn_uint d = step->depth - 1;
+            step_frame* f = &step->frame[d];
+            visit(step, &f->src[f->i], f->dst ? &f->dst[f->i] : NULL, f);
+            ++step->frame[d].i;
+        }
+    }
+
+    if (step->state == DYN_FALSE && step->copy)
+        dyn_free(step->copy);
+
+    return step->state;
+}
+
+/**
+ * Frees a continuation, an unfinished operation is aborted and its partial
+ * result is freed, a copy that was already started is of type NONE afterwards.
+ *
+ * @param[in, out] step continuation
+ */
+void dyn_step_free (dyn_step* step)
+{
+    if (step->state == DYN_NONE && step->copy && !step->root)
+        dyn_free(step->copy);
+
+    free(step->buffer);
+    free(step->frame);
+    free(step);
+}
@@ -217,3 +217,25 @@ dyn_char dyn_strcmp(dyn_const_str a, dyn_const_str b)
     }
     return (*a - *(b - 1));
 }
+
+/**
+ *  Fowler-Noll-Vo (FNV-1a) hash over all characters of a string, which is used
+ *  to hash elements of type STRING.
+ *
+ *  @see https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+ *
+ *  @param str  C string to hash
+ *
+ *  @returns 32bit hash value
+ */
+dyn_uint dyn_strhash(dyn_const_str str)
+{
+    dyn_uint hash = 2166136261u;
+
+    while (*str) {
+        hash ^= (dyn_byte) *str++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
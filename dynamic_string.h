@@ -44,4 +44,7 @@ dyn_ushort dyn_ftoa_len (const dyn_float f);
 /** @brief Compares the string a to the string b.                             */
 dyn_char    dyn_strcmp   (dyn_const_str a, dyn_const_str b);
 
+/** @brief Calculates a (FNV-1a) hash value for a string.                     */
+dyn_uint    dyn_strhash  (dyn_const_str str);
+
 #endif
@@ -17,6 +17,8 @@
 #ifndef DYNAMIC_TYPES_C_H
 #define DYNAMIC_TYPES_C_H
 
+#include "dynamic_defines.h"
+
 /** @brief basic return type for truth values
  */
 typedef enum {
@@ -84,10 +86,60 @@ typedef struct dynamic_list dyn_list;
 /** @brief common dynamic dictionary data type
  */
 typedef struct dynamic_dict dyn_dict;
+/** @brief shared key layout of dictionaries
+ */
+typedef struct dynamic_shape dyn_shape;
+/** @brief deeply immutable element, shared between threads
+ */
+typedef struct dynamic_frozen dyn_frozen;
+/** @brief concurrent dictionary, requires S2_THREADS
+ */
+typedef struct dynamic_cdict dyn_cdict;
+/** @brief work-stealing thread pool, requires S2_THREADS
+ */
+typedef struct dynamic_pool dyn_pool;
+/** @brief bounded multi-producer multi-consumer queue, requires S2_THREADS
+ */
+typedef struct dynamic_queue dyn_queue;
+/** @brief continuation of a resumable operation
+ */
+typedef struct dynamic_step dyn_step;
+/** @brief tracing garbage collector for shared elements
+ */
+typedef struct dynamic_gc dyn_gc;
+/** @brief memory context with accounting and limit, requires S2_MEMORY
+ */
+typedef struct dynamic_memory dyn_memory;
 /** @brief common dynamic procedure/bytecode data type
  */
 typedef struct dynamic_function dyn_fct;
+/** @brief borrowed view onto a range of list elements
+ */
+typedef struct dynamic_view dyn_view;
+/** @brief iterator over the elements of a container
+ */
+typedef struct dynamic_iter dyn_iter;
+/** @brief depth-first iterator over nested containers
+ */
+typedef struct dynamic_tree_iter dyn_tree_iter;
 
+#ifdef S2_NAN_BOXING
+/**
+ * @brief Tagged 8 byte container for dynamic data types.
+ *
+ * Alternative representation of the basic container, where the type and the
+ * value share one 64bit word. The upper byte stores the TYPE, the lower 56 bits
+ * store the value, which is either a BOOL, INTEGER, FLOAT (32 bit each) or a
+ * pointer. Pointers are therefore required to fit into 56 bits, which is the
+ * case for user space addresses on x86-64 and AArch64.
+ *
+ * The content must only be accessed via the macros DYN_TYPE, DYN_SET_TYPE,
+ * DYN_DATA, and DYN_SET_DATA.
+ */
+struct dynamic {
+    uint64_t box;         //!< type tag (bits 56-63) and payload (bits 0-55)
+};
+#else
 /**
  * @brief Basic container for dynamic data types.
  *
@@ -111,27 +163,130 @@ struct dynamic {
     } data;
     char type;            //!< type definition
 } __attribute__ ((packed));
+#endif
 
 /**
  * @brief Basic container for lists.
  *
- * todo.
+ * The allocated array can contain unused elements in front of container, this
+ * gap is used to push and pop elements at the front of a list in O(1), while
+ * container still points to the first element.
  */
 struct dynamic_list {
      dyn_ushort length;      //!< elements in use
-     dyn_ushort space;       //!< elements available
+     dyn_ushort space;       //!< elements available, starting at container
+     dyn_ushort front;       //!< unused elements allocated before container
      dyn_c      *container;  //!< pointer to an array of dynamic elements
+     dyn_char   dict;        //!< header is part of a dictionary block
+} __attribute__ ((packed));
+
+/**
+ * @brief Borrowed view onto the elements of a list.
+ *
+ * A view does not own any element, it only points into the container of an
+ * existing list. Element i is located at base[i * step]. A view becomes
+ * invalid as soon as the underlying list is changed or freed.
+ */
+struct dynamic_view {
+     dyn_c      *base;       //!< pointer to the first element of the view
+     dyn_int    step;        //!< distance between two elements, can be negative
+     dyn_ushort length;      //!< number of elements within the view
 } __attribute__ ((packed));
 
+/**
+ * @brief Iterator over the elements of a LIST, SET, DICT, or STRING.
+ *
+ * Elements are returned as borrowed references, characters of a STRING are
+ * returned within the scratch element, which is overwritten with every step.
+ */
+struct dynamic_iter {
+     const dyn_c *container; //!< iterated LIST, SET, DICT, or STRING
+     dyn_ushort  pos;        //!< position of the next element
+     dyn_c       scratch;    //!< STRING element for single characters
+     char        chr[2];     //!< character buffer referenced by scratch
+};
+
+//! Number of tree iterator frames, which are stored without allocation
+#define DYN_TREE_STACK 8
+
+/**
+ * @brief Depth-first (pre-order) iterator over nested containers.
+ *
+ * Every frame stores a container and the position of the next element within
+ * it. The first DYN_TREE_STACK frames are part of the iterator, memory is only
+ * allocated for deeper nested structures.
+ */
+struct dynamic_tree_iter {
+     struct {
+         const dyn_c *container;
+         dyn_ushort  pos;
+     } frame[DYN_TREE_STACK], *stack; //!< local frames and the active stack
+     dyn_ushort  depth;      //!< number of frames in use
+     dyn_ushort  space;      //!< number of frames available on stack
+     dyn_ushort  pushed;     //!< DYN_TRUE if the last element was descended
+     dyn_const_str key;      //!< key of the last element, if within a DICT
+};
+
+/**
+ * @brief Key layout (hidden class) of dictionaries.
+ *
+ * A shape maps interned keys to the positions of their values and is shared
+ * by all dictionaries with the same keys in the same order. Shared shapes are
+ * immutable and form a tree of transitions, every child has one additional
+ * key. Large dictionaries get a private shape (parent is NULL), which is
+ * changed in place, as long as it is not shared by a copy.
+ */
+struct dynamic_shape {
+     dyn_shape  *parent;     //!< shape with one key less, NULL if private
+     dyn_shape  **child;     //!< transitions to shapes with one more key
+     dyn_str    *key;        //!< array of interned keys, see dyn_atom
+     dyn_uint   id;          //!< unique identifier, used by inline caches
+     dyn_uint   refs;        //!< dictionaries and children using it, atomic
+     dyn_ushort length;      //!< number of keys
+     dyn_ushort space;       //!< number of available keys
+     dyn_ushort children;    //!< number of transitions
+};
+
+/**
+ * @brief Inline cache for dictionary lookups at a call site.
+ *
+ * Stores the position of a key within the shape that was seen last, see
+ * dyn_dict_get_cached. Both fields share one 64 bit word, which is read and
+ * written atomically, such that a cache can be shared by threads.
+ */
+typedef union {
+    struct {
+        dyn_uint   shape;    //!< id of the cached shape, 0 if empty
+        dyn_ushort pos;      //!< position of the key within this shape
+    };
+    uint64_t word;           //!< shape and pos, accessed at once
+} dyn_dict_cache;
+
+/**
+ * @brief Deeply immutable element with an atomic reference counter.
+ *
+ * The element and all nested elements are owned by the frozen block, they
+ * must not be changed anymore and are freed with the last reference.
+ */
+struct dynamic_frozen {
+     dyn_c      value;       //!< frozen element
+     dyn_uint   refs;        //!< number of references, changed atomically
+};
+
 /**
  * @brief Basic container for dictionaries.
  *
- * todo.
+ * The keys are stored within a shared shape, the dictionary only stores its
+ * values.
  */
 struct dynamic_dict {
-     dyn_str*   key;        //!< array to C strings used as identifiers
+     dyn_shape* shape;      //!< key layout, shared with other dictionaries
      dyn_c      value;      //!< dynamic element of type dyn_list
-} __attribute__ ((packed));
+}
+#ifndef S2_NAN_BOXING     // the tagged dyn_c has to remain 8 byte aligned
+__attribute__ ((packed))
+#endif
+;
 
 /**
  * @brief Basic container/pointer to functions.
@@ -0,0 +1,137 @@
+/**
+ *  @file dynamic_view.c
+ *  @author André Dietrich
+ *  @date 19 October 2026
+ *
+ *  @copyright Copyright 2016 André Dietrich. All rights reserved.
+ *
+ *  @license This project is released under the MIT-License.
+ *
+ *  @brief Implementation of borrowed list views (slices).
+ *
+ *
+ */
+
+#include "dynamic.h"
+
+/**
+ * Adjusts a start or stop index to the length of a sequence, in the same way
+ * as Python does. Negative values count from the end, values out of range are
+ * cropped, and omitted values (DYN_SLICE_NONE) are set to def.
+ */
+static dyn_int adjust (dyn_int i, const dyn_int len, const dyn_int step, const dyn_int def)
+{
+    if (i == DYN_SLICE_NONE)
+        return def;
+
+    if (i < 0) {
+        i += len;
+        if (i < 0)
+            i = step < 0 ? -1 : 0;
+    } else if (i >= len) {
+        i = step < 0 ? len - 1 : len;
+    }
+
+    return i;
+}
+
+/**
+ * Generates a borrowed view onto a slice of another view, with the semantics
+ * of Python slices view[start:stop:step]. No element gets copied, the
+ * resulting view points into the same container.
+ *
+ * @code
+ * // pseudo code, v is a view onto [0,1,2,3,4,5,6,7,8,9]
+ * dyn_view_slice(v, 2, 5, 1)                             == [2,3,4]
+ * dyn_view_slice(v, -3, DYN_SLICE_NONE, 1)               == [7,8,9]
+ * dyn_view_slice(v, DYN_SLICE_NONE, DYN_SLICE_NONE, -2)  == [9,7,5,3,1]
+ * @endcode
+ *
+ * @param[in] view original view
+ * @param[out] sub resulting view
+ * @param[in] start first index or DYN_SLICE_NONE
+ * @param[in] stop index behind the last one or DYN_SLICE_NONE
+ * @param[in] step distance between two elements, must not be 0
+ *
+ * @retval DYN_TRUE   if sub could be defined
+ * @retval DYN_FALSE  if step is 0
+ */
+trilean dyn_view_slice (const dyn_view* view, dyn_view* sub,
+                        dyn_int start, dyn_int stop, dyn_int step)
+{
+    if (!step)
+        return DYN_FALSE;
+
+    dyn_int len = view->length;
+
+    start = adjust(start, len, step, step < 0 ? len - 1 : 0);
+    stop  = adjust(stop,  len, step, step < 0 ? -1 : len);
+
+    dyn_int n = 0;
+    if (step < 0 && stop < start)
+        n = (start - stop - 1) / -step + 1;
+    else if (step > 0 && start < stop)
+        n = (stop - start - 1) / step + 1;
+
+    sub->base = n ? DYN_VIEW_GET_REF(view, start) : view->base;
+    sub->step = view->step * step;
+    sub->length = n;
+
+    return DYN_TRUE;
+}
+
+/**
+ * Generates a borrowed view onto list[start:stop:step], see dyn_view_slice.
+ * The view is only valid as long as the list is not changed.
+ *
+ * @param[in] list input has to be of type LIST or SET
+ * @param[out] view resulting view
+ * @param[in] start first index or DYN_SLICE_NONE
+ * @param[in] stop index behind the last one or DYN_SLICE_NONE
+ * @param[in] step distance between two elements, must not be 0
+ *
+ * @retval DYN_TRUE   if view could be defined
+ * @retval DYN_FALSE  if list is not a LIST or SET or if step is 0
+ */
+trilean dyn_list_slice (const dyn_c* list, dyn_view* view,
+                        dyn_int start, dyn_int stop, dyn_int step)
+{
+    if (DYN_IS_REFERENCE(list))
+        list = DYN_DATA(list, ref);
+
+    if (DYN_TYPE(list) != LIST && DYN_TYPE(list) != SET)
+        return DYN_FALSE;
+
+    dyn_view all;
+    all.base = DYN_DATA(list, list)->container;
+    all.step = 1;
+    all.length = DYN_LIST_LEN(list);
+
+    return dyn_view_slice(&all, view, start, stop, step);
+}
+
+/**
+ * Materializes a view, by copying all of its elements into a new list, which
+ * is owned by the caller.
+ *
+ * @param[in] view to copy
+ * @param[in, out] list resulting LIST, must not be the list viewed
+ *
+ * @retval DYN_TRUE   if all elements could be copied
+ * @retval DYN_FALSE  otherwise
+ */
+trilean dyn_view_materialize (const dyn_view* view, dyn_c* list)
+{
+    if (!dyn_set_list_len(list, view->length))
+        return DYN_FALSE;
+
+    dyn_ushort i;
+    for (i=0; i<view->length; ++i) {
+        if (!dyn_list_push(list, DYN_VIEW_GET_REF(view, i))) {
+            dyn_free(list);
+            return DYN_FALSE;
+        }
+    }
+
+    return DYN_TRUE;
+}
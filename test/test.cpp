@@ -10,7 +10,7 @@ TEST(Data, Initaialization){
     DYN_INIT(&test);
 
     dyn_set_bool(&test, 0);
-    ASSERT_EQ(BOOL,  test.type );
+    ASSERT_EQ(BOOL, DYN_TYPE(&test));
     ASSERT_EQ(0,     dyn_get_bool  (&test));
     ASSERT_EQ(0,     dyn_get_int   (&test));
     ASSERT_EQ(0.0,   dyn_get_float (&test));
@@ -18,7 +18,7 @@ TEST(Data, Initaialization){
     ASSERT_STREQ("0", str ); free(str);
 
     dyn_set_bool(&test, 1);
-    ASSERT_EQ(BOOL,   test.type );
+    ASSERT_EQ(BOOL, DYN_TYPE(&test));
     ASSERT_EQ(1,      dyn_get_bool  (&test));
     ASSERT_EQ(1,      dyn_get_int   (&test));
     ASSERT_EQ(1.0,    dyn_get_float (&test));
@@ -26,7 +26,7 @@ TEST(Data, Initaialization){
     ASSERT_STREQ("1", str ); free(str);
 
     dyn_set_int(&test, 33);
-    ASSERT_EQ(INTEGER, test.type );
+    ASSERT_EQ(INTEGER, DYN_TYPE(&test));
     ASSERT_EQ(1,       dyn_get_bool  (&test) );
     ASSERT_EQ(33,      dyn_get_int   (&test) );
     ASSERT_EQ(33.0,    dyn_get_float (&test) );
@@ -34,7 +34,7 @@ TEST(Data, Initaialization){
     ASSERT_STREQ("33", str ); free(str);
 
     dyn_set_float(&test, 33.33);
-    ASSERT_EQ(FLOAT,   test.type );
+    ASSERT_EQ(FLOAT, DYN_TYPE(&test));
     ASSERT_EQ(1,       dyn_get_bool  (&test) );
     ASSERT_EQ(33,      dyn_get_int   (&test) );
     ASSERT_EQ(33.33f,  dyn_get_float (&test) );
@@ -44,12 +44,39 @@ TEST(Data, Initaialization){
 
     dyn_set_string(&test, "abc");
 
-    ASSERT_EQ(STRING,   test.type );
+    ASSERT_EQ(STRING, DYN_TYPE(&test));
     str=dyn_get_string(&test);
     ASSERT_STREQ("abc", str ); free(str);
 
     dyn_free(&test);
 }
+
+TEST(Data, Representation){
+    dyn_c test;
+    DYN_INIT(&test);
+#ifdef S2_NAN_BOXING
+    ASSERT_EQ(8u, sizeof(dyn_c));
+#endif
+    ASSERT_EQ(NONE, DYN_TYPE(&test));
+
+    dyn_set_int(&test, -123456);
+    ASSERT_EQ(INTEGER, DYN_TYPE(&test));
+    ASSERT_EQ(-123456, DYN_DATA(&test, i));
+
+    dyn_set_float(&test, -0.5);
+    ASSERT_EQ(FLOAT,   DYN_TYPE(&test));
+    ASSERT_EQ(-0.5f,   DYN_DATA(&test, f));
+
+    DYN_SET_TYPE(&test, INTEGER);
+    DYN_SET_TYPE(&test, FLOAT);
+    ASSERT_EQ(-0.5f,   DYN_DATA(&test, f));
+
+    dyn_set_string(&test, "abc");
+    ASSERT_EQ(STRING,  DYN_TYPE(&test));
+    ASSERT_STREQ("abc", DYN_DATA(&test, str));
+
+    dyn_free(&test);
+}
 /*
 
 TEST(Operation, Arithmetic){
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+TEST(Atomic, Scalar){
+    dyn_c slot, value, old;
+    DYN_INIT(&slot);
+    DYN_INIT(&value);
+    DYN_INIT(&old);
+
+    dyn_set_int(&value, 5);
+    ASSERT_TRUE(dyn_atomic_store(&slot, &value));
+    dyn_set_int(&value, 3);
+    ASSERT_TRUE(dyn_atomic_add(&slot, &value, &old));
+    ASSERT_EQ(5, dyn_get_int(&old));
+    ASSERT_TRUE(dyn_atomic_load(&slot, &value));
+    ASSERT_EQ(INTEGER, DYN_TYPE(&value));
+    ASSERT_EQ(8, dyn_get_int(&value));
+
+    // the type of an INTEGER is not changed by a FLOAT
+    dyn_set_float(&value, 1.5);
+    ASSERT_FALSE(dyn_atomic_add(&slot, &value, NULL));
+    ASSERT_EQ(8, dyn_get_int(&slot));
+
+    dyn_set_float(&slot, 1.0);
+    ASSERT_TRUE(dyn_atomic_add(&slot, &value, NULL));
+    dyn_set_int(&value, 2);
+    ASSERT_TRUE(dyn_atomic_add(&slot, &value, NULL));
+    ASSERT_FLOAT_EQ(4.5, dyn_get_float(&slot));
+
+    // compare and swap
+    dyn_set_int(&old, 1);
+    dyn_set_bool(&value, DYN_TRUE);
+    ASSERT_FALSE(dyn_atomic_cas(&slot, &old, &value));
+    ASSERT_EQ(FLOAT, DYN_TYPE(&old));
+    ASSERT_TRUE(dyn_atomic_cas(&slot, &old, &value));
+    ASSERT_EQ(BOOL, DYN_TYPE(&slot));
+
+    // elements with allocated memory are rejected
+    dyn_set_string(&value, "abc");
+    ASSERT_FALSE(dyn_atomic_store(&slot, &value));
+    ASSERT_EQ(DYN_NONE, dyn_atomic_cas(&slot, &old, &value));
+    ASSERT_FALSE(dyn_atomic_add(&value, &slot, NULL));
+    ASSERT_FALSE(dyn_atomic_load(&value, &old));
+    ASSERT_EQ(NONE, DYN_TYPE(&old));
+    dyn_set_int(&old, 1);
+    ASSERT_FALSE(dyn_atomic_store(&value, &old));
+    ASSERT_STREQ("abc", DYN_DATA(&value, str));
+
+    dyn_free(&value);
+}
+
+TEST(Atomic, Threads){
+    dyn_c dict, tmp;
+    DYN_INIT(&dict);
+    DYN_INIT(&tmp);
+
+    dyn_set_dict(&dict, 3);
+    dyn_set_int(&tmp, 0);
+    dyn_dict_insert(&dict, "count", &tmp);
+    dyn_dict_insert(&dict, "max", &tmp);
+    dyn_set_float(&tmp, 0);
+    dyn_dict_insert(&dict, "sum", &tmp);
+
+    dyn_c* count = dyn_dict_get(&dict, "count");
+    dyn_c* max = dyn_dict_get(&dict, "max");
+    dyn_c* sum = dyn_dict_get(&dict, "sum");
+
+    std::vector<std::thread> workers;
+    for (int t=0; t<8; ++t) {
+        workers.push_back(std::thread([=]() {
+            dyn_c one, half, cur, next;
+            dyn_set_int(&one, 1);
+            dyn_set_float(&half, 0.5);
+            for (int i=0; i<10000; ++i) {
+                EXPECT_TRUE(dyn_atomic_add(count, &one, NULL));
+                EXPECT_TRUE(dyn_atomic_add(sum, &half, NULL));
+
+                dyn_atomic_load(max, &cur);
+                dyn_set_int(&next, t * 10000 + i);
+                while (dyn_get_int(&cur) < dyn_get_int(&next) &&
+                       !dyn_atomic_cas(max, &cur, &next));
+            }
+        }));
+    }
+    for (auto& w : workers)
+        w.join();
+
+    ASSERT_EQ(80000, dyn_get_int(count));
+    ASSERT_FLOAT_EQ(40000.0, dyn_get_float(sum));
+    ASSERT_EQ(79999, dyn_get_int(max));
+
+    dyn_free(&dict);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
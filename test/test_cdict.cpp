@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+#ifdef S2_THREADS
+
+TEST(ConcurrentDict, Basic){
+    dyn_cdict* dict = dyn_cdict_new();
+    ASSERT_TRUE(dict != NULL);
+
+    dyn_c value, copy;
+    DYN_INIT(&value);
+    DYN_INIT(&copy);
+
+    dyn_set_string(&value, "abc");
+    ASSERT_TRUE(dyn_cdict_insert(dict, "a", &value));
+    dyn_set_int(&value, 2);
+    ASSERT_TRUE(dyn_cdict_insert(dict, "b", &value));
+    ASSERT_EQ(2, dyn_cdict_len(dict));
+
+    ASSERT_TRUE(dyn_epoch_enter());
+    const dyn_c* a = dyn_cdict_get(dict, "a");
+    ASSERT_STREQ("abc", DYN_DATA(a, str));
+
+    // replaced values remain valid within the critical section
+    ASSERT_TRUE(dyn_cdict_insert(dict, "a", &value));
+    ASSERT_TRUE(dyn_cdict_remove(dict, "b"));
+    ASSERT_FALSE(dyn_epoch_reclaim());
+    ASSERT_STREQ("abc", DYN_DATA(a, str));
+    ASSERT_EQ(NULL, dyn_cdict_get(dict, "b"));
+    dyn_epoch_leave();
+    ASSERT_TRUE(dyn_epoch_reclaim());
+
+    ASSERT_FALSE(dyn_cdict_remove(dict, "b"));
+    ASSERT_TRUE(dyn_cdict_get_copy(dict, "a", &copy));
+    ASSERT_EQ(2, dyn_get_int(&copy));
+    ASSERT_FALSE(dyn_cdict_get_copy(dict, "b", &copy));
+    ASSERT_EQ(1, dyn_cdict_len(dict));
+
+    dyn_free(&value);
+    dyn_free(&copy);
+    dyn_cdict_free(dict);
+}
+
+TEST(ConcurrentDict, Threads){
+    dyn_cdict* dict = dyn_cdict_new();
+    std::vector<std::thread> workers;
+
+    for (int t=0; t<8; ++t) {
+        workers.push_back(std::thread([dict, t]() {
+            char key[16];
+            dyn_c value;
+            DYN_INIT(&value);
+
+            for (int i=0; i<2000; ++i) {
+                snprintf(key, 16, "k%d", i % 100);
+                if (i % 4 == t % 4) {
+                    dyn_set_string(&value, key);
+                    EXPECT_TRUE(dyn_cdict_insert(dict, key, &value));
+                } else if (i % 7 == 0) {
+                    dyn_cdict_remove(dict, key);
+                } else {
+                    dyn_epoch_enter();
+                    const dyn_c* v = dyn_cdict_get(dict, key);
+                    if (v) {
+                        EXPECT_STREQ(key, DYN_DATA(v, str));
+                    }
+                    dyn_epoch_leave();
+                }
+            }
+            dyn_free(&value);
+        }));
+    }
+    for (auto& w : workers)
+        w.join();
+
+    ASSERT_LE(dyn_cdict_len(dict), 100);
+    dyn_cdict_free(dict);
+    ASSERT_TRUE(dyn_epoch_reclaim());
+}
+
+#endif
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
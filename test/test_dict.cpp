@@ -0,0 +1,303 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+TEST(Dict, Array){
+    dyn_c dict, copy, values[4];
+    DYN_INIT(&dict);
+    DYN_INIT(&copy);
+    for (int i=0; i<4; ++i)
+        DYN_INIT(&values[i]);
+    dyn_const_str keys[4] = {"a", "b", "a", "c"};
+    char* str;
+
+    dyn_set_int(&values[0], 1);
+    dyn_set_string(&values[1], "x");
+    dyn_set_int(&values[2], 3);
+    dyn_set_list_len(&values[3], 1);
+    dyn_list_push(&values[3], &values[0]);
+
+    // without checking, keys are taken as they are
+    ASSERT_TRUE(dyn_set_dict_array(&dict, keys, values, 2, DYN_FALSE));
+    ASSERT_EQ(2, DYN_DICT_LEN(&dict));
+    str = dyn_get_string(&dict);
+    ASSERT_STREQ("{a:1,b:x}", str);
+    free(str);
+
+    // duplicates keep the first position and the last value
+    ASSERT_TRUE(dyn_set_dict_array(&dict, keys, values, 4, DYN_TRUE));
+    ASSERT_EQ(3, DYN_DICT_LEN(&dict));
+    str = dyn_get_string(&dict);
+    ASSERT_STREQ("{a:3,b:x,c:[1]}", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_dict_copy(&dict, &copy));
+    char* str2 = dyn_get_string(&copy);
+    str = dyn_get_string(&dict);
+    ASSERT_STREQ(str, str2);
+    ASSERT_EQ(DYN_DICT_GET_I_KEY(&dict, 0), DYN_DICT_GET_I_KEY(&copy, 0));
+    free(str);
+    free(str2);
+
+    ASSERT_TRUE(dyn_set_dict_array(&copy, keys, values, 0, DYN_TRUE));
+    ASSERT_EQ(0, DYN_DICT_LEN(&copy));
+
+    for (int i=0; i<4; ++i)
+        dyn_free(&values[i]);
+    dyn_free(&dict);
+    dyn_free(&copy);
+}
+
+TEST(Dict, Large){
+    dyn_c dict, copy, values[1000];
+    DYN_INIT(&dict);
+    DYN_INIT(&copy);
+    dyn_const_str keys[1000];
+    char buffer[1000][8];
+
+    for (int i=0; i<1000; ++i) {
+        DYN_INIT(&values[i]);
+        dyn_set_int(&values[i], i);
+        snprintf(buffer[i], 8, "k%d", i % 500);
+        keys[i] = buffer[i];
+    }
+
+    ASSERT_TRUE(dyn_set_dict_array(&dict, keys, values, 1000, DYN_TRUE));
+    ASSERT_EQ(500, DYN_DICT_LEN(&dict));
+    ASSERT_EQ(999, dyn_get_int(dyn_dict_get(&dict, "k499")));
+    ASSERT_EQ(500, dyn_get_int(dyn_dict_get(&dict, "k0")));
+
+    ASSERT_TRUE(dyn_dict_copy(&dict, &copy));
+    ASSERT_EQ(500, DYN_DICT_LEN(&copy));
+    ASSERT_EQ(999, dyn_get_int(dyn_dict_get(&copy, "k499")));
+
+    dyn_free(&dict);
+    dyn_free(&copy);
+}
+
+TEST(Dict, Atoms){
+    dyn_c dict, copy, value;
+    DYN_INIT(&dict);
+    DYN_INIT(&copy);
+    DYN_INIT(&value);
+    dyn_uint atoms = dyn_atom_count();
+
+    ASSERT_EQ(NULL, dyn_atom_find("atom_x"));
+
+    dyn_set_dict(&dict, 2);
+    dyn_set_int(&value, 1);
+    dyn_dict_insert(&dict, "atom_x", &value);
+    dyn_dict_insert(&dict, "atom_y", &value);
+    ASSERT_EQ(atoms + 2, dyn_atom_count());
+
+    dyn_const_str x = dyn_atom("atom_x");
+    ASSERT_EQ(x, dyn_atom_find("atom_x"));
+    ASSERT_EQ(x, DYN_DICT_GET_I_KEY(&dict, 0));
+    ASSERT_EQ(1, dyn_dict_has_atom(&dict, x));
+    ASSERT_EQ(DYN_DICT_GET_I_REF(&dict, 0), dyn_dict_get_atom(&dict, x));
+    ASSERT_EQ(NULL, dyn_dict_get(&dict, "atom_z"));
+
+    // copies share their keys
+    ASSERT_TRUE(dyn_copy(&dict, &copy));
+    ASSERT_EQ(x, DYN_DICT_GET_I_KEY(&copy, 0));
+    dyn_free(&dict);
+    ASSERT_TRUE(dyn_dict_copy(&copy, &dict));
+    ASSERT_EQ(x, DYN_DICT_GET_I_KEY(&dict, 0));
+    ASSERT_EQ(atoms + 2, dyn_atom_count());
+
+    dyn_dict_remove(&dict, "atom_y");
+    dyn_free(&copy);
+    ASSERT_EQ(atoms + 1, dyn_atom_count());
+
+    dyn_free(&dict);
+    ASSERT_EQ(x, dyn_atom_find("atom_x"));
+    dyn_atom_free(x);
+    ASSERT_EQ(atoms, dyn_atom_count());
+    ASSERT_EQ(NULL, dyn_atom_find("atom_x"));
+
+    // growing and shrinking the symbol table
+    char buffer[1000][8];
+    for (int i=0; i<1000; ++i) {
+        snprintf(buffer[i], 8, "s%d", i);
+        ASSERT_TRUE(dyn_atom(buffer[i]) != NULL);
+    }
+    for (int i=0; i<1000; i+=2)
+        dyn_atom_free(dyn_atom_find(buffer[i]));
+    for (int i=1; i<1000; i+=2)
+        ASSERT_STREQ(buffer[i], dyn_atom_find(buffer[i]));
+    for (int i=1; i<1000; i+=2)
+        dyn_atom_free(dyn_atom_find(buffer[i]));
+    ASSERT_EQ(atoms, dyn_atom_count());
+}
+
+TEST(Dict, Shapes){
+    dyn_c dict1, dict2, value;
+    DYN_INIT(&dict1);
+    DYN_INIT(&dict2);
+    DYN_INIT(&value);
+
+    dyn_set_int(&value, 1);
+    dyn_set_dict(&dict1, 2);
+    dyn_set_dict(&dict2, 2);
+    ASSERT_EQ(dyn_shape_empty(), DYN_DATA(&dict1, dict)->shape);
+
+    // same keys in the same order result in the same shape
+    dyn_dict_insert(&dict1, "x", &value);
+    dyn_dict_insert(&dict1, "y", &value);
+    dyn_dict_insert(&dict2, "x", &value);
+    ASSERT_NE(DYN_DATA(&dict1, dict)->shape, DYN_DATA(&dict2, dict)->shape);
+    dyn_dict_insert(&dict2, "y", &value);
+    ASSERT_EQ(DYN_DATA(&dict1, dict)->shape, DYN_DATA(&dict2, dict)->shape);
+
+    dyn_dict_insert(&dict2, "z", &value);
+    dyn_dict_remove(&dict2, "z");
+    ASSERT_EQ(DYN_DATA(&dict1, dict)->shape, DYN_DATA(&dict2, dict)->shape);
+
+    // removing moves the last key to the removed position
+    dyn_dict_insert(&dict2, "z", &value);
+    dyn_dict_remove(&dict2, "x");
+    ASSERT_STREQ("z", DYN_DICT_GET_I_KEY(&dict2, 0));
+    ASSERT_STREQ("y", DYN_DICT_GET_I_KEY(&dict2, 1));
+
+    // inline cache
+    dyn_dict_cache cache = {0, 0};
+    dyn_const_str y = dyn_atom("y");
+    ASSERT_EQ(DYN_DICT_GET_I_REF(&dict1, 1), dyn_dict_get_cached(&dict1, y, &cache));
+    ASSERT_EQ(DYN_DATA(&dict1, dict)->shape->id, cache.shape);
+    ASSERT_EQ(1, cache.pos);
+    ASSERT_EQ(DYN_DICT_GET_I_REF(&dict2, 1), dyn_dict_get_cached(&dict2, y, &cache));
+    dyn_dict_remove(&dict1, "x");
+    ASSERT_EQ(DYN_DICT_GET_I_REF(&dict1, 0), dyn_dict_get_cached(&dict1, y, &cache));
+    ASSERT_EQ(0, cache.pos);
+    dyn_dict_remove(&dict1, "y");
+    ASSERT_EQ(NULL, dyn_dict_get_cached(&dict1, y, &cache));
+    dyn_atom_free(y);
+
+    dyn_free(&dict1);
+    dyn_free(&dict2);
+}
+
+TEST(Dict, PrivateShapes){
+    dyn_c dict, copy, value;
+    DYN_INIT(&dict);
+    DYN_INIT(&copy);
+    DYN_INIT(&value);
+    char key[8];
+
+    dyn_set_dict(&dict, 2);
+    for (int i=0; i<100; ++i) {
+        snprintf(key, 8, "p%d", i);
+        dyn_set_int(&value, i);
+        ASSERT_TRUE(dyn_dict_insert(&dict, key, &value) != NULL);
+    }
+    dyn_shape* shape = DYN_DATA(&dict, dict)->shape;
+    ASSERT_EQ(NULL, shape->parent);
+    ASSERT_EQ(100, shape->length);
+
+    // copy on write
+    ASSERT_TRUE(dyn_copy(&dict, &copy));
+    ASSERT_EQ(shape, DYN_DATA(&copy, dict)->shape);
+    dyn_dict_remove(&copy, "p0");
+    ASSERT_NE(shape, DYN_DATA(&copy, dict)->shape);
+    ASSERT_EQ(100, shape->length);
+    ASSERT_EQ(99, DYN_DICT_LEN(&copy));
+    ASSERT_EQ(99, dyn_get_int(DYN_DICT_GET_I_REF(&copy, 0)));
+    ASSERT_STREQ("p99", DYN_DICT_GET_I_KEY(&copy, 0));
+
+    for (int i=0; i<100; ++i) {
+        snprintf(key, 8, "p%d", i);
+        ASSERT_EQ(i, dyn_get_int(dyn_dict_get(&dict, key)));
+    }
+
+    dyn_free(&dict);
+    dyn_free(&copy);
+}
+
+// keys and shapes are shared by all threads, also without S2_THREADS
+TEST(Dict, Threads){
+    dyn_uint atoms = dyn_atom_count();
+    std::vector<std::thread> threads;
+
+    for (int t=0; t<4; ++t) {
+        threads.emplace_back([t]() {
+            dyn_c dict, copy, value;
+            DYN_INIT(&dict);
+            DYN_INIT(&copy);
+            DYN_INIT(&value);
+            char key[16];
+
+            for (int n=0; n<200; ++n) {
+                dyn_set_dict(&dict, 4);
+                for (int i=0; i<8; ++i) {
+                    // shared keys and keys that are unique per thread
+                    snprintf(key, 16, i % 2 ? "t%d_%d_%d" : "k%d", i, t, n % 10);
+                    dyn_set_int(&value, i);
+                    ASSERT_TRUE(dyn_dict_insert(&dict, key, &value) != NULL);
+                }
+                ASSERT_TRUE(dyn_copy(&dict, &copy));
+                for (int i=0; i<8; ++i) {
+                    snprintf(key, 16, i % 2 ? "t%d_%d_%d" : "k%d", i, t, n % 10);
+                    ASSERT_EQ(i, dyn_get_int(dyn_dict_get(&copy, key)));
+                }
+                ASSERT_EQ(NULL, dyn_dict_get(&copy, "missing"));
+                dyn_free(&dict);
+                dyn_free(&copy);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(atoms, dyn_atom_count());
+}
+
+// a shared inline cache never combines the shape of one lookup with the
+// position of another one
+TEST(Dict, CacheThreads){
+    static dyn_dict_cache cache;
+    dyn_c dict[2], value;
+    DYN_INIT(&dict[0]);
+    DYN_INIT(&dict[1]);
+    DYN_INIT(&value);
+    char key[8];
+
+    dyn_set_dict(&dict[0], 11);
+    for (int i=0; i<10; ++i) {
+        snprintf(key, 8, "c%d", i);
+        dyn_dict_insert(&dict[0], key, &value);
+    }
+    dyn_set_int(&value, 0);
+    dyn_dict_insert(&dict[0], "cached", &value);
+    dyn_set_dict(&dict[1], 1);
+    dyn_set_int(&value, 1);
+    dyn_dict_insert(&dict[1], "cached", &value);
+
+    dyn_const_str atom = dyn_atom("cached");
+    std::vector<std::thread> threads;
+    for (int t=0; t<4; ++t) {
+        threads.emplace_back([t, &dict, atom]() {
+            for (int i=0; i<20000; ++i) {
+                int d = (i + t) % 2;
+                dyn_c* v = dyn_dict_get_cached(&dict[d], atom, &cache);
+                ASSERT_EQ(d, dyn_get_int(v));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    dyn_atom_free(atom);
+    dyn_free(&dict[0]);
+    dyn_free(&dict[1]);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+static void config(dyn_c* dict) {
+    dyn_c tmp, list;
+    DYN_INIT(&tmp);
+    DYN_INIT(&list);
+
+    dyn_set_dict(dict, 10);
+    dyn_set_int(&tmp, 8080);
+    dyn_dict_insert(dict, "port", &tmp);
+    dyn_set_string(&tmp, "localhost");
+    dyn_dict_insert(dict, "host", &tmp);
+
+    dyn_set_list_len(&list, 20);
+    for (int i=0; i<3; ++i) {
+        dyn_set_int(&tmp, i);
+        dyn_list_push(&list, &tmp);
+    }
+    dyn_list_push_front(&list, &tmp);
+    dyn_dict_insert(dict, "list", &list);
+
+    dyn_free(&tmp);
+    dyn_free(&list);
+}
+
+TEST(Frozen, Freeze){
+    dyn_c dict, ref;
+    DYN_INIT(&dict);
+    DYN_INIT(&ref);
+
+    config(&dict);
+    dyn_frozen* frozen = dyn_freeze(&dict);
+    ASSERT_TRUE(frozen != NULL);
+    ASSERT_EQ(NONE, DYN_TYPE(&dict));
+
+    const dyn_c* value = DYN_FROZEN_GET(frozen);
+    ASSERT_EQ(value, dyn_frozen_get(frozen));
+    ASSERT_EQ(DICT, DYN_TYPE(value));
+    ASSERT_EQ(8080, dyn_get_int(dyn_dict_get(value, "port")));
+
+    // containers are shrunk to their length
+    dyn_c* list = dyn_dict_get(value, "list");
+    ASSERT_EQ(4, DYN_LIST_LEN(list));
+    ASSERT_EQ(4, DYN_DATA(list, list)->space);
+    ASSERT_EQ(0, DYN_DATA(list, list)->front);
+    char* str = dyn_get_string(list);
+    ASSERT_STREQ("[2,0,1,2]", str);
+    free(str);
+
+    ASSERT_EQ(frozen, dyn_frozen_ref(frozen));
+    dyn_frozen_free(frozen);
+    dyn_frozen_free(frozen);
+
+    // references cannot be frozen
+    config(&dict);
+    dyn_set_ref(&ref, &dict);
+    ASSERT_EQ(NULL, dyn_freeze(&ref));
+    DYN_MOVE(&ref, dyn_list_push_none(dyn_dict_get(&dict, "list")));
+    ASSERT_EQ(NULL, dyn_freeze(&dict));
+    ASSERT_EQ(DICT, DYN_TYPE(&dict));
+    dyn_free(&dict);
+}
+
+TEST(Frozen, Threads){
+    dyn_c dict;
+    DYN_INIT(&dict);
+
+    config(&dict);
+    dyn_frozen* frozen = dyn_freeze(&dict);
+    dyn_const_str port = dyn_atom("port");
+
+    std::vector<std::thread> workers;
+    for (int t=0; t<8; ++t) {
+        workers.push_back(std::thread([](dyn_frozen* f, dyn_const_str key) {
+            for (int i=0; i<1000; ++i) {
+                dyn_frozen* local = dyn_frozen_ref(f);
+                const dyn_c* value = DYN_FROZEN_GET(local);
+                EXPECT_EQ(8080, dyn_get_int(dyn_dict_get_atom(value, key)));
+                char* str = dyn_get_string(value);
+                EXPECT_STREQ("{port:8080,host:localhost,list:[2,0,1,2]}", str);
+                free(str);
+                dyn_frozen_free(local);
+            }
+            dyn_frozen_free(f);
+        }, dyn_frozen_ref(frozen), port));
+    }
+    for (auto& w : workers)
+        w.join();
+
+    dyn_frozen_free(frozen);
+    dyn_atom_free(port);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
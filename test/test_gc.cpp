@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+//! allocates a cell with a string and stores a reference to it at the end of root
+static dyn_c* add (dyn_gc* gc, dyn_c* root, const char* str)
+{
+    dyn_c value;
+    DYN_INIT(&value);
+    dyn_set_string(&value, str);
+
+    dyn_c* cell = dyn_gc_alloc(gc, &value);
+    if (root) {
+        dyn_set_ref(dyn_list_push_none(root), cell);
+        dyn_gc_barrier(gc, root);
+    }
+    return cell;
+}
+
+static dyn_c* new_root (dyn_gc* gc)
+{
+    dyn_c list;
+    DYN_INIT(&list);
+    dyn_set_list_len(&list, 8);
+
+    dyn_c* root = dyn_gc_alloc(gc, &list);
+    dyn_gc_pin(gc, root);
+    return root;
+}
+
+TEST(GC, Reachability){
+    dyn_gc* gc = dyn_gc_new();
+    dyn_c* root = new_root(gc);
+
+    for (int i=0; i<100; ++i) {
+        add(gc, root, "reachable");
+        add(gc, NULL, "garbage");
+    }
+    ASSERT_EQ(201, dyn_gc_cells(gc, NULL));
+
+    dyn_gc_collect(gc);
+    ASSERT_EQ(101, dyn_gc_cells(gc, NULL));
+    ASSERT_STREQ("reachable", DYN_DATA(DYN_DATA(DYN_LIST_GET_REF(root, 99), ref), str));
+
+    // shared cells are not copied and survive as long as one reference exists
+    dyn_c* shared = DYN_DATA(DYN_LIST_GET_REF(root, 0), ref);
+    for (int i=1; i<100; ++i)
+        dyn_set_ref(DYN_LIST_GET_REF(root, i), shared);
+    dyn_gc_barrier(gc, root);
+    dyn_gc_collect(gc);
+    ASSERT_EQ(2, dyn_gc_cells(gc, NULL));
+
+    dyn_str str = dyn_get_string(root);
+    ASSERT_STREQ("reachable", std::string(str).substr(1, 9).c_str());
+    free(str);
+
+    // cycles are freed, if they are not reachable
+    dyn_c list;
+    DYN_INIT(&list);
+    dyn_set_list_len(&list, 1);
+    dyn_c* a = dyn_gc_alloc(gc, &list);
+    dyn_set_list_len(&list, 1);
+    dyn_c* b = dyn_gc_alloc(gc, &list);
+    dyn_set_ref(dyn_list_push_none(a), b);
+    dyn_set_ref(dyn_list_push_none(b), a);
+    dyn_gc_pin(gc, a);
+    dyn_gc_collect(gc);
+    ASSERT_EQ(4, dyn_gc_cells(gc, NULL));
+    dyn_gc_unpin(gc, a);
+    dyn_gc_collect(gc);
+    ASSERT_EQ(2, dyn_gc_cells(gc, NULL));
+
+    dyn_gc_unpin(gc, root);
+    dyn_gc_collect(gc);
+    ASSERT_EQ(0, dyn_gc_cells(gc, NULL));
+
+    dyn_gc_free(gc);
+}
+
+TEST(GC, Incremental){
+    dyn_gc* gc = dyn_gc_new();
+    dyn_c* root = new_root(gc);
+
+    // a chain of nested lists, every cell refers to the next one
+    dyn_c* last = root;
+    for (int i=0; i<2000; ++i) {
+        dyn_c list;
+        DYN_INIT(&list);
+        dyn_set_list_len(&list, 2);
+        dyn_set_int(dyn_list_push_none(&list), i);
+        dyn_c* cell = dyn_gc_alloc(gc, &list);
+        dyn_set_ref(dyn_list_push_none(last), cell);
+        dyn_gc_barrier(gc, last);
+        last = cell;
+        add(gc, NULL, "garbage");
+    }
+
+    int steps = 0;
+    while (dyn_gc_step(gc, 100) == DYN_NONE)
+        ++steps;
+    ASSERT_LT(50, steps);
+    ASSERT_EQ(2001, dyn_gc_cells(gc, NULL));
+
+    // a cell that was already scanned is changed during marking
+    ASSERT_EQ(DYN_NONE, dyn_gc_step(gc, 10));
+    dyn_c* late = add(gc, root, "late");
+    while (dyn_gc_step(gc, 100) == DYN_NONE);
+    ASSERT_EQ(2002, dyn_gc_cells(gc, NULL));
+    ASSERT_STREQ("late", DYN_DATA(late, str));
+
+    // cutting the chain frees its tail
+    dyn_c* cell = DYN_DATA(DYN_LIST_GET_REF(root, 0), ref);
+    for (int i=1; i<1000; ++i)
+        cell = DYN_DATA(DYN_LIST_GET_REF(cell, 1), ref);
+    dyn_list_popi(cell, 1);
+    dyn_gc_barrier(gc, cell);
+    dyn_gc_collect(gc);
+    ASSERT_EQ(1002, dyn_gc_cells(gc, NULL));
+    ASSERT_EQ(999, dyn_get_int(DYN_LIST_GET_REF(cell, 0)));
+
+    dyn_gc_free(gc);
+}
+
+TEST(GC, Generations){
+    dyn_gc* gc = dyn_gc_new();
+    dyn_c* root = new_root(gc);
+    dyn_uint old;
+
+    for (int i=0; i<10; ++i)
+        add(gc, root, "old");
+    while (dyn_gc_step(gc, 1000) == DYN_NONE);
+    ASSERT_EQ(11, dyn_gc_cells(gc, &old));
+    ASSERT_EQ(11, old);
+
+    // minor collections free young garbage only
+    for (int i=0; i<10; ++i)
+        add(gc, NULL, "young");
+    dyn_list_popi(root, 1);
+    dyn_gc_barrier(gc, root);
+    while (dyn_gc_step(gc, 1000) == DYN_NONE);
+    ASSERT_EQ(11, dyn_gc_cells(gc, &old));
+    ASSERT_EQ(11, old);
+
+    // young cells that are only referenced by old cells are remembered
+    dyn_c* young = add(gc, root, "young");
+    while (dyn_gc_step(gc, 1000) == DYN_NONE);
+    ASSERT_EQ(12, dyn_gc_cells(gc, &old));
+    ASSERT_EQ(12, old);
+    ASSERT_STREQ("young", DYN_DATA(young, str));
+
+    // unreachable old cells are freed by major collections
+    dyn_gc_collect(gc);
+    ASSERT_EQ(11, dyn_gc_cells(gc, &old));
+    ASSERT_EQ(11, old);
+
+    // the number of old cells triggers major collections
+    for (int i=0; i<1000; ++i)
+        add(gc, root, "old");
+    while (dyn_gc_step(gc, 1000) == DYN_NONE);
+    ASSERT_EQ(1011, dyn_gc_cells(gc, &old));
+    dyn_list_popi(root, 1000);
+    dyn_gc_barrier(gc, root);
+    while (dyn_gc_step(gc, 1000) == DYN_NONE);
+    ASSERT_EQ(11, dyn_gc_cells(gc, NULL));
+
+    // minor collections sweep young cells only, not the whole heap
+    for (int i=0; i<1000; ++i)
+        add(gc, root, "old");
+    dyn_gc_collect(gc);
+    for (int i=0; i<10; ++i)
+        add(gc, NULL, "young");
+    int steps = 0;
+    while (dyn_gc_step(gc, 100) == DYN_NONE)
+        ++steps;
+    ASSERT_GE(1, steps);
+    ASSERT_EQ(1011, dyn_gc_cells(gc, &old));
+    ASSERT_EQ(1011, old);
+
+    dyn_gc_free(gc);
+}
@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+TEST(Iterator, Container){
+    dyn_c dyn, tmp;
+    DYN_INIT(&dyn);
+    DYN_INIT(&tmp);
+    dyn_iter it;
+    dyn_c* elem;
+    int n = 0;
+
+    dyn_set_string(&dyn, "abc");
+    ASSERT_TRUE(dyn_iter_init(&it, &dyn));
+    while ((elem = dyn_iter_next(&it))) {
+        ASSERT_EQ(STRING, DYN_TYPE(elem));
+        ASSERT_EQ("abc"[n++], DYN_DATA(elem, str)[0]);
+        ASSERT_EQ(NULL, dyn_iter_key(&it));
+    }
+    ASSERT_EQ(3, n);
+
+    dyn_set_list_len(&dyn, 10);
+    for (int i=0; i<10; ++i) {
+        dyn_set_int(&tmp, i);
+        dyn_list_push(&dyn, &tmp);
+    }
+
+    // iterating through a reference yields the original elements
+    dyn_set_ref(&tmp, &dyn);
+    ASSERT_TRUE(dyn_iter_init(&it, &tmp));
+    n = 0;
+    while ((elem = dyn_iter_next(&it))) {
+        ASSERT_EQ(DYN_LIST_GET_REF(&dyn, n), elem);
+        dyn_set_int(elem, dyn_get_int(elem) * 2);
+        ++n;
+    }
+    ASSERT_EQ(10, n);
+    ASSERT_EQ(18, dyn_get_int(DYN_LIST_GET_END(&dyn)));
+
+    dyn_set_dict(&dyn, 3);
+    dyn_set_int(&tmp, 1);
+    dyn_dict_insert(&dyn, "a", &tmp);
+    dyn_set_int(&tmp, 2);
+    dyn_dict_insert(&dyn, "b", &tmp);
+    ASSERT_TRUE(dyn_iter_init(&it, &dyn));
+    n = 0;
+    while ((elem = dyn_iter_next(&it))) {
+        ASSERT_EQ(n+1, dyn_get_int(elem));
+        ASSERT_STREQ(n ? "b" : "a", dyn_iter_key(&it));
+        ++n;
+    }
+    ASSERT_EQ(2, n);
+
+    dyn_set_int(&dyn, 1);
+    ASSERT_FALSE(dyn_iter_init(&it, &dyn));
+
+    dyn_free(&dyn);
+}
+
+TEST(Iterator, Tree){
+    dyn_c root, tmp, sub, dict;
+    DYN_INIT(&root);
+    DYN_INIT(&tmp);
+    DYN_INIT(&sub);
+    DYN_INIT(&dict);
+    dyn_tree_iter it;
+    dyn_c* elem;
+    char* str;
+
+    // [1, [2, {"a": 3}], 4]
+    DYN_SET_LIST(&root);
+    DYN_SET_LIST(&sub);
+    dyn_set_dict(&dict, 1);
+    dyn_set_int(&tmp, 3);
+    dyn_dict_insert(&dict, "a", &tmp);
+    dyn_set_int(&tmp, 2);
+    dyn_list_push(&sub, &tmp);
+    dyn_list_push(&sub, &dict);
+    dyn_set_int(&tmp, 1);
+    dyn_list_push(&root, &tmp);
+    dyn_list_push(&root, &sub);
+    dyn_set_int(&tmp, 4);
+    dyn_list_push(&root, &tmp);
+
+    const char* order[] = {"1", "[2,{a:3}]", "2", "{a:3}", "3", "4"};
+    const int depth[] = {1, 1, 2, 2, 3, 1};
+    int n = 0;
+
+    ASSERT_TRUE(dyn_tree_init(&it, &root));
+    while ((elem = dyn_tree_next(&it))) {
+        str = dyn_get_string(elem);
+        ASSERT_STREQ(order[n], str);
+        free(str);
+        ASSERT_EQ(depth[n], dyn_tree_depth(&it));
+        if (n == 4) {
+            ASSERT_STREQ("a", dyn_tree_key(&it));
+        }
+        ++n;
+    }
+    ASSERT_EQ(6, n);
+    dyn_tree_free(&it);
+
+    // skip the nested list
+    n = 0;
+    ASSERT_TRUE(dyn_tree_init(&it, &root));
+    while ((elem = dyn_tree_next(&it))) {
+        if (DYN_TYPE(elem) == LIST)
+            dyn_tree_skip(&it);
+        ++n;
+    }
+    ASSERT_EQ(3, n);
+    dyn_tree_free(&it);
+
+    // deeply nested lists
+    dyn_set_int(&tmp, 0);
+    for (int i=0; i<1000; ++i) {
+        dyn_set_list_len(&sub, 1);
+        dyn_list_push(&sub, &tmp);
+        dyn_move(&sub, &tmp);
+    }
+    n = 0;
+    ASSERT_TRUE(dyn_tree_init(&it, &tmp));
+    while ((elem = dyn_tree_next(&it)))
+        ++n;
+    ASSERT_EQ(1000, n);
+    dyn_tree_free(&it);
+
+    dyn_free(&root);
+    dyn_free(&dict);
+    dyn_free(&tmp);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,684 @@
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+static void push_int(dyn_c* list, dyn_int i) {
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+    dyn_set_int(&tmp, i);
+    dyn_list_push(list, &tmp);
+}
+
+static void push_float(dyn_c* list, dyn_float f) {
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+    dyn_set_float(&tmp, f);
+    dyn_list_push(list, &tmp);
+}
+
+static void push_string(dyn_c* list, const char* s) {
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+    dyn_set_string(&tmp, s);
+    dyn_list_push(list, &tmp);
+    dyn_free(&tmp);
+}
+
+static bool is_sorted(dyn_c* list) {
+    for (dyn_ushort i=1; i<DYN_LIST_LEN(list); ++i)
+        if (dyn_op_cmp(DYN_LIST_GET_REF(list, i), DYN_LIST_GET_REF(list, i-1)) == DYN_CMP_LT)
+            return false;
+    return true;
+}
+
+TEST(List, SortInteger){
+    dyn_c list;
+    DYN_INIT(&list);
+
+    for (int s=0; s<2; ++s) {
+        dyn_set_list_len(&list, 1000);
+        for (int i=0; i<1000; ++i)
+            push_int(&list, (i * 7919) % 1000 - 500);
+
+        ASSERT_TRUE(dyn_list_sort(&list, s ? DYN_TRUE : DYN_FALSE));
+        ASSERT_EQ(1000, DYN_LIST_LEN(&list));
+        ASSERT_TRUE(is_sorted(&list));
+        ASSERT_EQ(-500, dyn_get_int(DYN_LIST_GET_REF(&list, 0)));
+        ASSERT_EQ(499, dyn_get_int(DYN_LIST_GET_END(&list)));
+    }
+
+    dyn_free(&list);
+}
+
+TEST(List, SortFloat){
+    dyn_c list;
+    DYN_INIT(&list);
+    dyn_set_list_len(&list, 100);
+
+    for (int i=0; i<100; ++i)
+        push_float(&list, ((i * 37) % 100 - 50) / 4.0f);
+
+    ASSERT_TRUE(dyn_list_sort(&list, DYN_FALSE));
+    ASSERT_TRUE(is_sorted(&list));
+    ASSERT_EQ(-12.5f, dyn_get_float(DYN_LIST_GET_REF(&list, 0)));
+    ASSERT_EQ(12.25f, dyn_get_float(DYN_LIST_GET_END(&list)));
+
+    dyn_free(&list);
+}
+
+TEST(List, SortNaN){
+    dyn_c list;
+    DYN_INIT(&list);
+
+    // the radix path (> 16 elements) and the comparison path order NaN last
+    for (int n=8; n<=64; n+=56) {
+        dyn_set_list_len(&list, n);
+        for (int i=0; i<n; ++i)
+            push_float(&list, i % 4 == 0 ? (i % 8 ? -NAN : NAN) : (float) (n/2 - i));
+
+        ASSERT_TRUE(dyn_list_sort(&list, DYN_TRUE));
+        ASSERT_EQ(n/2 - (n-1), dyn_get_float(DYN_LIST_GET_REF(&list, 0)));
+        for (int i=0; i<n; ++i) {
+            float f = dyn_get_float(DYN_LIST_GET_REF(&list, i));
+            ASSERT_EQ(i >= n - n/4, f != f);
+        }
+    }
+
+    dyn_free(&list);
+}
+
+TEST(List, SortString){
+    dyn_c list;
+    DYN_INIT(&list);
+    char buf[8];
+
+    for (int s=0; s<2; ++s) {
+        dyn_set_list_len(&list, 200);
+        for (int i=0; i<200; ++i) {
+            sprintf(buf, "s%03d", (i * 53) % 200);
+            push_string(&list, buf);
+        }
+
+        ASSERT_TRUE(dyn_list_sort(&list, s ? DYN_TRUE : DYN_FALSE));
+        for (int i=0; i<200; ++i) {
+            sprintf(buf, "s%03d", i);
+            ASSERT_STREQ(buf, DYN_DATA(DYN_LIST_GET_REF(&list, i), str));
+        }
+    }
+
+    dyn_free(&list);
+}
+
+TEST(List, SortMixed){
+    dyn_c list;
+    DYN_INIT(&list);
+    DYN_SET_LIST(&list);
+
+    dyn_c tmp;
+    DYN_INIT(&tmp);
+    DYN_SET_LIST(&tmp);
+    push_int(&tmp, 1);
+
+    push_int(&list, 3);
+    push_string(&list, "b");
+    push_float(&list, 1.5f);
+    dyn_list_push(&list, &tmp);
+    dyn_list_push_none(&list);
+    push_string(&list, "a");
+    dyn_free(&tmp);
+
+    ASSERT_TRUE(dyn_list_sort(&list, DYN_TRUE));
+
+    char* str = dyn_get_string(&list);
+    ASSERT_STREQ("[,1.50000,3,a,b,[1]]", str);
+    free(str);
+
+    dyn_set_int(&tmp, 1);
+    ASSERT_FALSE(dyn_list_sort(&tmp, DYN_FALSE));
+
+    dyn_free(&list);
+}
+
+TEST(List, SortKey){
+    dyn_c list, dict, tmp;
+    DYN_INIT(&list);
+    DYN_INIT(&dict);
+    DYN_INIT(&tmp);
+    dyn_set_list_len(&list, 50);
+
+    for (int i=0; i<50; ++i) {
+        dyn_set_dict(&dict, 2);
+        dyn_set_int(&tmp, (i * 13) % 5);
+        dyn_dict_insert(&dict, "key", &tmp);
+        dyn_set_int(&tmp, i);
+        dyn_dict_insert(&dict, "id", &tmp);
+        dyn_list_push(&list, &dict);
+        dyn_free(&dict);
+    }
+
+    ASSERT_TRUE(dyn_list_sort_key(&list, "key", DYN_TRUE));
+
+    dyn_int last_key = -1, last_id = -1;
+    for (int i=0; i<50; ++i) {
+        dyn_c* elem = DYN_LIST_GET_REF(&list, i);
+        dyn_int key = dyn_get_int(dyn_dict_get(elem, "key"));
+        dyn_int id  = dyn_get_int(dyn_dict_get(elem, "id"));
+        ASSERT_LE(last_key, key);
+        if (key == last_key) {
+            ASSERT_LT(last_id, id);
+        }
+        last_key = key;
+        last_id = id;
+    }
+
+    dyn_free(&list);
+}
+
+static trilean is_odd(const dyn_c* element, const void* ctx) {
+    return dyn_get_int(element) % 2 ? DYN_TRUE : DYN_FALSE;
+}
+
+TEST(List, Splice){
+    dyn_c list, insert, tmp;
+    DYN_INIT(&list);
+    DYN_INIT(&insert);
+    DYN_INIT(&tmp);
+    char* str;
+
+    dyn_set_list_len(&list, 5);
+    for (int i=0; i<5; ++i)
+        push_int(&list, i);
+
+    dyn_set_string(&tmp, "x");
+    ASSERT_TRUE(dyn_list_insert(&list, &tmp, 2));
+    ASSERT_EQ(NONE, DYN_TYPE(&tmp));
+    ASSERT_TRUE(dyn_list_remove(&list, 0));
+
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[1,x,2,3,4]", str);
+    free(str);
+
+    DYN_SET_LIST(&insert);
+    push_string(&insert, "a");
+    push_string(&insert, "b");
+    ASSERT_TRUE(dyn_list_splice(&list, 1, 3, &insert));
+    ASSERT_EQ(0, DYN_LIST_LEN(&insert));
+
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[1,a,b,4]", str);
+    free(str);
+
+    for (int i=0; i<10; ++i)
+        push_int(&insert, i);
+    ASSERT_TRUE(dyn_list_splice(&list, 4, 0, &insert));
+    ASSERT_TRUE(dyn_list_splice(&list, 0, 1, NULL));
+    ASSERT_TRUE(dyn_list_splice(&list, 2, 100, NULL));
+    ASSERT_FALSE(dyn_list_splice(&list, 3, 0, NULL));
+    ASSERT_FALSE(dyn_list_splice(&list, 0, 0, &list));
+
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[a,b]", str);
+    free(str);
+
+    dyn_set_list_len(&list, 100);
+    for (int i=0; i<100; ++i)
+        push_int(&list, i);
+    ASSERT_EQ(50, dyn_list_remove_if(&list, is_odd, NULL));
+    ASSERT_EQ(50, DYN_LIST_LEN(&list));
+    for (int i=0; i<50; ++i)
+        ASSERT_EQ(2*i, dyn_get_int(DYN_LIST_GET_REF(&list, i)));
+
+    // the length is bounded by 0xFFFF elements
+    dyn_set_list_len(&list, 65000);
+    for (int i=0; i<65000; ++i)
+        push_int(&list, i);
+    dyn_set_list_len(&insert, 536);
+    for (int i=0; i<536; ++i)
+        push_int(&insert, i);
+    ASSERT_FALSE(dyn_list_splice(&list, 100, 0, &insert));
+    ASSERT_EQ(65000, DYN_LIST_LEN(&list));
+    ASSERT_EQ(536, DYN_LIST_LEN(&insert));
+    ASSERT_EQ(100, dyn_get_int(DYN_LIST_GET_REF(&list, 100)));
+    ASSERT_TRUE(dyn_list_splice(&list, 100, 1, &insert));
+    ASSERT_EQ(65535, DYN_LIST_LEN(&list));
+    ASSERT_EQ(101, dyn_get_int(DYN_LIST_GET_REF(&list, 636)));
+    ASSERT_EQ(64999, dyn_get_int(DYN_LIST_GET_END(&list)));
+
+    dyn_free(&list);
+    dyn_free(&insert);
+}
+
+TEST(List, SetSubtraction){
+    dyn_c set1, set2, tmp;
+    DYN_INIT(&set1);
+    DYN_INIT(&set2);
+    DYN_INIT(&tmp);
+
+    dyn_set_set_len(&set1, 1000);
+    dyn_set_set_len(&set2, 500);
+    for (int i=0; i<1000; ++i) {
+        dyn_set_int(&tmp, i);
+        dyn_set_insert(&set1, &tmp);
+        if (i % 2)
+            dyn_set_insert(&set2, &tmp);
+    }
+
+    ASSERT_TRUE(dyn_op_sub(&set1, &set2));
+    ASSERT_EQ(500, DYN_LIST_LEN(&set1));
+    for (int i=0; i<500; ++i)
+        ASSERT_EQ(2*i, dyn_get_int(DYN_LIST_GET_REF(&set1, i)));
+
+    ASSERT_TRUE(dyn_op_sub(&set1, &set1));
+    ASSERT_EQ(0, DYN_LIST_LEN(&set1));
+
+    dyn_free(&set1);
+    dyn_free(&set2);
+}
+
+TEST(List, Deque){
+    dyn_c list, tmp;
+    DYN_INIT(&list);
+    DYN_INIT(&tmp);
+    char* str;
+
+    DYN_SET_LIST(&list);
+    for (int i=0; i<3; ++i)
+        push_int(&list, i);
+
+    dyn_set_int(&tmp, -1);
+    ASSERT_TRUE(dyn_list_push_front(&list, &tmp));
+    dyn_set_int(&tmp, -2);
+    ASSERT_TRUE(dyn_list_insert(&list, &tmp, 0));
+    dyn_set_string(&tmp, "x");
+    ASSERT_TRUE(dyn_list_insert(&list, &tmp, 1));
+
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[-2,x,-1,0,1,2]", str);
+    free(str);
+
+    ASSERT_EQ(-2, dyn_get_int(dyn_list_get_ref(&list, 0)));
+    ASSERT_EQ(2,  dyn_get_int(dyn_list_get_ref(&list, -1)));
+    ASSERT_EQ(1,  dyn_get_int(DYN_LIST_GET_REF_END(&list, 2)));
+
+    ASSERT_TRUE(dyn_list_pop_front(&list, &tmp));
+    ASSERT_EQ(-2, dyn_get_int(&tmp));
+    ASSERT_TRUE(dyn_list_remove(&list, 0));
+    ASSERT_TRUE(dyn_list_remove(&list, 1));
+
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[-1,1,2]", str);
+    free(str);
+
+    // work queue, push at the back and pop at the front
+    for (int i=0; i<10000; ++i) {
+        push_int(&list, i);
+        if (i % 3 == 0) {
+            dyn_list_pop_front(&list, &tmp);
+            dyn_list_push_front(&list, &tmp);
+            dyn_list_pop_front(&list, &tmp);
+        }
+    }
+    ASSERT_EQ(10003 - 3334, DYN_LIST_LEN(&list));
+    ASSERT_EQ(9999, dyn_get_int(DYN_LIST_GET_END(&list)));
+    ASSERT_TRUE(dyn_list_sort(&list, DYN_FALSE));
+    ASSERT_TRUE(is_sorted(&list));
+
+    while (DYN_LIST_LEN(&list))
+        dyn_list_pop_front(&list, &tmp);
+    ASSERT_FALSE(dyn_list_pop_front(&list, &tmp));
+
+    // prepending via dyn_op_add
+    for (int i=0; i<1000; ++i) {
+        dyn_set_int(&tmp, i);
+        dyn_op_add(&tmp, &list);
+        dyn_move(&tmp, &list);
+    }
+    ASSERT_EQ(1000, DYN_LIST_LEN(&list));
+    ASSERT_EQ(999, dyn_get_int(DYN_LIST_GET_REF(&list, 0)));
+    ASSERT_EQ(0, dyn_get_int(DYN_LIST_GET_END(&list)));
+
+    dyn_free(&list);
+    dyn_free(&tmp);
+}
+
+TEST(List, Queue){
+    dyn_c list, tmp;
+    DYN_INIT(&list);
+    DYN_INIT(&tmp);
+    dyn_set_list_len(&list, 1);
+
+    // the gap of popped elements is reused, instead of growing the array
+    for (int n=1; n<=50; n+=49) {
+        for (int i=0; i<n; ++i)
+            push_int(&list, i);
+
+        for (int i=n; i<100000; ++i) {
+            push_int(&list, i);
+            ASSERT_EQ(i-n, dyn_get_int(DYN_LIST_GET_REF(&list, 0)));
+            if (i % 2)
+                ASSERT_TRUE(dyn_list_pop_front(&list, &tmp));
+            else
+                ASSERT_TRUE(dyn_list_remove(&list, 0));
+            ASSERT_EQ(n, DYN_LIST_LEN(&list));
+            dyn_list* ptr = DYN_DATA(&list, list);
+            ASSERT_GE(4 * n + 10, ptr->front + ptr->space);
+        }
+
+        while (DYN_LIST_LEN(&list))
+            dyn_list_pop_front(&list, &tmp);
+    }
+
+    dyn_free(&list);
+}
+
+TEST(List, Slice){
+    dyn_c list, copy;
+    DYN_INIT(&list);
+    DYN_INIT(&copy);
+    dyn_view view, sub;
+    char* str;
+
+    dyn_set_list_len(&list, 10);
+    for (int i=0; i<10; ++i)
+        push_int(&list, i);
+
+    ASSERT_TRUE(dyn_list_slice(&list, &view, 2, 5, 1));
+    ASSERT_EQ(3, DYN_VIEW_LEN(&view));
+    ASSERT_EQ(DYN_LIST_GET_REF(&list, 2), DYN_VIEW_GET_REF(&view, 0));
+
+    ASSERT_TRUE(dyn_list_slice(&list, &view, -3, DYN_SLICE_NONE, 1));
+    ASSERT_TRUE(dyn_view_materialize(&view, &copy));
+    str = dyn_get_string(&copy);
+    ASSERT_STREQ("[7,8,9]", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_list_slice(&list, &view, DYN_SLICE_NONE, DYN_SLICE_NONE, -2));
+    ASSERT_TRUE(dyn_view_materialize(&view, &copy));
+    str = dyn_get_string(&copy);
+    ASSERT_STREQ("[9,7,5,3,1]", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_view_slice(&view, &sub, 1, -1, 2));
+    ASSERT_TRUE(dyn_view_materialize(&sub, &copy));
+    str = dyn_get_string(&copy);
+    ASSERT_STREQ("[7,3]", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_list_slice(&list, &view, 5, 2, 1));
+    ASSERT_EQ(0, DYN_VIEW_LEN(&view));
+    ASSERT_TRUE(dyn_list_slice(&list, &view, -100, 100, 3));
+    ASSERT_EQ(4, DYN_VIEW_LEN(&view));
+    ASSERT_EQ(9, dyn_get_int(DYN_VIEW_GET_REF(&view, 3)));
+
+    ASSERT_FALSE(dyn_list_slice(&list, &view, 0, 1, 0));
+    dyn_set_int(&copy, 1);
+    ASSERT_FALSE(dyn_list_slice(&copy, &view, 0, 1, 1));
+
+    dyn_free(&list);
+    dyn_free(&copy);
+}
+
+TEST(List, Deep){
+    dyn_c deep, copy, sub, dict;
+    DYN_INIT(&deep);
+    DYN_INIT(&copy);
+    DYN_INIT(&sub);
+    DYN_INIT(&dict);
+    char* str;
+
+    // [{"a": [{"a": ... [1]}]}] nested 100000 times
+    dyn_set_int(&deep, 1);
+    for (int i=0; i<100000; ++i) {
+        if (i % 2) {
+            dyn_set_dict(&dict, 1);
+            dyn_set_string(&sub, "a");
+            dyn_dict_insert(&dict, "a", &sub);
+            dyn_move(&deep, dyn_dict_get(&dict, "a"));
+            dyn_move(&dict, &deep);
+        } else {
+            dyn_set_list_len(&sub, 1);
+            dyn_move(&deep, dyn_list_push_none(&sub));
+            dyn_move(&sub, &deep);
+        }
+    }
+
+    ASSERT_TRUE(dyn_copy(&deep, &copy));
+    ASSERT_EQ(dyn_size(&deep), dyn_size(&copy));
+    ASSERT_EQ(dyn_string_len(&deep), dyn_string_len(&copy));
+    dyn_free(&deep);
+    ASSERT_EQ(NONE, DYN_TYPE(&deep));
+    dyn_free(&copy);
+
+    // string length of moderately nested structures
+    dyn_set_int(&deep, 1);
+    for (int i=0; i<100; ++i) {
+        dyn_set_list_len(&sub, 2);
+        dyn_move(&deep, dyn_list_push_none(&sub));
+        dyn_set_dict(&dict, 2);
+        dyn_set_int(&deep, i);
+        dyn_dict_insert(&dict, "key", &deep);
+        dyn_move(&dict, dyn_list_push_none(&sub));
+        dyn_move(&sub, &deep);
+    }
+    str = dyn_get_string(&deep);
+    ASSERT_LE(strlen(str), dyn_string_len(&deep));
+
+    ASSERT_TRUE(dyn_copy(&deep, &copy));
+    char* str2 = dyn_get_string(&copy);
+    ASSERT_STREQ(str, str2);
+    ASSERT_LE(dyn_size(&copy), dyn_size(&deep));
+    free(str);
+    free(str2);
+
+    dyn_free(&deep);
+    dyn_free(&copy);
+    dyn_free(&dict);
+}
+
+TEST(List, Bulk) {
+    dyn_c array[4], list, copy;
+    DYN_INIT(&list);
+    DYN_INIT(&copy);
+    for (int i=0; i<4; ++i)
+        DYN_INIT(&array[i]);
+    char* str;
+
+    dyn_set_int(&array[0], 1);
+    dyn_set_float(&array[1], 1.5);
+    dyn_set_string(&array[2], "a");
+    dyn_set_list_len(&array[3], 1);
+    push_int(&array[3], 1);
+
+    ASSERT_TRUE(dyn_set_list_array(&list, array, 4));
+    ASSERT_EQ(4, DYN_LIST_LEN(&list));
+    ASSERT_EQ(4, DYN_DATA(&list, list)->space);
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[1,1.50000,a,[1]]", str);
+    free(str);
+
+    // range of another list and of the list itself
+    ASSERT_TRUE(dyn_list_append(&list, &array[2], 2));
+    ASSERT_TRUE(dyn_list_append(&list, DYN_LIST_GET_REF(&list, 0), 6));
+    ASSERT_EQ(12, DYN_LIST_LEN(&list));
+    str = dyn_get_string(&list);
+    ASSERT_STREQ("[1,1.50000,a,[1],a,[1],1,1.50000,a,[1],a,[1]]", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_list_copy(&list, &copy));
+    ASSERT_EQ(DYN_TRUE, dyn_op_eq(&list, &copy));
+    dyn_free(&copy);
+
+    // moving
+    ASSERT_TRUE(dyn_set_list_array_move(&copy, array, 2));
+    ASSERT_EQ(NONE, DYN_TYPE(&array[0]));
+    ASSERT_TRUE(dyn_list_append_move(&copy, &array[2], 2));
+    ASSERT_EQ(NONE, DYN_TYPE(&array[2]));
+    ASSERT_EQ(NONE, DYN_TYPE(&array[3]));
+    str = dyn_get_string(&copy);
+    ASSERT_STREQ("[1,1.50000,a,[1]]", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_set_list_array(&copy, array, 0));
+    ASSERT_EQ(0, DYN_LIST_LEN(&copy));
+
+    // references are resolved as by dyn_copy, the copies stay valid
+    dyn_set_string(&array[0], "orig");
+    dyn_set_list_len(&list, 2);
+    dyn_set_int(dyn_list_push_none(&list), 1);
+    dyn_set_ref(dyn_list_push_none(&list), &array[0]);
+    ASSERT_TRUE(dyn_list_copy(&list, &copy));
+    ASSERT_TRUE(dyn_set_list_array(&array[1], DYN_LIST_GET_REF(&list, 0), 2));
+    dyn_free(&array[0]);
+    ASSERT_EQ(STRING, DYN_TYPE(DYN_LIST_GET_REF(&copy, 1)));
+    ASSERT_STREQ("orig", DYN_DATA(DYN_LIST_GET_REF(&copy, 1), str));
+    ASSERT_STREQ("orig", DYN_DATA(DYN_LIST_GET_REF(&array[1], 1), str));
+    dyn_free(&array[1]);
+
+    dyn_free(&list);
+    dyn_free(&copy);
+}
+
+TEST(List, Deferred) {
+    dyn_c list, sub;
+    DYN_INIT(&list);
+    DYN_INIT(&sub);
+
+    // [[0, 1, ..., 99], ...] 100 times, 10201 elements in total
+    dyn_set_list_len(&list, 100);
+    for (int i=0; i<100; ++i) {
+        dyn_set_list_len(&sub, 100);
+        for (int j=0; j<100; ++j)
+            push_int(&sub, j);
+        dyn_move(&sub, dyn_list_push_none(&list));
+    }
+
+    dyn_free_deferred(&list);
+    ASSERT_EQ(NONE, DYN_TYPE(&list));
+
+    dyn_set_int(&list, 1);
+    dyn_free_deferred(&list);
+    ASSERT_EQ(NONE, DYN_TYPE(&list));
+
+    int slices = 0;
+    while (!dyn_reclaim(1000))
+        ++slices;
+    ASSERT_EQ(10, slices);
+    ASSERT_TRUE(dyn_reclaim(1000));
+
+    dyn_set_dict(&list, 2);
+    dyn_set_string(&sub, "a");
+    dyn_dict_insert(&list, "b", &sub);
+    dyn_free_deferred(&list);
+    ASSERT_TRUE(dyn_reclaim(1000));
+
+#ifdef S2_THREADS
+    ASSERT_TRUE(dyn_reclaim_start());
+    for (int i=0; i<100; ++i) {
+        dyn_set_list_len(&list, 100);
+        for (int j=0; j<100; ++j)
+            push_string(&list, "abc");
+        dyn_free_deferred(&list);
+    }
+    dyn_reclaim_stop();
+    ASSERT_TRUE(dyn_reclaim(1));
+
+    // concurrent starts and stops
+    std::vector<std::thread> threads;
+    for (int t=0; t<4; ++t)
+        threads.emplace_back([]() {
+            for (int i=0; i<100; ++i) {
+                EXPECT_TRUE(dyn_reclaim_start());
+                dyn_reclaim_stop();
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+    ASSERT_TRUE(dyn_reclaim(1));
+#endif
+    dyn_free(&sub);
+}
+
+TEST(List, Block){
+    dyn_c list, dict, tmp;
+    DYN_INIT(&list);
+    DYN_INIT(&dict);
+    DYN_INIT(&tmp);
+
+    // small containers are stored within the header block
+    dyn_set_list_len(&list, LIST_INLINE);
+    dyn_list* header = DYN_DATA(&list, list);
+    ASSERT_TRUE(dyn_block_inline(header));
+    for (int i=0; i<LIST_INLINE; ++i)
+        dyn_set_int(dyn_list_push_none(&list), i);
+    ASSERT_TRUE(dyn_block_inline(header));
+
+    dyn_set_int(&tmp, -1);
+    dyn_list_push_front(&list, &tmp);
+    ASSERT_FALSE(dyn_block_inline(header));
+    dyn_set_int(&tmp, 10);
+    dyn_list_push(&list, &tmp);
+    char* str = dyn_get_string(&list);
+    ASSERT_STREQ("[-1,0,1,2,3,4,5,10]", str);
+    free(str);
+
+    // freed headers are reused by the same thread
+    dyn_free(&list);
+    dyn_set_list_len(&list, 2);
+    ASSERT_EQ(header, DYN_DATA(&list, list));
+    dyn_set_list_len(&tmp, 100);
+    ASSERT_FALSE(dyn_block_inline(DYN_DATA(&tmp, list)));
+
+    dyn_set_dict(&dict, LIST_INLINE);
+    ASSERT_TRUE(dyn_block_inline(DYN_DATA(&DYN_DATA(&dict, dict)->value, list)));
+    for (int i=0; i<10; ++i) {
+        char key[3] = {'k', (char) ('0' + i), 0};
+        dyn_dict_insert(&dict, key, &list);
+    }
+    ASSERT_EQ(10, dyn_length(&dict));
+    ASSERT_EQ(LIST, DYN_TYPE(dyn_dict_get(&dict, "k9")));
+
+    dyn_free(&list);
+    dyn_free(&dict);
+    dyn_free(&tmp);
+}
+
+// every thread has its own cache of free headers, also without S2_THREADS
+TEST(List, BlockThreads){
+    std::vector<std::thread> threads;
+    dyn_c shared[4];
+
+    for (int t=0; t<4; ++t) {
+        DYN_INIT(&shared[t]);
+        threads.emplace_back([t, &shared]() {
+            dyn_c list;
+            DYN_INIT(&list);
+            for (int n=0; n<10000; ++n) {
+                dyn_set_list_len(&list, 2);
+                dyn_set_int(dyn_list_push_none(&list), n);
+                dyn_set_dict(dyn_list_push_none(&list), 2);
+                ASSERT_EQ(n, dyn_get_int(DYN_LIST_GET_REF(&list, 0)));
+            }
+            // the header is freed by another thread
+            dyn_move(&list, &shared[t]);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int t=0; t<4; ++t) {
+        ASSERT_EQ(9999, dyn_get_int(DYN_LIST_GET_REF(&shared[t], 0)));
+        dyn_free(&shared[t]);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
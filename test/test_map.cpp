@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+static trilean twice(const dyn_c* elem, dyn_c* out, void*) {
+    dyn_set_int(out, 2 * dyn_get_int(elem));
+    return DYN_TRUE;
+}
+
+static trilean odd(const dyn_c* elem, void*) {
+    return dyn_get_int(elem) % 2 ? DYN_TRUE : DYN_FALSE;
+}
+
+static trilean all(const dyn_c*, void*) {
+    return DYN_TRUE;
+}
+
+static trilean add(dyn_c* acc, const dyn_c* elem, void*) {
+    return dyn_op_add(acc, (dyn_c*) elem);
+}
+
+static trilean fail(const dyn_c* elem, dyn_c* out, void*) {
+    dyn_set_int(out, 1);
+    return dyn_get_int(elem) == 500 ? DYN_FALSE : DYN_TRUE;
+}
+
+static trilean join(dyn_c* acc, const dyn_c* elem, void* ctx) {
+    // the FUNCTION element is passed as context
+    EXPECT_EQ(FUNCTION, DYN_TYPE((dyn_c*) ctx));
+    return dyn_op_add(acc, (dyn_c*) elem);
+}
+
+static void check(dyn_pool* pool) {
+    dyn_c list, result, acc;
+    DYN_INIT(&list);
+    DYN_INIT(&result);
+    DYN_INIT(&acc);
+
+    dyn_set_list_len(&list, 1000);
+    for (int i=0; i<1000; ++i)
+        dyn_set_int(dyn_list_push_none(&list), i);
+
+    ASSERT_TRUE(dyn_map(pool, &list, &result, twice, NULL));
+    ASSERT_EQ(1000, dyn_length(&result));
+    for (int i=0; i<1000; ++i)
+        ASSERT_EQ(2*i, dyn_get_int(DYN_LIST_GET_REF(&result, i)));
+
+    ASSERT_TRUE(dyn_filter(pool, &list, &result, odd, NULL));
+    ASSERT_EQ(500, dyn_length(&result));
+    for (int i=0; i<500; ++i)
+        ASSERT_EQ(2*i+1, dyn_get_int(DYN_LIST_GET_REF(&result, i)));
+
+    dyn_set_int(&acc, 0);
+    ASSERT_TRUE(dyn_reduce(pool, &list, &acc, add, NULL));
+    ASSERT_EQ(499500, dyn_get_int(&acc));
+
+    // failures leave the result unchanged
+    ASSERT_FALSE(dyn_map(pool, &list, &result, fail, NULL));
+    ASSERT_EQ(500, dyn_length(&result));
+
+    // the result can replace the original
+    ASSERT_TRUE(dyn_filter(pool, &list, &list, odd, NULL));
+    ASSERT_TRUE(dyn_map(pool, &list, &list, twice, NULL));
+    ASSERT_EQ(2, dyn_get_int(DYN_LIST_GET_REF(&list, 0)));
+    ASSERT_EQ(1998, dyn_get_int(DYN_LIST_GET_REF(&list, 499)));
+
+    // strings are concatenated in order
+    dyn_set_list_len(&list, 100);
+    std::string expected;
+    for (int i=0; i<100; ++i) {
+        expected += std::to_string(i % 10);
+        dyn_set_string(dyn_list_push_none(&list), std::to_string(i % 10).c_str());
+    }
+    dyn_set_string(&acc, "");
+    ASSERT_TRUE(dyn_reduce(pool, &list, &acc, add, NULL));
+    ASSERT_STREQ(expected.c_str(), DYN_DATA(&acc, str));
+
+    // references are resolved as by dyn_copy, results stay valid
+    dyn_set_list_len(&result, 1000);
+    for (int i=0; i<1000; ++i)
+        dyn_set_ref(dyn_list_push_none(&result), DYN_LIST_GET_REF(&list, i % 100));
+    ASSERT_TRUE(dyn_filter(pool, &result, &result, all, NULL));
+    dyn_free(&list);
+    ASSERT_EQ(1000, dyn_length(&result));
+    ASSERT_EQ(STRING, DYN_TYPE(DYN_LIST_GET_REF(&result, 999)));
+    ASSERT_STREQ("9", DYN_DATA(DYN_LIST_GET_REF(&result, 999), str));
+
+    dyn_free(&list);
+    dyn_free(&result);
+    dyn_free(&acc);
+}
+
+TEST(Map, Sequential){
+    check(NULL);
+}
+
+#ifdef S2_THREADS
+TEST(Map, Parallel){
+    dyn_pool* pool = dyn_pool_new(4);
+    check(pool);
+    dyn_pool_free(pool);
+}
+#endif
+
+TEST(Map, Dict){
+    dyn_c dict, result, tmp;
+    DYN_INIT(&dict);
+    DYN_INIT(&result);
+    DYN_INIT(&tmp);
+
+    dyn_set_dict(&dict, 4);
+    for (int i=0; i<4; ++i) {
+        char key[2] = {(char) ('a' + i), 0};
+        dyn_set_int(&tmp, i);
+        dyn_dict_insert(&dict, key, &tmp);
+    }
+
+    ASSERT_TRUE(dyn_map(NULL, &dict, &result, twice, NULL));
+    ASSERT_EQ(DYN_DATA(&dict, dict)->shape, DYN_DATA(&result, dict)->shape);
+    char* str = dyn_get_string(&result);
+    ASSERT_STREQ("{a:0,b:2,c:4,d:6}", str);
+    free(str);
+
+    ASSERT_TRUE(dyn_filter(NULL, &dict, &result, odd, NULL));
+    str = dyn_get_string(&result);
+    ASSERT_STREQ("{b:1,d:3}", str);
+    free(str);
+    ASSERT_EQ(3, dyn_get_int(dyn_dict_get(&result, "d")));
+
+    // callbacks within FUNCTION elements
+    dyn_set_fct(&tmp, (void*) join, DYN_FCT_C, "join");
+    dyn_set_int(&result, 10);
+    ASSERT_TRUE(dyn_reduce_fct(NULL, &dict, &result, &tmp));
+    ASSERT_EQ(16, dyn_get_int(&result));
+
+    // procedures cannot be called
+    dyn_set_fct(&tmp, (void*) "\x01\x02\x03", 3, NULL);
+    ASSERT_FALSE(dyn_reduce_fct(NULL, &dict, &result, &tmp));
+    ASSERT_FALSE(dyn_reduce_fct(NULL, &result, &result, &tmp));
+
+    dyn_free(&dict);
+    dyn_free(&result);
+    dyn_free(&tmp);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+#ifdef S2_MEMORY
+
+TEST(Memory, Accounting){
+    dyn_memory* mem = dyn_memory_new(0);
+    dyn_memory* prev = dyn_memory_use(mem);
+    dyn_uint peak, total;
+
+    dyn_c list, str;
+    DYN_INIT(&list);
+    DYN_INIT(&str);
+    dyn_set_string(&str, "0123456789");
+
+    ASSERT_EQ(1, dyn_memory_blocks(mem, NULL));
+    ASSERT_LT(11, dyn_memory_bytes(mem, NULL));
+
+    dyn_set_list_len(&list, 100);
+    for (int i=0; i<100; ++i)
+        dyn_list_push(&list, &str);
+
+    dyn_uint bytes = dyn_memory_bytes(mem, &peak);
+    ASSERT_LT(100 * 11 + 100 * sizeof(dyn_c), bytes);
+    ASSERT_EQ(bytes, peak);
+    // the string, 100 copies, the list header, and its container
+    ASSERT_EQ(103, dyn_memory_blocks(mem, &total));
+
+    dyn_free(&list);
+    ASSERT_EQ(1, dyn_memory_blocks(mem, NULL));
+    dyn_free(&str);
+    ASSERT_EQ(0, dyn_memory_bytes(mem, &peak));
+    ASSERT_EQ(0, dyn_memory_blocks(mem, &total));
+    ASSERT_EQ(bytes, peak);
+    ASSERT_EQ(103, total);
+
+    // memory is returned to the context it was allocated in
+    dyn_memory* other = dyn_memory_new(0);
+    dyn_set_string(&str, "abc");
+    dyn_memory_use(other);
+    dyn_free(&str);
+    ASSERT_EQ(0, dyn_memory_bytes(mem, NULL));
+    ASSERT_EQ(0, dyn_memory_bytes(other, NULL));
+
+    // elements without a context are not accounted
+    dyn_memory_use(NULL);
+    dyn_set_string(&str, "abc");
+    dyn_free(&str);
+    dyn_memory_blocks(mem, &total);
+    ASSERT_EQ(104, total);
+
+    dyn_memory_use(prev);
+    dyn_memory_free(other);
+    dyn_memory_free(mem);
+}
+
+TEST(Memory, Limit){
+    dyn_memory* mem = dyn_memory_new(4096);
+    dyn_memory* prev = dyn_memory_use(mem);
+
+    dyn_c list, str, copy;
+    DYN_INIT(&list);
+    DYN_INIT(&str);
+    DYN_INIT(&copy);
+    dyn_set_string(&str, "a string that is copied until the limit is reached");
+
+    dyn_set_list_len(&list, 10);
+    int i;
+    for (i=0; i<1000; ++i)
+        if (!dyn_list_push(&list, &str))
+            break;
+    ASSERT_LT(10, i);
+    ASSERT_GT(1000, i);
+    ASSERT_GE(4096, dyn_memory_bytes(mem, NULL));
+    ASSERT_EQ(i, DYN_LIST_LEN(&list));
+    ASSERT_FALSE(dyn_set_string(&copy, "abc"));
+
+    // failing copies do not leave anything behind
+    dyn_uint bytes = dyn_memory_bytes(mem, NULL);
+    ASSERT_FALSE(dyn_copy(&list, &copy));
+    ASSERT_EQ(NONE, DYN_TYPE(&copy));
+    ASSERT_EQ(bytes, dyn_memory_bytes(mem, NULL));
+
+    // raising the limit
+    dyn_memory_limit(mem, 0);
+    ASSERT_TRUE(dyn_copy(&list, &copy));
+    ASSERT_EQ(i, DYN_LIST_LEN(&copy));
+
+    dyn_free(&copy);
+    dyn_free(&list);
+    dyn_free(&str);
+    ASSERT_EQ(0, dyn_memory_bytes(mem, NULL));
+
+    dyn_memory_use(prev);
+    dyn_memory_free(mem);
+}
+
+#ifdef S2_THREADS
+TEST(Memory, Parallel){
+    dyn_memory* mem = dyn_memory_new(0);
+    dyn_memory* prev = dyn_memory_use(mem);
+    dyn_pool* pool = dyn_pool_new(4);
+
+    dyn_c list, copy;
+    DYN_INIT(&list);
+    DYN_INIT(&copy);
+    dyn_set_list_len(&list, 5000);
+    for (int i=0; i<5000; ++i)
+        dyn_set_string(dyn_list_push_none(&list), "string");
+
+    dyn_uint bytes = dyn_memory_bytes(mem, NULL);
+
+    // worker threads account to the context of the caller
+    ASSERT_TRUE(dyn_copy_parallel(pool, &list, &copy));
+    ASSERT_EQ(2 * bytes, dyn_memory_bytes(mem, NULL));
+    dyn_free_parallel(pool, &copy);
+    ASSERT_EQ(bytes, dyn_memory_bytes(mem, NULL));
+
+    dyn_free(&list);
+    ASSERT_EQ(0, dyn_memory_bytes(mem, NULL));
+
+    dyn_pool_free(pool);
+    dyn_memory_use(prev);
+    dyn_memory_free(mem);
+}
+#endif
+
+#endif
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 
+#include <math.h>
+
 #include "test_defs.h"
 
 #define DYN_TEST_BEGIN dyn_c rslt; DYN_INIT(&rslt); char* string = NULL
@@ -75,6 +77,163 @@ TEST(Operations_Arithmetic, Addition){
     #undef DYN_TEST_FCT
 }
 
+TEST(Operations_Arithmetic, Power){
+
+    #define DYN_TEST_FCT dyn_op_pow
+    DYN_TEST_BEGIN;
+
+    DYN_TEST_2(&Int_12,   &Int_0,     1,        dyn_get_int);
+    DYN_TEST_2(&Int_12,   &Int_0,     INTEGER,  dyn_type);
+    DYN_TEST_2(&Int_12,   &Int_1,     12,       dyn_get_int);
+    DYN_TEST_2(&Int_n22,  &True_,     -22,      dyn_get_int);
+    DYN_TEST_2(&Int_0,    &Int_12,    0,        dyn_get_int);
+    DYN_TEST_2(&Int_n22,  &Int_n22,   FLOAT,    dyn_type);
+    DYN_TEST_2(&Float_12, &Int_0,     1.0f,     dyn_get_float);
+    DYN_TEST_2(&Float_12, &Int_1,     12.0f,    dyn_get_float);
+    DYN_TEST_2(&Str_abc,  &Int_1,     NONE,     dyn_type);
+    DYN_TEST_2(&Int_1,    &None_,     NONE,     dyn_type);
+
+    // overflow is promoted to FLOAT
+    DYN_TEST_2(&Int_12,   &Int_12,    FLOAT,    dyn_type);
+    DYN_TEST_2(&Int_12,   &Int_12,    8916100448256.0f, dyn_get_float);
+
+    dyn_c base;     DYN_INIT(&base);     dyn_set_int(&base, -3);
+    dyn_c exponent; DYN_INIT(&exponent); dyn_set_int(&exponent, 19);
+    DYN_TEST_2(&base,     &exponent,  -1162261467, dyn_get_int);
+    dyn_set_int(&base, 2);
+    dyn_set_int(&exponent, -2);
+    DYN_TEST_2(&base,     &exponent,  0.25f,    dyn_get_float);
+    dyn_set_float(&exponent, 0.5);
+    DYN_TEST_2(&base,     &exponent,  sqrtf(2), dyn_get_float);
+
+    dyn_op_pow_approx(DYN_TRUE);
+    dyn_set_ref(&rslt, &base);
+    dyn_op_pow(&rslt, &exponent);
+    ASSERT_NEAR(sqrtf(2), dyn_get_float(&rslt), 0.01);
+    dyn_op_pow_approx(DYN_FALSE);
+
+    dyn_free(&base);
+    dyn_free(&exponent);
+
+    DYN_TEST_END;
+    #undef DYN_TEST_FCT
+}
+
+TEST(Operations_Arithmetic, Fused){
+    DYN_TEST_BEGIN;
+
+    dyn_set_ref(&rslt, &Int_1);
+    ASSERT_TRUE(dyn_op_muladd(&rslt, &Int_12, &Int_n22));
+    ASSERT_EQ(1 + 12 * -22, dyn_get_int(&rslt));
+    ASSERT_EQ(1, dyn_get_int(&Int_1));
+
+    dyn_set_ref(&rslt, &Int_1);
+    ASSERT_TRUE(dyn_op_muladd(&rslt, &Float_12, &Int_12));
+    ASSERT_EQ(145.0f, dyn_get_float(&rslt));
+
+    dyn_set_ref(&rslt, &List_);
+    ASSERT_TRUE(dyn_op_muladd(&rslt, &Str_abc, &Int_1));
+    string = dyn_get_string(&rslt);
+    ASSERT_STREQ("[abc]", string);
+    free(string);
+    string = NULL;
+
+    dyn_set_ref(&rslt, &Int_1);
+    ASSERT_FALSE(dyn_op_muladd(&rslt, &None_, &Int_1));
+    ASSERT_EQ(NONE, dyn_type(&rslt));
+
+    dyn_set_int(&rslt, 10);
+    ASSERT_TRUE(dyn_op_inc(&rslt, 5));
+    ASSERT_EQ(15, dyn_get_int(&rslt));
+    ASSERT_TRUE(dyn_op_dec(&rslt, 20));
+    ASSERT_EQ(-5, dyn_get_int(&rslt));
+    dyn_set_float(&rslt, 0.5);
+    ASSERT_TRUE(dyn_op_inc(&rslt, 1));
+    ASSERT_EQ(1.5f, dyn_get_float(&rslt));
+    dyn_set_ref(&rslt, &Str_abc);
+    ASSERT_FALSE(dyn_op_inc(&rslt, 1));
+
+    dyn_set_ref(&rslt, &Int_12);
+    ASSERT_TRUE(dyn_op_clamp(&rslt, &Int_0, &Int_1));
+    ASSERT_EQ(1, dyn_get_int(&rslt));
+    dyn_set_ref(&rslt, &Float_n22);
+    ASSERT_TRUE(dyn_op_clamp(&rslt, &Int_0, &Int_12));
+    ASSERT_EQ(0, dyn_get_int(&rslt));
+    dyn_set_ref(&rslt, &Int_1);
+    ASSERT_TRUE(dyn_op_clamp(&rslt, &Int_0, &Float_12));
+    ASSERT_EQ(1, dyn_get_int(&rslt));
+    dyn_set_ref(&rslt, &Str_abc);
+    ASSERT_FALSE(dyn_op_clamp(&rslt, &Int_0, &Int_12));
+
+    // accumulate into a list element via a reference
+    dyn_c list;
+    DYN_INIT(&list);
+    dyn_copy(&List_0_1_n22, &list);
+    dyn_set_ref(&rslt, DYN_LIST_GET_REF(&list, 1));
+    ASSERT_TRUE(dyn_op_acc(&rslt, dyn_op_add, &Int_12));
+    ASSERT_TRUE(dyn_op_acc(&rslt, dyn_op_mul, &Int_12));
+    ASSERT_EQ(REFERENCE, dyn_type(&rslt));
+    ASSERT_EQ(156, dyn_get_int(DYN_LIST_GET_REF(&list, 1)));
+
+    dyn_set_ref(&rslt, &list);
+    ASSERT_TRUE(dyn_op_acc(&rslt, dyn_op_add, &rslt));
+    ASSERT_EQ(4, dyn_length(&list));
+    dyn_free(&list);
+
+    DYN_TEST_END;
+}
+
+TEST(Operations_Relational, Compare){
+    ASSERT_EQ(DYN_CMP_EQ,   dyn_op_cmp(&None_,        &None_));
+    ASSERT_EQ(DYN_CMP_LT,   dyn_op_cmp(&None_,        &Int_0));
+    ASSERT_EQ(DYN_CMP_EQ,   dyn_op_cmp(&Int_12,       &Float_12));
+    ASSERT_EQ(DYN_CMP_GT,   dyn_op_cmp(&Int_12,       &Float_n22_222));
+    ASSERT_EQ(DYN_CMP_LT,   dyn_op_cmp(&Str_22,       &Str_abc));
+    ASSERT_EQ(DYN_CMP_TYPE, dyn_op_cmp(&Str_22,       &Int_12));
+    ASSERT_EQ(DYN_CMP_EQ,   dyn_op_cmp(&List_0_1_n22, &List_0_1_n22));
+    ASSERT_EQ(DYN_CMP_GT,   dyn_op_cmp(&List_0_1_n22, &List_));
+    ASSERT_EQ(DYN_CMP_TYPE, dyn_op_cmp(&List_0_1_n22, &Set_));
+    ASSERT_EQ(dyn_hash(&Int_12), dyn_hash(&Float_12));
+
+    // large sets with different insertion order use the hashed path
+    dyn_c a, b, i;
+    DYN_INIT(&a); DYN_INIT(&b); DYN_INIT(&i);
+    dyn_set_set_len(&a, 100);
+    dyn_set_set_len(&b, 100);
+    for (int n=0; n<100; ++n) {
+        dyn_set_int(&i, n);
+        dyn_set_insert(&a, &i);
+        dyn_set_int(&i, 99-n);
+        dyn_set_insert(&b, &i);
+    }
+    ASSERT_EQ(DYN_CMP_EQ,  dyn_op_cmp(&a, &b));
+    ASSERT_EQ(DYN_CMP_LT,  dyn_op_cmp(&Set_, &b));
+    ASSERT_EQ(dyn_hash(&a), dyn_hash(&b));
+    dyn_list_pop(&b, &i);
+    ASSERT_EQ(DYN_CMP_GT,  dyn_op_cmp(&a, &b));
+    ASSERT_EQ(DYN_CMP_LT,  dyn_op_cmp(&b, &a));
+    dyn_set_int(&i, 1000);
+    dyn_set_insert(&b, &i);
+    ASSERT_EQ(DYN_CMP_NEQ, dyn_op_cmp(&a, &b));
+
+    // deeply nested lists are compared without recursion
+    dyn_set_list_len(&a, 1);
+    dyn_set_list_len(&b, 1);
+    for (int n=0; n<10000; ++n) {
+        dyn_c *ptr = dyn_list_push_none(&a);
+        dyn_move(&a, &i);
+        dyn_set_list_len(&a, 1);
+        ptr = dyn_list_push_none(&a);
+        dyn_move(&i, ptr);
+    }
+    dyn_copy(&a, &b);
+    ASSERT_EQ(DYN_CMP_EQ,  dyn_op_cmp(&a, &b));
+
+    dyn_free(&a);
+    dyn_free(&b);
+    dyn_free(&i);
+}
+
 
 TEST(Operations_Logical, AND){
     #define DYN_TEST_FCT dyn_op_and
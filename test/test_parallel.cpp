@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+#ifdef S2_THREADS
+
+static void sum(dyn_uint begin, dyn_uint end, void* ctx) {
+    dyn_uint s = 0;
+    for (; begin<end; ++begin)
+        s += begin;
+    __atomic_add_fetch((dyn_uint*) ctx, s, __ATOMIC_RELAXED);
+}
+
+static void fill(dyn_c* list, int n) {
+    dyn_c tmp, str;
+    DYN_INIT(&tmp);
+    DYN_INIT(&str);
+
+    dyn_set_string(&str, "abc");
+
+    dyn_set_list_len(list, n);
+    for (int i=0; i<n; ++i) {
+        switch (i % 4) {
+            case 0: dyn_set_int(&tmp, i);
+                    break;
+            case 1: dyn_copy(&str, &tmp);
+                    break;
+            case 2: dyn_set_list_len(&tmp, 2);
+                    dyn_list_push(&tmp, &str);
+                    break;
+            case 3: dyn_set_dict(&tmp, 2);
+                    dyn_dict_insert(&tmp, "a", &str);
+                    break;
+        }
+        dyn_list_push(list, &tmp);
+    }
+    dyn_free(&tmp);
+    dyn_free(&str);
+}
+
+static void expect_same(const dyn_c* a, const dyn_c* b) {
+    char* s1 = dyn_get_string(a);
+    char* s2 = dyn_get_string(b);
+    EXPECT_STREQ(s1, s2);
+    free(s1);
+    free(s2);
+}
+
+TEST(Parallel, For){
+    dyn_pool* pool = dyn_pool_new(4);
+    ASSERT_TRUE(pool != NULL);
+    ASSERT_EQ(5, dyn_pool_threads(pool));
+    ASSERT_EQ(1, dyn_pool_threads(NULL));
+
+    for (dyn_uint chunk=0; chunk<20; chunk+=7) {
+        dyn_uint s = 0;
+        dyn_pool_for(pool, 10000, chunk, sum, &s);
+        ASSERT_EQ(49995000u, s);
+        s = 0;
+        dyn_pool_for(NULL, 10000, chunk, sum, &s);
+        ASSERT_EQ(49995000u, s);
+    }
+
+    dyn_pool_free(pool);
+}
+
+TEST(Parallel, Copy){
+    dyn_pool* pool = dyn_pool_new(3);
+    dyn_c list, copy, dict;
+    DYN_INIT(&list);
+    DYN_INIT(&copy);
+    DYN_INIT(&dict);
+
+    fill(&list, 5000);
+    ASSERT_EQ(dyn_size(&list), dyn_size_parallel(pool, &list));
+    ASSERT_EQ(dyn_size(&list), dyn_size_parallel(NULL, &list));
+
+    ASSERT_TRUE(dyn_copy_parallel(pool, &list, &copy));
+    ASSERT_EQ(5000, dyn_length(&copy));
+    expect_same(&list, &copy);
+
+    // dictionaries share the shape of the original
+    char key[16];
+    dyn_set_dict(&dict, 2000);
+    for (int i=0; i<2000; ++i) {
+        snprintf(key, 16, "k%d", i);
+        dyn_dict_insert(&dict, key, DYN_LIST_GET_REF(&list, i));
+    }
+    dyn_free_parallel(pool, &list);
+    ASSERT_EQ(NONE, DYN_TYPE(&list));
+
+    ASSERT_TRUE(dyn_copy_parallel(pool, &dict, &list));
+    ASSERT_EQ(DYN_DATA(&dict, dict)->shape, DYN_DATA(&list, dict)->shape);
+    expect_same(&dict, &list);
+    ASSERT_EQ(dyn_size(&dict), dyn_size_parallel(pool, &list));
+
+    dyn_free_parallel(pool, &list);
+    dyn_free_parallel(pool, &copy);
+    dyn_free_parallel(NULL, &dict);
+    dyn_pool_free(pool);
+}
+
+TEST(Parallel, CopyReference){
+    dyn_pool* pool = dyn_pool_new(3);
+    dyn_c list, copy, parallel, target;
+    DYN_INIT(&list);
+    DYN_INIT(&copy);
+    DYN_INIT(&parallel);
+    DYN_INIT(&target);
+
+    // references are resolved as by dyn_copy
+    dyn_set_string(&target, "orig");
+    dyn_set_list_len(&list, 2000);
+    for (int i=0; i<2000; ++i)
+        dyn_set_ref(dyn_list_push_none(&list), &target);
+
+    ASSERT_TRUE(dyn_copy(&list, &copy));
+    ASSERT_TRUE(dyn_copy_parallel(pool, &list, &parallel));
+    dyn_free(&list);
+    dyn_free(&target);
+
+    for (int i=0; i<2000; ++i)
+        ASSERT_EQ(DYN_TYPE(DYN_LIST_GET_REF(&copy, i)),
+                  DYN_TYPE(DYN_LIST_GET_REF(&parallel, i)));
+    ASSERT_STREQ("orig", DYN_DATA(DYN_LIST_GET_REF(&parallel, 1999), str));
+    expect_same(&copy, &parallel);
+
+    dyn_free(&copy);
+    dyn_free_parallel(pool, &parallel);
+    dyn_pool_free(pool);
+}
+
+#endif
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
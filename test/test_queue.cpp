@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+#ifdef S2_THREADS
+
+TEST(Queue, Basic){
+    dyn_queue* q = dyn_queue_new(3);
+    dyn_c value, array[8];
+    DYN_INIT(&value);
+    for (int i=0; i<8; ++i)
+        DYN_INIT(&array[i]);
+
+    // the capacity is rounded up to 4
+    for (int i=0; i<4; ++i) {
+        dyn_set_int(&value, i);
+        ASSERT_TRUE(dyn_queue_push(q, &value));
+        ASSERT_EQ(NONE, DYN_TYPE(&value));
+    }
+    dyn_set_string(&value, "abc");
+    ASSERT_FALSE(dyn_queue_push(q, &value));
+    ASSERT_STREQ("abc", DYN_DATA(&value, str));
+    ASSERT_EQ(4, dyn_queue_len(q));
+
+    ASSERT_EQ(2, dyn_queue_pop_array(q, array, 2));
+    ASSERT_EQ(0, dyn_get_int(&array[0]));
+    ASSERT_EQ(1, dyn_get_int(&array[1]));
+
+    // strings are moved, not copied
+    const char* str = DYN_DATA(&value, str);
+    ASSERT_TRUE(dyn_queue_push(q, &value));
+    dyn_set_list_len(&array[0], 2);
+    ASSERT_EQ(1, dyn_queue_push_array(q, array, 2));
+    ASSERT_EQ(NONE, DYN_TYPE(&array[0]));
+    ASSERT_EQ(INTEGER, DYN_TYPE(&array[1]));
+
+    ASSERT_EQ(4, dyn_queue_pop_array(q, array, 8));
+    ASSERT_EQ(2, dyn_get_int(&array[0]));
+    ASSERT_EQ(3, dyn_get_int(&array[1]));
+    ASSERT_EQ(str, DYN_DATA(&array[2], str));
+    ASSERT_EQ(LIST, DYN_TYPE(&array[3]));
+    ASSERT_FALSE(dyn_queue_pop(q, &value));
+    ASSERT_EQ(0, dyn_queue_len(q));
+
+    // remaining elements are freed with the queue
+    dyn_set_string(&value, "abc");
+    ASSERT_TRUE(dyn_queue_push_wait(q, &value));
+    dyn_queue_close(q);
+    dyn_set_int(&value, 1);
+    ASSERT_FALSE(dyn_queue_push_wait(q, &value));
+    dyn_queue_free(q);
+
+    for (int i=0; i<8; ++i)
+        dyn_free(&array[i]);
+}
+
+TEST(Queue, Threads){
+    dyn_queue* q = dyn_queue_new(16);
+    std::vector<std::thread> workers;
+    long sums[4] = {0, 0, 0, 0};
+
+    for (int t=0; t<4; ++t) {
+        workers.push_back(std::thread([q, t]() {
+            dyn_c batch[3];
+            for (int i=0; i<3; ++i)
+                DYN_INIT(&batch[i]);
+            for (int i=0; i<3000; i+=3) {
+                for (int j=0; j<3; ++j) {
+                    dyn_set_list_len(&batch[j], 1);
+                    dyn_c* v = dyn_list_push_none(&batch[j]);
+                    dyn_set_int(v, t * 3000 + i + j);
+                }
+                if (t % 2) {
+                    for (int j=0; j<3; ++j)
+                        EXPECT_TRUE(dyn_queue_push_wait(q, &batch[j]));
+                } else {
+                    dyn_uint n = 0;
+                    while (n < 3)
+                        n += dyn_queue_push_array_wait(q, &batch[n], 3 - n);
+                }
+            }
+        }));
+        workers.push_back(std::thread([q, &sums, t]() {
+            dyn_c batch[5];
+            for (int i=0; i<5; ++i)
+                DYN_INIT(&batch[i]);
+            dyn_uint n;
+            while ((n = dyn_queue_pop_array_wait(q, batch, t % 2 ? 1 : 5)))
+                for (dyn_uint i=0; i<n; ++i)
+                    sums[t] += dyn_get_int(DYN_LIST_GET_REF(&batch[i], 0));
+            for (int i=0; i<5; ++i)
+                dyn_free(&batch[i]);
+        }));
+    }
+
+    for (int t=0; t<4; ++t)
+        workers[2*t].join();
+    dyn_queue_close(q);
+    for (int t=0; t<4; ++t)
+        workers[2*t+1].join();
+
+    ASSERT_EQ(12000L * 11999 / 2, sums[0] + sums[1] + sums[2] + sums[3]);
+    ASSERT_EQ(0, dyn_queue_len(q));
+    dyn_queue_free(q);
+}
+
+#endif
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
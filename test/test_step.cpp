@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+extern "C" {
+    #include "dynamic.h"
+}
+
+//! list of n dicts, each with a nested list, a string, and a float
+static void build (dyn_c* list, int n)
+{
+    dyn_c value;
+    DYN_INIT(&value);
+
+    dyn_set_list_len(list, n);
+    for (int i=0; i<n; ++i) {
+        dyn_c* dict = dyn_list_push_none(list);
+        dyn_set_dict(dict, 4);
+        dyn_set_int(&value, i);
+        dyn_dict_insert(dict, "id", &value);
+        dyn_set_string(&value, "name");
+        dyn_dict_insert(dict, "name", &value);
+        dyn_set_float(&value, 0.5);
+        dyn_dict_insert(dict, "f", &value);
+        dyn_set_list_len(&value, 2);
+        dyn_set_int(dyn_list_push_none(&value), i);
+        dyn_set_bool(dyn_list_push_none(&value), i % 2);
+        dyn_dict_insert(dict, "l", &value);
+    }
+    dyn_free(&value);
+}
+
+TEST(Step, String){
+    dyn_c list;
+    DYN_INIT(&list);
+    build(&list, 1000);
+
+    dyn_str expected = dyn_get_string(&list);
+    dyn_str str;
+
+    dyn_step* step = dyn_step_string(&list, &str);
+    ASSERT_TRUE(step != NULL);
+
+    int runs = 0;
+    trilean rv;
+    while ((rv = dyn_step_run(step, 100)) == DYN_NONE) {
+        ASSERT_TRUE(str == NULL);
+        ++runs;
+    }
+    ASSERT_EQ(DYN_TRUE, rv);
+    // 1 + 1000 * (1 + 4 + 2) elements
+    ASSERT_EQ(70, runs);
+    ASSERT_STREQ(expected, str);
+
+    // finished steps keep their state
+    ASSERT_EQ(DYN_TRUE, dyn_step_run(step, 100));
+    dyn_step_free(step);
+    free(str);
+    free(expected);
+
+    // scalars and empty containers
+    dyn_set_int(&list, -42);
+    step = dyn_step_string(&list, &str);
+    ASSERT_EQ(DYN_NONE, dyn_step_run(step, 0));
+    ASSERT_EQ(DYN_TRUE, dyn_step_run(step, 1));
+    ASSERT_STREQ("-42", str);
+    dyn_step_free(step);
+    free(str);
+
+    dyn_set_list_len(&list, 2);
+    dyn_set_dict(dyn_list_push_none(&list), 2);
+    dyn_set_list_len(dyn_list_push_none(&list), 2);
+    step = dyn_step_string(&list, &str);
+    ASSERT_EQ(DYN_TRUE, dyn_step_run(step, 3));
+    ASSERT_STREQ("[{},[]]", str);
+    dyn_step_free(step);
+    free(str);
+
+    dyn_free(&list);
+}
+
+TEST(Step, Copy){
+    dyn_c list, copy;
+    DYN_INIT(&list);
+    DYN_INIT(&copy);
+    build(&list, 500);
+
+    dyn_step* step = dyn_step_copy(&list, &copy);
+    ASSERT_EQ(DYN_NONE, dyn_step_run(step, 1));
+    ASSERT_EQ(LIST, DYN_TYPE(&copy));
+    ASSERT_EQ(500, DYN_LIST_LEN(&copy));
+    ASSERT_EQ(NONE, DYN_TYPE(DYN_LIST_GET_REF(&copy, 0)));
+
+    // the partial copy is valid at any time, elements are copied depth-first
+    ASSERT_EQ(DYN_NONE, dyn_step_run(step, 10));
+    dyn_c* second = DYN_LIST_GET_REF(&copy, 1);
+    ASSERT_EQ(DICT, DYN_TYPE(second));
+    ASSERT_STREQ("name", DYN_DATA(dyn_dict_get(second, "name"), str));
+    ASSERT_EQ(NONE, DYN_TYPE(dyn_dict_get(second, "f")));
+    ASSERT_EQ(NONE, DYN_TYPE(DYN_LIST_GET_REF(&copy, 2)));
+
+    while (dyn_step_run(step, 64) == DYN_NONE);
+    dyn_step_free(step);
+
+    dyn_str a = dyn_get_string(&list);
+    dyn_str b = dyn_get_string(&copy);
+    ASSERT_STREQ(a, b);
+    free(a);
+    free(b);
+
+    // strings are not shared
+    dyn_c* name = dyn_dict_get(DYN_LIST_GET_REF(&copy, 3), "name");
+    ASSERT_NE(DYN_DATA(name, str),
+              DYN_DATA(dyn_dict_get(DYN_LIST_GET_REF(&list, 3), "name"), str));
+
+    // aborting frees the partial copy
+    dyn_free(&copy);
+    step = dyn_step_copy(&list, &copy);
+    ASSERT_EQ(DYN_NONE, dyn_step_run(step, 100));
+    dyn_step_free(step);
+    ASSERT_EQ(NONE, DYN_TYPE(&copy));
+
+    dyn_free(&list);
+}
+
+TEST(Step, Encode){
+    dyn_c list, decoded;
+    DYN_INIT(&list);
+    DYN_INIT(&decoded);
+
+    dyn_set_list_len(&list, 6);
+    dyn_set_int(dyn_list_push_none(&list), 1);
+    dyn_set_int(dyn_list_push_none(&list), 1000);
+    dyn_set_int(dyn_list_push_none(&list), 100000);
+    dyn_set_float(dyn_list_push_none(&list), 1.5);
+    dyn_set_bool(dyn_list_push_none(&list), 1);
+    dyn_c* sub = dyn_list_push_none(&list);
+    dyn_set_list_len(sub, 2);
+    dyn_set_int(dyn_list_push_none(sub), -7);
+    dyn_set_bool(dyn_list_push_none(sub), 0);
+
+    // same bytes as dyn_encode
+    dyn_char expected[64];
+    dyn_uint n = dyn_encode(expected, &list) - expected + 1;
+
+    dyn_char* code;
+    dyn_uint length;
+    dyn_step* step = dyn_step_encode(&list, &code, &length);
+    int runs = 0;
+    while (dyn_step_run(step, 2) == DYN_NONE)
+        ++runs;
+    dyn_step_free(step);
+
+    ASSERT_EQ(4, runs);
+    ASSERT_EQ(n, length);
+    ASSERT_EQ(0, memcmp(expected, code, n));
+
+    dyn_decode_all(code, &decoded);
+    free(code);
+
+    dyn_str a = dyn_get_string(&list);
+    dyn_str b = dyn_get_string(&decoded);
+    ASSERT_STREQ(a, b);
+    free(a);
+    free(b);
+
+    // strings are terminated
+    dyn_free(&decoded);
+    dyn_set_string(DYN_LIST_GET_REF(&list, 0), "abc");
+    step = dyn_step_encode(&list, &code, NULL);
+    ASSERT_EQ(DYN_TRUE, dyn_step_run(step, 100));
+    dyn_step_free(step);
+    dyn_decode_all(code, &decoded);
+    free(code);
+    ASSERT_STREQ("abc", DYN_DATA(DYN_LIST_GET_REF(&decoded, 0), str));
+
+    dyn_free(&decoded);
+    dyn_free(&list);
+}